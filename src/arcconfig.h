@@ -88,6 +88,35 @@
 #define ARC_TASK_END_WAIT
 
 
+/*
+	Task Executor queue sizes
+	ARC_TASK_INJECTOR_SIZE: Capacity of the queue receiving tasks from non-worker threads
+	ARC_TASK_DEQUE_SIZE: Initial capacity of each worker's deque (power of two, grows on demand)
+*/
+
+#define ARC_TASK_INJECTOR_SIZE	1024
+#define ARC_TASK_DEQUE_SIZE		256
+
+
+/*
+	Simulation tick settings
+	ARC_SIMULATION_TICK_RATE: Fixed number of simulation ticks per second
+	ARC_SIMULATION_MAX_CATCHUP: Maximum number of ticks simulated back to back before the remaining time is dropped
+*/
+
+#define ARC_SIMULATION_TICK_RATE	20
+#define ARC_SIMULATION_MAX_CATCHUP	5
+
+
+/*
+	Physics threading
+	ARC_PHYSICS_MULTITHREADED: Builds a multithreaded dynamics world with a parallel collision dispatcher and a pool of constraint solvers.
+							   Bullet's parallel loops run on the engine's task executor. Requires Bullet to be built with BT_THREADSAFE.
+*/
+
+//#define ARC_PHYSICS_MULTITHREADED
+
+
 /*
 	Log settings
 	ARC_LOG_STDIO_UNSYNC: Unsyncs stdio from cout. Logging is accelerated but data races become possible.
@@ -102,18 +131,36 @@
 	Allocator debugging
 	ARC_ALLOCATOR_DEBUG_CHECKS: Enables debug assertions during heap creation/allocation
 	ARC_ALLOCATOR_DEBUG_LOG: Logs all allocations performed with Arclight Allocators
+	ARC_ALLOCATOR_STATISTICS: Tracks usage statistics in the SizeClassAllocator
 */
 
 #define ARC_ALLOCATOR_DEBUG_CHECKS
-#define ARC_ALLOCATOR_DEBUG_LOG
+//#define ARC_ALLOCATOR_DEBUG_LOG
+#define ARC_ALLOCATOR_STATISTICS
 
 
 /*
-	Sparse array packing
+	Concurrent allocator caching
+	ARC_ALLOCATOR_MAGAZINE_SIZE: Maximum number of free blocks a thread-local magazine holds
+	ARC_ALLOCATOR_MAGAZINE_BYTES: Maximum number of bytes a magazine's blocks may span, limits the blocks per magazine for large block sizes
+	ARC_ALLOCATOR_DEPOT_SIZE: Number of full and empty magazines the global depot holds each before returning blocks to their chunks
+	ARC_ALLOCATOR_MAX_THREADS: Number of threads receiving a private cache per allocator. Additional threads allocate from the locked chunk allocator.
+*/
+
+#define ARC_ALLOCATOR_MAGAZINE_SIZE	64
+#define ARC_ALLOCATOR_MAGAZINE_BYTES	16384
+#define ARC_ALLOCATOR_DEPOT_SIZE	64
+#define ARC_ALLOCATOR_MAX_THREADS	64
+
+
+/*
+	Sparse array configuration
 	ARC_SPARSE_PACK: Packs dense indices and data tightly together. Enhances array caching but might marginally bloat a single cache line during iteration.
+	ARC_SPARSE_PAGE_SIZE: Number of sparse indices per index page. Must be a power of two. Pages are allocated on first use and released once empty.
 */
 
 //#define ARC_SPARSE_PACK
+#define ARC_SPARSE_PAGE_SIZE	512
 
 
 /*
@@ -155,6 +202,15 @@
 #define ARC_ACS_MAX_COMPONENTS 256
 
 
+/*
+	ACS storage mode
+	ARC_ACS_ARCHETYPE_STORAGE: Stores actors with identical component sets together in fixed-size SoA chunks instead of one sparse array per component.
+	ARC_ACS_CHUNK_SIZE: Size of a single archetype chunk in bytes
+*/
+//#define ARC_ACS_ARCHETYPE_STORAGE
+#define ARC_ACS_CHUNK_SIZE 16384
+
+
 /*
 	Standard float type
 	ARC_STD_FLOAT_TYPE: Specifies the underlying standard float type
@@ -162,6 +218,13 @@
 #define ARC_STD_FLOAT_TYPE float
 
 
+/*
+	Math SIMD backend
+	ARC_SIMD_FORCE_SCALAR: Disables the SSE/AVX paths of Vec4f, Mat4f and Quatf. Both paths produce bit-identical results.
+*/
+//#define ARC_SIMD_FORCE_SCALAR
+
+
 /*
 	Profiling mode
 	ARC_ENABLE_PROFILER: Enables profilers
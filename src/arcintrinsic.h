@@ -2,9 +2,9 @@
 
 #include "arcbuild.h"
 
-#if defined(ARC_PLATFORM_X86) && defined(ARC_COMPILER_MSVC)
+#ifdef ARC_PLATFORM_X86
 	/*
-		For _mm_pause
+		For _mm_pause and SIMD intrinsics
 	*/
 	#include <immintrin.h>
 #endif
@@ -17,6 +17,35 @@
 #endif
 
 
+/*
+	SIMD instruction set detection
+	Defined if the compiler is allowed to emit instructions of the respective set, e.g. through /arch:AVX2 or -mavx2.
+	ARC_INTRINSIC_SSE2: SSE2, always available on AMD64
+	ARC_INTRINSIC_SSE41: SSE4.1. MSVC does not announce it separately, so it is implied by AVX there.
+	ARC_INTRINSIC_AVX: AVX
+	ARC_INTRINSIC_AVX2: AVX2
+*/
+#ifdef ARC_PLATFORM_X86
+
+	#if defined(ARC_PLATFORM_AMD64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+		#define ARC_INTRINSIC_SSE2
+	#endif
+
+	#if defined(__SSE4_1__) || defined(__AVX__)
+		#define ARC_INTRINSIC_SSE41
+	#endif
+
+	#ifdef __AVX__
+		#define ARC_INTRINSIC_AVX
+	#endif
+
+	#ifdef __AVX2__
+		#define ARC_INTRINSIC_AVX2
+	#endif
+
+#endif
+
+
 /*
 	Defines ARC_FORCE_INLINE
 	Forces the compiler to inline a certain function.
@@ -14,8 +14,33 @@ struct ComponentLifetimeHelper<Tuple<Pack...>> {
         (provider.createArray<Pack>(), ...);
     }
 
-    static void destroyActor(ComponentProvider& provider, ComponentObserver& observer, ActorID actor) {
-        ((provider.hasComponent<Pack>(actor) ? (observer.invokeDirect<Pack>(ComponentEvent::Destroyed, provider.getComponent<Pack>(actor), actor), provider.removeComponent<Pack>(actor)) : void()), ...);
+    static void notifyDestroyed(ComponentProvider& provider, ComponentObserver& observer, std::span<const ActorID> actors) {
+
+        //A single actor is its own owner list, which spares the allocation
+        if(actors.size() == 1) {
+            ((provider.hasComponent<Pack>(actors[0]) ? observer.invokeBatch<Pack>(ComponentEvent::Destroyed, provider, actors) : void()), ...);
+            return;
+        }
+
+        std::vector<ActorID> owners;
+        owners.reserve(actors.size());
+
+        ([&]() {
+
+            owners.clear();
+
+            for(ActorID actor : actors) {
+
+                if(provider.hasComponent<Pack>(actor)) {
+                    owners.push_back(actor);
+                }
+
+            }
+
+            observer.invokeBatch<Pack>(ComponentEvent::Destroyed, provider, owners);
+
+        }(), ...);
+
     }
 
 };
@@ -48,7 +73,7 @@ ActorID ActorManager::spawn(ActorTypeID id) {
 
     arc_assert(isActorTypeRegistered(id), "Cannot spawn unknown actor %d", id);
 
-    ActorID actorID = getNextActorID();
+    ActorID actorID = registry.create();
 
     ComponentSpawnChannel channel(provider, actorID, observer);
     
@@ -65,7 +90,7 @@ ActorID ActorManager::spawn(ActorTypeID id, const Transform& transform) {
 
     arc_assert(isActorTypeRegistered(id), "Cannot spawn unknown actor %d", id);
 
-    ActorID actorID = getNextActorID();
+    ActorID actorID = registry.create();
 
     ComponentSpawnChannel channel(provider, actorID, observer);
     channel.add(transform);
@@ -84,7 +109,7 @@ ActorID ActorManager::spawn(ActorTypeID id, const ConstructionFunction& onConstr
 
     arc_assert(isActorTypeRegistered(id), "Cannot spawn unknown actor %d", id);
 
-    ActorID actorID = getNextActorID();
+    ActorID actorID = registry.create();
 
     ComponentSpawnChannel channel(provider, actorID, observer);
 
@@ -101,8 +126,101 @@ ActorID ActorManager::spawn(ActorTypeID id, const ConstructionFunction& onConstr
 
 
 
+std::vector<ActorID> ActorManager::spawnBatch(ActorTypeID id, SizeT count, std::span<const Transform> transforms) {
+
+    arc_assert(isActorTypeRegistered(id), "Cannot spawn unknown actor %d", id);
+    arc_assert(transforms.empty() || transforms.size() == count, "Transform count %d does not match the actor count %d", transforms.size(), count);
+
+    std::vector<ActorID> actors;
+    actors.reserve(count);
+
+    registry.reserve(registry.getSlotCount() + count);
+
+    IActor& blueprint = *registeredActorTypes[id];
+
+    for(SizeT i = 0; i < count; i++) {
+
+        ActorID actorID = registry.create();
+        ComponentSpawnChannel channel(provider, actorID, observer);
+
+        if(!transforms.empty()) {
+            channel.add(transforms[i]);
+        }
+
+        blueprint.onCreate(channel);
+
+        //The first actor defines the component layout of the batch
+        if(i == 0) {
+            provider.reserveLike(actorID, count - 1, registry.getSlotCount() + count - 1);
+        }
+
+        actors.push_back(actorID);
+
+    }
+
+    observer.invokeAll();
+
+    return actors;
+
+}
+
+
+
+void ActorManager::destroyBatch(std::span<const ActorID> actors) {
+
+    std::vector<ActorID> aliveActors;
+    aliveActors.reserve(actors.size());
+
+    for(ActorID actor : actors) {
+
+        if(registry.isAlive(actor)) {
+            aliveActors.push_back(actor);
+        }
+
+    }
+
+    if(aliveActors.size() != actors.size()) {
+        Log::warn("Actor Manager", "Skipped %d stale actor handles in batch destruction", actors.size() - aliveActors.size());
+    }
+
+    ComponentLifetimeHelper<ComponentTypes>::notifyDestroyed(provider, observer, aliveActors);
+
+    for(ActorID actor : aliveActors) {
+
+        provider.destroyActor(actor);
+        registry.destroy(actor);
+
+    }
+
+}
+
+
+
 void ActorManager::destroy(ActorID actor) {
-    ComponentLifetimeHelper<ComponentTypes>::destroyActor(provider, observer, actor);
+
+    if(!registry.isAlive(actor)) {
+        Log::warn("Actor Manager", "Attempted to destroy a stale actor handle (ID = %d, generation = %d)", ActorRegistry::getIndex(actor), ActorRegistry::getGeneration(actor));
+        return;
+    }
+
+    //Batch observers must see single destructions as well, so they are reported as a batch of one
+    ComponentLifetimeHelper<ComponentTypes>::notifyDestroyed(provider, observer, std::span<const ActorID>(&actor, 1));
+
+    provider.destroyActor(actor);
+    registry.destroy(actor);
+
+}
+
+
+
+void ActorManager::playback(CommandBuffer& buffer) {
+    buffer.playback(*this);
+}
+
+
+
+bool ActorManager::isAlive(ActorID actor) const {
+    return registry.isAlive(actor);
 }
 
 
@@ -123,11 +241,3 @@ const ComponentProvider& ActorManager::getProvider() const {
 bool ActorManager::isActorTypeRegistered(ActorTypeID id) {
     return registeredActorTypes.contains(id);
 }
-
-
-
-//Uh yea this will change in the future
-ActorID ActorManager::getNextActorID() {
-    static ActorID id = 0;
-    return id++;
-}
@@ -4,8 +4,13 @@
 #include "componentprovider.h"
 #include "componentobserver.h"
 #include "componentview.h"
+#include "componentgroup.h"
+#include "actorregistry.h"
+#include "commandbuffer.h"
 
 #include <unordered_map>
+#include <typeindex>
+#include <span>
 #include <functional>
 #include <memory>
 
@@ -36,14 +41,73 @@ public:
 
     void destroy(ActorID actor);
 
+    /*
+        Spawns count actors of the given type and returns their handles.
+        If transforms is not empty, it must hold count elements and actor i receives transforms[i].
+        Storage is reserved once and observers fire once per component type for the whole batch.
+    */
+    std::vector<ActorID> spawnBatch(ActorTypeID id, SizeT count, std::span<const Transform> transforms = {});
+
+    /*
+        Destroys all given actors. Stale handles are skipped, duplicates are not allowed.
+        Observers fire once per component type for the whole batch.
+    */
+    void destroyBatch(std::span<const ActorID> actors);
+
+    /*
+        Applies all commands recorded into buffer and clears it.
+        Commands are executed in phases: spawns batched per actor type, component additions, component removals batched per component and finally all destructions.
+        Commands on stale actors are skipped. Must be called from a sync point where no view, group or system accesses the manager.
+    */
+    void playback(CommandBuffer& buffer);
+
+    //Returns true if the handle refers to a live actor. Handles of destroyed actors are detected in O(1).
+    bool isAlive(ActorID actor) const;
+
     template<Component C, class Func>
     void addObserver(ComponentEvent event, Func&& callback) {
         observer.observe<C>(event, std::forward<Func>(callback));
     }
 
+    template<Component C, class Func>
+    void observeBatch(ComponentEvent event, Func&& callback) {
+        observer.observeBatch<C>(event, std::forward<Func>(callback));
+    }
+
     template<Component... Types>
     ComponentView<Types...> view() {
-        return ComponentView<Types...>(provider);
+        return ComponentView<Types...>(provider, registry);
+    }
+
+    /*
+        Returns the cached group of all actors owning Types.
+        The group is created on first request and kept up to date from then on.
+    */
+    template<Component... Types>
+    ComponentGroup<Types...>& group() {
+
+        auto& handle = groups[typeid(ComponentGroup<Types...>)];
+
+        if(!handle) {
+
+            auto group = std::make_unique<ComponentGroup<Types...>>(provider);
+            ComponentView<Types...> existing = view<Types...>();
+
+            for(auto it = existing.begin(); it != existing.end(); ++it) {
+                group->tryAdd(it.getActor());
+            }
+
+            IComponentGroup* ptr = group.get();
+
+            (observer.observe<Types>(ComponentEvent::Created, [ptr](Types&, ActorID actor) { ptr->tryAdd(actor); }), ...);
+            (observer.observe<Types>(ComponentEvent::Destroyed, [ptr](Types&, ActorID actor) { ptr->remove(actor); }), ...);
+
+            handle = std::move(group);
+
+        }
+
+        return static_cast<ComponentGroup<Types...>&>(*handle);
+
     }
 
     ComponentProvider& getProvider();
@@ -51,11 +115,56 @@ public:
 
 private:
 
+    friend class CommandBuffer;
+
     bool isActorTypeRegistered(ActorTypeID id);
-    ActorID getNextActorID();
 
+    ActorRegistry registry;
     ComponentProvider provider;
     ComponentObserver observer;
     std::unordered_map<ActorTypeID, std::unique_ptr<IActor>> registeredActorTypes;
+    std::unordered_map<std::type_index, std::unique_ptr<IComponentGroup>> groups;
+
+};
+
+
+
+template<Component C>
+void CommandBuffer::addOperation(ActorManager& manager, ActorID actor, void* payload) {
+
+    C& component = *static_cast<C*>(payload);
+
+    //Adding an existing component overwrites it
+    if(manager.provider.hasComponent<C>(actor)) {
+        manager.provider.setComponent(actor, std::move(component));
+        return;
+    }
+
+    manager.provider.addComponent(actor, std::move(component));
+    manager.observer.record<C>(ComponentEvent::Created, manager.provider, actor);
+
+}
+
+
+
+template<Component C>
+void CommandBuffer::removeOperation(ActorManager& manager, std::span<const ActorID> actors) {
+
+    std::vector<ActorID> owners;
+    owners.reserve(actors.size());
+
+    for(ActorID actor : actors) {
+
+        if(manager.provider.hasComponent<C>(actor)) {
+            owners.push_back(actor);
+        }
+
+    }
+
+    manager.observer.invokeBatch<C>(ComponentEvent::Destroyed, manager.provider, owners);
+
+    for(ActorID actor : owners) {
+        manager.provider.removeComponent<C>(actor);
+    }
 
-};
\ No newline at end of file
+}
\ No newline at end of file
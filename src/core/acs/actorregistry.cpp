@@ -0,0 +1,50 @@
+#include "actorregistry.h"
+#include "util/assert.h"
+
+
+
+ActorID ActorRegistry::create() {
+
+    u32 index;
+
+    if(freeSlots.empty()) {
+
+        arc_assert(generations.size() < 0xFFFFFFFF, "Actor slot limit reached");
+
+        index = static_cast<u32>(generations.size());
+        generations.push_back(0);
+
+    } else {
+
+        index = freeSlots.back();
+        freeSlots.pop_back();
+
+    }
+
+    return createID(index, ++generations[index]);
+
+}
+
+
+
+void ActorRegistry::destroy(ActorID actor) {
+
+    if(!isAlive(actor)) {
+        return;
+    }
+
+    u32 index = getIndex(actor);
+
+    generations[index]++;
+    freeSlots.push_back(index);
+
+}
+
+
+
+void ActorRegistry::reserve(SizeT count) {
+
+    generations.reserve(count);
+    freeSlots.reserve(count);
+
+}
\ No newline at end of file
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "actor.h"
+#include "types.h"
+
+#include <vector>
+
+
+
+/*
+    Actor registry
+    Hands out generational actor handles. The low 32 bits of an ActorID hold a slot index, the high 32 bits the slot's generation.
+    Slots of destroyed actors are recycled through a free list, so the index range is bounded by the peak number of live actors.
+    A slot's generation is odd while it is occupied and advances on every creation/destruction, invalidating stale handles.
+*/
+class ActorRegistry {
+
+public:
+
+    constexpr static ActorID invalidActor = 0;
+
+    ActorRegistry() = default;
+
+
+    //Creates a new actor and returns its handle
+    ActorID create();
+
+    //Destroys the actor and releases its slot. Stale handles are ignored.
+    void destroy(ActorID actor);
+
+    //Reserves slots for count actors
+    void reserve(SizeT count);
+
+    //Returns true if the handle refers to a live actor
+    bool isAlive(ActorID actor) const noexcept {
+
+        u32 index = getIndex(actor);
+        u32 generation = getGeneration(actor);
+
+        return index < generations.size() && generations[index] == generation && (generation & 1);
+
+    }
+
+    //Returns the handle of the actor currently occupying the given slot
+    ActorID getActor(u32 index) const noexcept {
+        return createID(index, generations[index]);
+    }
+
+    SizeT getActorCount() const noexcept {
+        return generations.size() - freeSlots.size();
+    }
+
+    //Returns the number of slots ever allocated, i.e. the peak number of live actors
+    SizeT getSlotCount() const noexcept {
+        return generations.size();
+    }
+
+
+    constexpr static u32 getIndex(ActorID actor) noexcept {
+        return actor & 0xFFFFFFFF;
+    }
+
+    constexpr static u32 getGeneration(ActorID actor) noexcept {
+        return actor >> 32;
+    }
+
+    constexpr static ActorID createID(u32 index, u32 generation) noexcept {
+        return (static_cast<ActorID>(generation) << 32) | index;
+    }
+
+private:
+
+    std::vector<u32> generations;
+    std::vector<u32> freeSlots;
+
+};
\ No newline at end of file
@@ -0,0 +1,330 @@
+#include "archetype.h"
+#include "util/assert.h"
+
+#include <new>
+#include <array>
+
+
+
+//Builds the type info table for all registered components
+template<class>
+struct ComponentTypeInfoTable;
+
+template<template<Component...> class Tuple, Component... Pack>
+struct ComponentTypeInfoTable<Tuple<Pack...>> {
+    constexpr static std::array<ComponentTypeInfo, sizeof...(Pack)> table = { ComponentTypeInfo::create<Pack>()... };
+};
+
+
+
+const ComponentTypeInfo& ComponentTypeInfo::get(ComponentID id) noexcept {
+    return ComponentTypeInfoTable<ComponentTypes>::table[id];
+}
+
+
+
+
+
+Archetype::Archetype(const ComponentMask& mask) : mask(mask), chunkCapacity(0), actorCount(0) {
+
+    for(ComponentID id = 0; id < std::tuple_size_v<ComponentTypes>; id++) {
+
+        if(mask.test(id)) {
+            componentIDs.push_back(id);
+        }
+
+    }
+
+    createLayout();
+
+}
+
+
+
+Archetype::~Archetype() {
+
+    for(u32 row = 0; row < actorCount; row++) {
+
+        for(ComponentID id : componentIDs) {
+            ComponentTypeInfo::get(id).destroyFunction(getComponent(id, row));
+        }
+
+    }
+
+    for(Byte* chunk : chunks) {
+        ::operator delete(chunk, std::align_val_t(chunkAlign));
+    }
+
+}
+
+
+
+u32 Archetype::allocate(ActorID actor) {
+
+    if(actorCount == chunks.size() * chunkCapacity) {
+        createChunk();
+    }
+
+    u32 row = actorCount++;
+    getActorData(row / chunkCapacity)[row % chunkCapacity] = actor;
+
+    return row;
+
+}
+
+
+
+ActorID Archetype::erase(u32 row, bool destroyComponents) {
+
+    arc_assert(row < actorCount, "Archetype row %d out of bounds", row);
+
+    if(destroyComponents) {
+
+        for(ComponentID id : componentIDs) {
+            ComponentTypeInfo::get(id).destroyFunction(getComponent(id, row));
+        }
+
+    }
+
+    u32 last = actorCount - 1;
+    ActorID movedActor = invalidActor;
+
+    if(row != last) {
+
+        for(ComponentID id : componentIDs) {
+            ComponentTypeInfo::get(id).relocateFunction(getComponent(id, row), getComponent(id, last));
+        }
+
+        movedActor = getActor(last);
+        getActorData(row / chunkCapacity)[row % chunkCapacity] = movedActor;
+
+    }
+
+    actorCount--;
+
+    return movedActor;
+
+}
+
+
+
+void Archetype::reserve(SizeT count) {
+
+    SizeT requiredChunks = (count + chunkCapacity - 1) / chunkCapacity;
+
+    chunks.reserve(requiredChunks);
+
+    while(chunks.size() < requiredChunks) {
+        createChunk();
+    }
+
+}
+
+
+
+void Archetype::shrink() {
+
+    while(chunks.size() > getChunkCount()) {
+
+        ::operator delete(chunks.back(), std::align_val_t(chunkAlign));
+        chunks.pop_back();
+
+    }
+
+}
+
+
+
+void Archetype::createLayout() {
+
+    SizeT entrySize = sizeof(ActorID);
+
+    for(ComponentID id : componentIDs) {
+
+        const ComponentTypeInfo& info = ComponentTypeInfo::get(id);
+        arc_assert(info.align <= chunkAlign, "Component %d alignment exceeds the chunk alignment", id);
+
+        entrySize += info.size;
+
+    }
+
+    componentOffsets.resize(componentIDs.empty() ? 0 : componentIDs.back() + 1);
+
+    //Padding between arrays might push the layout over the chunk boundary, so shrink until it fits
+    for(chunkCapacity = ARC_ACS_CHUNK_SIZE / entrySize; chunkCapacity > 0; chunkCapacity--) {
+
+        SizeT offset = chunkCapacity * sizeof(ActorID);
+
+        for(ComponentID id : componentIDs) {
+
+            const ComponentTypeInfo& info = ComponentTypeInfo::get(id);
+
+            offset = Math::alignUp(offset, info.align);
+            componentOffsets[id] = static_cast<u32>(offset);
+            offset += chunkCapacity * info.size;
+
+        }
+
+        if(offset <= ARC_ACS_CHUNK_SIZE) {
+            break;
+        }
+
+    }
+
+    arc_assert(chunkCapacity > 0, "Archetype entry of size %d does not fit into a single chunk", entrySize);
+
+}
+
+
+
+void Archetype::createChunk() {
+    chunks.push_back(static_cast<Byte*>(::operator new(ARC_ACS_CHUNK_SIZE, std::align_val_t(chunkAlign))));
+}
+
+
+
+
+
+void ArchetypeStorage::destroy(ActorID actor) {
+
+    u32 index = getIndex(actor);
+
+    if(!records.contains(index)) {
+        return;
+    }
+
+    Record record = records[index];
+    relink(archetypes[record.archetype]->erase(record.row, true), record.row);
+
+    records.remove(index);
+
+}
+
+
+
+void ArchetypeStorage::reserveLike(ActorID prototype, SizeT count) {
+
+    u32 index = getIndex(prototype);
+
+    if(!records.contains(index)) {
+        return;
+    }
+
+    Archetype& archetype = *archetypes[records[index].archetype];
+    archetype.reserve(archetype.getActorCount() + count);
+
+}
+
+
+
+void ArchetypeStorage::shrink() {
+
+    for(auto& archetype : archetypes) {
+        archetype->shrink();
+    }
+
+}
+
+
+
+bool ArchetypeStorage::contains(ComponentID id, ActorID actor) const {
+
+    u32 index = getIndex(actor);
+    return records.contains(index) && archetypes[records[index].archetype]->contains(id);
+
+}
+
+
+
+const std::vector<u32>& ArchetypeStorage::getMatchingArchetypes(const ComponentMask& mask) {
+
+    MatchCache& cache = matchCaches[mask];
+
+    for(; cache.scannedArchetypes < archetypes.size(); cache.scannedArchetypes++) {
+
+        if(archetypes[cache.scannedArchetypes]->matches(mask)) {
+            cache.indices.push_back(static_cast<u32>(cache.scannedArchetypes));
+        }
+
+    }
+
+    return cache.indices;
+
+}
+
+
+
+void* ArchetypeStorage::migrate(ActorID actor, ComponentID id, bool add) {
+
+    u32 index = getIndex(actor);
+    bool hasRecord = records.contains(index);
+
+    ComponentMask mask = hasRecord ? archetypes[records[index].archetype]->getMask() : ComponentMask();
+    mask.set(id, add);
+
+    if(mask.none()) {
+
+        //Last component removed, actor leaves the storage entirely
+        destroy(actor);
+        return nullptr;
+
+    }
+
+    u32 targetIndex = findOrCreateArchetype(mask);
+    Archetype& target = *archetypes[targetIndex];
+    u32 row = target.allocate(actor);
+
+    if(hasRecord) {
+
+        Record source = records[index];
+        Archetype& sourceArchetype = *archetypes[source.archetype];
+
+        for(ComponentID cid : sourceArchetype.getComponentIDs()) {
+
+            const ComponentTypeInfo& info = ComponentTypeInfo::get(cid);
+
+            if(cid == id) {
+                info.destroyFunction(sourceArchetype.getComponent(cid, source.row));
+            } else {
+                info.relocateFunction(target.getComponent(cid, row), sourceArchetype.getComponent(cid, source.row));
+            }
+
+        }
+
+        relink(sourceArchetype.erase(source.row, false), source.row);
+
+    }
+
+    records.set(index, Record{targetIndex, row});
+
+    return add ? target.getComponent(id, row) : nullptr;
+
+}
+
+
+
+u32 ArchetypeStorage::findOrCreateArchetype(const ComponentMask& mask) {
+
+    auto it = archetypeLookup.find(mask);
+
+    if(it != archetypeLookup.end()) {
+        return it->second;
+    }
+
+    u32 index = static_cast<u32>(archetypes.size());
+    archetypes.emplace_back(std::make_unique<Archetype>(mask));
+    archetypeLookup.emplace(mask, index);
+
+    return index;
+
+}
+
+
+
+void ArchetypeStorage::relink(ActorID movedActor, u32 row) {
+
+    if(movedActor != Archetype::invalidActor) {
+        records[getIndex(movedActor)].row = row;
+    }
+
+}
\ No newline at end of file
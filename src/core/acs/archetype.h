@@ -0,0 +1,390 @@
+#pragma once
+
+#include "components.h"
+#include "actor.h"
+#include "util/sparsearray.h"
+#include "util/optionalref.h"
+#include "util/math.h"
+#include "core/memory/memory.h"
+#include "core/memory/sizeclassallocator.h"
+#include "arcconfig.h"
+#include "types.h"
+
+#include <bitset>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+
+
+
+using ComponentMask = std::bitset<ARC_ACS_MAX_COMPONENTS>;
+
+
+/*
+    Type-erased description of a component type.
+    Archetypes only know their components by ID, hence all operations on raw component memory go through this table.
+*/
+struct ComponentTypeInfo {
+
+    template<Component C>
+    constexpr static ComponentTypeInfo create() noexcept {
+        return ComponentTypeInfo{sizeof(C), alignof(C), &relocate<C>, &destroy<C>};
+    }
+
+    //Returns the type info of the component with the given ID
+    static const ComponentTypeInfo& get(ComponentID id) noexcept;
+
+    SizeT size;
+    AlignT align;
+    void(*relocateFunction)(void* dest, void* src);
+    void(*destroyFunction)(void* ptr);
+
+private:
+
+    template<Component C>
+    static void relocate(void* dest, void* src) {
+
+        C* c = static_cast<C*>(src);
+        Memory::construct<C>(dest, std::move(*c));
+        Memory::destroy(c);
+
+    }
+
+    template<Component C>
+    static void destroy(void* ptr) {
+        Memory::destroy(static_cast<C*>(ptr));
+    }
+
+};
+
+
+
+/*
+    Archetype
+    Stores all actors sharing the exact same component set in fixed-size chunks of ARC_ACS_CHUNK_SIZE bytes.
+
+    Each chunk is laid out as SoA:
+    +----------------------+------------------+-----+------------------+
+    | ActorID[capacity]    | C0[capacity]     | ... | Cn[capacity]     |
+    +----------------------+------------------+-----+------------------+
+
+    Rows are kept dense: Removal moves the last row into the freed slot, so every chunk except the last one is always full.
+    Rows are addressed globally, i.e. row r resides in chunk r / capacity at index r % capacity.
+*/
+class Archetype {
+
+public:
+
+    constexpr static ActorID invalidActor = -1;
+    constexpr static AlignT chunkAlign = 64;
+
+    explicit Archetype(const ComponentMask& mask);
+    ~Archetype();
+
+    Archetype(const Archetype& archetype) = delete;
+    Archetype& operator=(const Archetype& archetype) = delete;
+
+
+    /*
+        Appends a new row for actor and returns its index.
+        Component memory of the new row is left uninitialized and must be constructed by the caller.
+    */
+    u32 allocate(ActorID actor);
+
+
+    /*
+        Removes the given row by relocating the last row into its place.
+        If destroyComponents is false, the components of row must have been relocated beforehand.
+        Returns the actor that now occupies row or invalidActor if row was the last one.
+    */
+    ActorID erase(u32 row, bool destroyComponents);
+
+
+    /*
+        Ensures that at least count actors can be stored without allocating new chunks.
+    */
+    void reserve(SizeT count);
+
+
+    /*
+        Releases all chunks that hold no actors, including reserved ones.
+        Chunks are never freed by erase, so this must be called explicitly after mass destruction.
+    */
+    void shrink();
+
+
+    bool contains(ComponentID id) const noexcept {
+        return mask.test(id);
+    }
+
+    bool matches(const ComponentMask& required) const noexcept {
+        return (mask & required) == required;
+    }
+
+    const ComponentMask& getMask() const noexcept {
+        return mask;
+    }
+
+    const std::vector<ComponentID>& getComponentIDs() const noexcept {
+        return componentIDs;
+    }
+
+    u32 getChunkCapacity() const noexcept {
+        return chunkCapacity;
+    }
+
+    u32 getActorCount() const noexcept {
+        return actorCount;
+    }
+
+    //Returns the number of chunks that hold at least one actor
+    SizeT getChunkCount() const noexcept {
+        return (actorCount + chunkCapacity - 1) / chunkCapacity;
+    }
+
+    //Returns the number of actors stored in the given chunk
+    u32 getChunkSize(SizeT chunk) const noexcept {
+
+        SizeT start = chunk * chunkCapacity;
+        return start >= actorCount ? 0 : static_cast<u32>(Math::min<SizeT, SizeT>(actorCount - start, chunkCapacity));
+
+    }
+
+    ActorID* getActorData(SizeT chunk) const noexcept {
+        return reinterpret_cast<ActorID*>(chunks[chunk]);
+    }
+
+    void* getComponentData(ComponentID id, SizeT chunk) const noexcept {
+        return chunks[chunk] + componentOffsets[id];
+    }
+
+    template<Component C>
+    C* getComponentData(SizeT chunk) const noexcept {
+        return static_cast<C*>(getComponentData(ComponentHelper::getComponentID<C>(), chunk));
+    }
+
+    ActorID getActor(u32 row) const noexcept {
+        return getActorData(row / chunkCapacity)[row % chunkCapacity];
+    }
+
+    void* getComponent(ComponentID id, u32 row) const noexcept {
+        return static_cast<Byte*>(getComponentData(id, row / chunkCapacity)) + (row % chunkCapacity) * ComponentTypeInfo::get(id).size;
+    }
+
+    template<Component C>
+    C& getComponent(u32 row) const noexcept {
+        return getComponentData<ComponentHelper::SharedType<C>>(row / chunkCapacity)[row % chunkCapacity];
+    }
+
+private:
+
+    //Computes the chunk capacity and the component offsets within a chunk
+    void createLayout();
+
+    //Allocates a new chunk and appends it to the chunk list
+    void createChunk();
+
+    ComponentMask mask;
+    std::vector<ComponentID> componentIDs;
+    std::vector<u32> componentOffsets;
+    std::vector<Byte*> chunks;
+    u32 chunkCapacity;
+    u32 actorCount;
+
+};
+
+
+
+/*
+    ArchetypeStorage
+    Component storage backend that groups actors by their archetype.
+    Adding or removing a component moves the actor's row into the archetype matching its new component set.
+*/
+class ArchetypeStorage {
+
+public:
+
+    ArchetypeStorage() = default;
+
+    ArchetypeStorage(const ArchetypeStorage& storage) = delete;
+    ArchetypeStorage& operator=(const ArchetypeStorage& storage) = delete;
+
+
+    template<Component C>
+    bool add(ActorID actor, C&& component) {
+
+        using T = ComponentHelper::SharedType<C>;
+        constexpr ComponentID id = ComponentHelper::getComponentID<C>();
+
+        if(contains(id, actor)) {
+            return false;
+        }
+
+        Memory::construct<T>(migrate(actor, id, true), std::forward<C>(component));
+
+        return true;
+
+    }
+
+    template<Component C>
+    void set(ActorID actor, C&& component) {
+
+        if(contains<C>(actor)) {
+            get<C>(actor) = std::forward<C>(component);
+        } else {
+            add(actor, std::forward<C>(component));
+        }
+
+    }
+
+    template<Component C>
+    ComponentHelper::SharedType<C>& get(ActorID actor) {
+
+        const Record& record = records[getIndex(actor)];
+        return archetypes[record.archetype]->getComponent<C>(record.row);
+
+    }
+
+    template<Component C>
+    const ComponentHelper::SharedType<C>& get(ActorID actor) const {
+
+        const Record& record = records[getIndex(actor)];
+        return archetypes[record.archetype]->getComponent<C>(record.row);
+
+    }
+
+    template<Component C>
+    OptionalRef<ComponentHelper::SharedType<C>> tryGet(ActorID actor) {
+
+        if(!contains<C>(actor)) {
+            return {};
+        }
+
+        return get<C>(actor);
+
+    }
+
+    template<Component C>
+    OptionalRef<const ComponentHelper::SharedType<C>> tryGet(ActorID actor) const {
+
+        if(!contains<C>(actor)) {
+            return {};
+        }
+
+        return get<C>(actor);
+
+    }
+
+    template<Component C>
+    bool contains(ActorID actor) const {
+        return contains(ComponentHelper::getComponentID<C>(), actor);
+    }
+
+    template<Component C>
+    bool remove(ActorID actor) {
+
+        constexpr ComponentID id = ComponentHelper::getComponentID<C>();
+
+        if(!contains(id, actor)) {
+            return false;
+        }
+
+        migrate(actor, id, false);
+
+        return true;
+
+    }
+
+    template<Component C>
+    SizeT getActorCount() const {
+
+        constexpr ComponentID id = ComponentHelper::getComponentID<C>();
+        SizeT count = 0;
+
+        for(const auto& archetype : archetypes) {
+
+            if(archetype->contains(id)) {
+                count += archetype->getActorCount();
+            }
+
+        }
+
+        return count;
+
+    }
+
+    template<Component... Types>
+    static ComponentMask createMask() {
+
+        ComponentMask mask;
+        (mask.set(ComponentHelper::getComponentID<Types>()), ...);
+
+        return mask;
+
+    }
+
+
+    //Removes the actor with all of its components
+    void destroy(ActorID actor);
+
+    //Reserves space for count additional actors in the archetype of prototype
+    void reserveLike(ActorID prototype, SizeT count);
+
+    //Releases unused chunks of all archetypes
+    void shrink();
+
+    //Returns true if the actor owns the component with the given ID
+    bool contains(ComponentID id, ActorID actor) const;
+
+    /*
+        Returns the indices of all archetypes that contain the component set given by mask.
+        Since archetypes are never destroyed, the list is cached per mask and only extended by newly created archetypes.
+    */
+    const std::vector<u32>& getMatchingArchetypes(const ComponentMask& mask);
+
+    Archetype& getArchetype(u32 index) noexcept {
+        return *archetypes[index];
+    }
+
+    const Archetype& getArchetype(u32 index) const noexcept {
+        return *archetypes[index];
+    }
+
+    SizeT getArchetypeCount() const noexcept {
+        return archetypes.size();
+    }
+
+private:
+
+    struct Record {
+        u32 archetype;
+        u32 row;
+    };
+
+    struct MatchCache {
+        SizeT scannedArchetypes = 0;
+        std::vector<u32> indices;
+    };
+
+    constexpr static u32 getIndex(ActorID actor) noexcept {
+        return actor & 0xFFFFFFFF;
+    }
+
+    /*
+        Moves the actor into the archetype that results from adding (add = true) or removing (add = false) component id.
+        Returns a pointer to the uninitialized component memory when adding, nullptr otherwise.
+    */
+    void* migrate(ActorID actor, ComponentID id, bool add);
+
+    //Returns the index of the archetype with the given mask. The archetype is created if it doesn't exist yet.
+    u32 findOrCreateArchetype(const ComponentMask& mask);
+
+    //Updates the row of the actor that got moved into row by an erase
+    void relink(ActorID movedActor, u32 row);
+
+    std::vector<std::unique_ptr<Archetype>> archetypes;
+    SizeClassMap<ComponentMask, u32> archetypeLookup;
+    SizeClassMap<ComponentMask, MatchCache> matchCaches;
+    SparseArray<Record, u32, SizeClassAdapter<Record>> records;
+
+};
\ No newline at end of file
@@ -0,0 +1,345 @@
+#pragma once
+
+#include "componentprovider.h"
+#include "archetype.h"
+#include "actorregistry.h"
+#include "component/component.h"
+#include "core/thread/taskexecutor.h"
+#include "util/concepts.h"
+
+#include <tuple>
+#include <vector>
+
+
+
+/*
+    Component view for archetype storage.
+    Instead of probing sparse arrays, the view walks all archetypes containing the requested components chunk by chunk.
+    Every element is guaranteed to match, so iteration is a linear sweep over contiguous component arrays.
+*/
+template<Component... Types>
+class ComponentView {
+
+public:
+
+    static_assert((BaseType<Types> && ...), "View types must be non-qualified");
+
+    constexpr static SizeT TypeCount = sizeof...(Types);
+
+
+    template<bool Const>
+    class IteratorBase {
+
+        template<class T>
+        using Qualified = std::conditional_t<Const, const T, T>;
+
+    public:
+
+        using Tuple             = std::tuple<Qualified<Types>&...>;
+
+        using iterator_category = std::bidirectional_iterator_tag;
+        using difference_type   = std::ptrdiff_t;
+        using value_type        = Tuple;
+        using pointer           = value_type;
+        using reference         = value_type;
+
+        constexpr IteratorBase() noexcept : storage(nullptr), archetypes(nullptr), archetypeIndex(0), chunkIndex(0), row(0), chunkSize(0), data() {}
+
+        template<bool ConstOther> requires (Const && !ConstOther)
+        constexpr IteratorBase(const IteratorBase<ConstOther>& it) noexcept :
+            storage(it.storage), archetypes(it.archetypes), archetypeIndex(it.archetypeIndex), chunkIndex(it.chunkIndex), row(it.row), chunkSize(it.chunkSize), data(it.data) {}
+
+        IteratorBase(ArchetypeStorage& storage, const std::vector<u32>& archetypes, bool begin) : storage(&storage), archetypes(&archetypes), archetypeIndex(0), chunkIndex(0), row(0), chunkSize(0), data() {
+
+            if(begin) {
+                seekForward();
+            } else {
+                archetypeIndex = archetypes.size();
+            }
+
+        }
+
+        constexpr reference operator*() const noexcept { return std::tie(std::get<Qualified<Types>*>(data)[row]...); }
+        constexpr pointer operator->()  const noexcept { return std::tie(std::get<Qualified<Types>*>(data)[row]...); }
+
+        IteratorBase& operator++() {step(); return *this;}
+        IteratorBase operator++(int) {IteratorBase cpy = *this; ++(*this); return cpy;}
+        IteratorBase& operator--() {retreat(); return *this;}
+        IteratorBase operator--(int) {IteratorBase cpy = *this; --(*this); return cpy;}
+
+        constexpr bool operator==(const IteratorBase& other) const noexcept {
+            return archetypeIndex == other.archetypeIndex && chunkIndex == other.chunkIndex && row == other.row;
+        }
+
+        //Returns the actor the iterator currently points to
+        ActorID getActor() const noexcept {
+            return currentArchetype().getActorData(chunkIndex)[row];
+        }
+
+    private:
+
+        template<bool>
+        friend class IteratorBase;
+
+        const Archetype& currentArchetype() const noexcept {
+            return storage->getArchetype((*archetypes)[archetypeIndex]);
+        }
+
+        void loadChunk() {
+
+            const Archetype& archetype = currentArchetype();
+
+            chunkSize = archetype.getChunkSize(chunkIndex);
+            data = std::tuple<Qualified<Types>*...>(archetype.template getComponentData<Types>(chunkIndex)...);
+
+        }
+
+        //Advances to the first row of the next non-empty chunk, starting at the current one
+        void seekForward() {
+
+            for(; archetypeIndex < archetypes->size(); archetypeIndex++, chunkIndex = 0) {
+
+                if(chunkIndex < currentArchetype().getChunkCount()) {
+
+                    row = 0;
+                    loadChunk();
+                    return;
+
+                }
+
+            }
+
+            chunkIndex = 0;
+            row = 0;
+
+        }
+
+        void step() {
+
+            if(++row < chunkSize) {
+                return;
+            }
+
+            chunkIndex++;
+            seekForward();
+
+        }
+
+        void retreat() {
+
+            if(row > 0 && archetypeIndex < archetypes->size()) {
+                row--;
+                return;
+            }
+
+            //Move to the last row of the previous non-empty chunk
+            while(true) {
+
+                if(chunkIndex > 0) {
+                    chunkIndex--;
+                } else {
+
+                    arc_assert(archetypeIndex > 0, "Cannot decrement view iterator past the beginning");
+
+                    archetypeIndex--;
+                    chunkIndex = currentArchetype().getChunkCount();
+                    continue;
+
+                }
+
+                loadChunk();
+                row = chunkSize - 1;
+                return;
+
+            }
+
+        }
+
+        ArchetypeStorage* storage;
+        const std::vector<u32>* archetypes;
+        SizeT archetypeIndex;
+        SizeT chunkIndex;
+        u32 row;
+        u32 chunkSize;
+        std::tuple<Qualified<Types>*...> data;
+
+    };
+
+    using Iterator = IteratorBase<false>;
+    using ConstIterator = IteratorBase<true>;
+
+    using ReverseIterator = std::reverse_iterator<Iterator>;
+    using ConstReverseIterator = std::reverse_iterator<ConstIterator>;
+
+
+    ComponentView(ComponentProvider& provider, const ActorRegistry&) : storage(provider.getStorage()), archetypes(storage.getMatchingArchetypes(ArchetypeStorage::createMask<Types...>())) {}
+
+
+    /*
+        Invokes func(count, Types*...) for every matching chunk.
+        This is the fastest way to traverse a view since the inner loop runs over plain arrays.
+    */
+    template<class Func>
+    void eachChunk(Func&& func) {
+
+        for(u32 index : archetypes) {
+
+            Archetype& archetype = storage.getArchetype(index);
+
+            for(SizeT chunk = 0; chunk < archetype.getChunkCount(); chunk++) {
+                func(archetype.getChunkSize(chunk), archetype.template getComponentData<Types>(chunk)...);
+            }
+
+        }
+
+    }
+
+
+    /*
+        Processes the view on the executor's worker threads. Work is distributed in whole chunks, covering at least grainSize actors per range.
+        func is invoked as func(Types&...) or func(index, Types&...) where index is the actor's position in the view.
+        Components must not be added or removed during the call. Returns once all actors have been processed.
+    */
+    template<class Func>
+    void parallelEach(TaskExecutor& executor, SizeT grainSize, Func&& func) {
+
+        struct ChunkRange {
+            Archetype* archetype;
+            SizeT chunk;
+            SizeT baseIndex;
+        };
+
+        std::vector<ChunkRange> ranges;
+        SizeT baseIndex = 0;
+        SizeT chunkCapacity = 1;
+
+        for(u32 index : archetypes) {
+
+            Archetype& archetype = storage.getArchetype(index);
+            chunkCapacity = Math::max<SizeT, SizeT>(chunkCapacity, archetype.getChunkCapacity());
+
+            for(SizeT chunk = 0; chunk < archetype.getChunkCount(); chunk++) {
+
+                ranges.push_back(ChunkRange{&archetype, chunk, baseIndex});
+                baseIndex += archetype.getChunkSize(chunk);
+
+            }
+
+        }
+
+        executor.parallelFor(ranges.size(), (grainSize + chunkCapacity - 1) / chunkCapacity, [&](SizeT start, SizeT end) {
+
+            for(SizeT r = start; r < end; r++) {
+
+                const ChunkRange& range = ranges[r];
+                std::tuple<Types*...> data(range.archetype->template getComponentData<Types>(range.chunk)...);
+                u32 count = range.archetype->getChunkSize(range.chunk);
+
+                for(u32 i = 0; i < count; i++) {
+
+                    if constexpr (std::is_invocable_v<Func&, SizeT, Types&...>) {
+                        func(range.baseIndex + i, std::get<Types*>(data)[i]...);
+                    } else {
+                        func(std::get<Types*>(data)[i]...);
+                    }
+
+                }
+
+            }
+
+        });
+
+    }
+
+
+    /*
+        Returns an iterator to the start of the view.
+    */
+    Iterator begin() {
+        return Iterator(storage, archetypes, true);
+    }
+
+
+    ConstIterator begin() const {
+        return cbegin();
+    }
+
+
+    /*
+        Returns an iterator to the end of the view.
+    */
+    Iterator end() {
+        return Iterator(storage, archetypes, false);
+    }
+
+
+    ConstIterator end() const {
+        return cend();
+    }
+
+
+
+    /*
+        Returns a const iterator to the start of the view.
+    */
+    ConstIterator cbegin() const {
+        return ConstIterator(storage, archetypes, true);
+    }
+
+
+    /*
+        Returns a const iterator to the end of the view.
+    */
+    ConstIterator cend() const {
+        return ConstIterator(storage, archetypes, false);
+    }
+
+
+    /*
+        Returns a reverse iterator to the start of the view.
+    */
+    ReverseIterator rbegin() {
+        return ReverseIterator(end());
+    }
+
+
+    ConstReverseIterator rbegin() const {
+        return ConstReverseIterator(end());
+    }
+
+
+    /*
+        Returns a reverse iterator to the end of the view.
+    */
+    ReverseIterator rend() {
+        return ReverseIterator(begin());
+    }
+
+
+    ConstReverseIterator rend() const {
+        return ConstReverseIterator(begin());
+    }
+
+
+    /*
+        Returns a const reverse iterator to the start of the view.
+    */
+    ConstReverseIterator crbegin() const {
+        return ConstReverseIterator(cend());
+    }
+
+
+    /*
+        Returns a const reverse iterator to the end of the view.
+    */
+    ConstReverseIterator crend() const {
+        return ConstReverseIterator(cbegin());
+    }
+
+
+private:
+
+    ArchetypeStorage& storage;
+    const std::vector<u32>& archetypes;
+
+};
\ No newline at end of file
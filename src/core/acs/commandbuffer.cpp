@@ -0,0 +1,263 @@
+#include "commandbuffer.h"
+#include "actormanager.h"
+#include "util/math.h"
+#include "util/assert.h"
+
+#include <new>
+#include <thread>
+#include <algorithm>
+
+
+
+CommandBuffer::~CommandBuffer() {
+    clear();
+}
+
+
+
+void CommandBuffer::spawn(ActorTypeID type) {
+
+    Shard& shard = getShard();
+    std::lock_guard lock(shard.mutex);
+
+    shard.commands.push_back(Command{CommandType::Spawn, type, 0, nullptr, nullptr});
+
+}
+
+
+
+void CommandBuffer::spawn(ActorTypeID type, const Transform& transform) {
+
+    Shard& shard = getShard();
+    std::lock_guard lock(shard.mutex);
+
+    void* payload = shard.allocate(sizeof(Transform), alignof(Transform));
+    ::new(payload) Transform(transform);
+
+    shard.commands.push_back(Command{CommandType::Spawn, type, 0, payload, &operations<Transform>});
+
+}
+
+
+
+void CommandBuffer::destroy(ActorID actor) {
+
+    Shard& shard = getShard();
+    std::lock_guard lock(shard.mutex);
+
+    shard.commands.push_back(Command{CommandType::Destroy, 0, actor, nullptr, nullptr});
+
+}
+
+
+
+void CommandBuffer::clear() {
+
+    for(Shard& shard : shards) {
+
+        std::lock_guard lock(shard.mutex);
+        shard.clear();
+
+    }
+
+}
+
+
+
+bool CommandBuffer::empty() const {
+    return getCommandCount() == 0;
+}
+
+
+
+SizeT CommandBuffer::getCommandCount() const {
+
+    SizeT count = 0;
+
+    for(const Shard& shard : shards) {
+
+        std::lock_guard lock(shard.mutex);
+        count += shard.commands.size();
+
+    }
+
+    return count;
+
+}
+
+
+
+void CommandBuffer::playback(ActorManager& manager) {
+
+    std::vector<Command> commands;
+    commands.reserve(getCommandCount());
+
+    for(Shard& shard : shards) {
+
+        std::lock_guard lock(shard.mutex);
+        commands.insert(commands.end(), shard.commands.begin(), shard.commands.end());
+
+    }
+
+    //Group commands by phase and key. Spawns are additionally split by whether they carry a transform.
+    std::stable_sort(commands.begin(), commands.end(), [](const Command& a, const Command& b) {
+
+        if(a.type != b.type) {
+            return a.type < b.type;
+        }
+
+        if(a.key != b.key) {
+            return a.key < b.key;
+        }
+
+        return a.type == CommandType::Spawn && (a.payload != nullptr) < (b.payload != nullptr);
+
+    });
+
+    std::vector<Transform> transforms;
+    std::vector<ActorID> actors;
+
+    SizeT i = 0;
+
+    //Spawns, one batch per actor type
+    while(i < commands.size() && commands[i].type == CommandType::Spawn) {
+
+        SizeT start = i;
+        ActorTypeID type = commands[i].key;
+        bool hasTransform = commands[i].payload;
+
+        transforms.clear();
+
+        for(; i < commands.size() && commands[i].type == CommandType::Spawn && commands[i].key == type && bool(commands[i].payload) == hasTransform; i++) {
+
+            if(hasTransform) {
+                transforms.push_back(*static_cast<const Transform*>(commands[i].payload));
+            }
+
+        }
+
+        manager.spawnBatch(type, i - start, transforms);
+
+    }
+
+    //Component additions, grouped by component. Created observers fire once per component type.
+    for(; i < commands.size() && commands[i].type == CommandType::Add; i++) {
+
+        const Command& command = commands[i];
+
+        if(manager.isAlive(command.actor)) {
+            command.operations->add(manager, command.actor, command.payload);
+        }
+
+    }
+
+    manager.observer.invokeAll();
+
+    //Component removals, one batch per component
+    while(i < commands.size() && commands[i].type == CommandType::Remove) {
+
+        const Command& command = commands[i];
+
+        actors.clear();
+
+        for(; i < commands.size() && commands[i].type == CommandType::Remove && commands[i].key == command.key; i++) {
+
+            if(manager.isAlive(commands[i].actor)) {
+                actors.push_back(commands[i].actor);
+            }
+
+        }
+
+        std::sort(actors.begin(), actors.end());
+        actors.erase(std::unique(actors.begin(), actors.end()), actors.end());
+
+        command.operations->remove(manager, actors);
+
+    }
+
+    //Destructions in a single batch
+    actors.clear();
+
+    for(; i < commands.size(); i++) {
+
+        if(manager.isAlive(commands[i].actor)) {
+            actors.push_back(commands[i].actor);
+        }
+
+    }
+
+    std::sort(actors.begin(), actors.end());
+    actors.erase(std::unique(actors.begin(), actors.end()), actors.end());
+
+    manager.destroyBatch(actors);
+
+    clear();
+
+}
+
+
+
+CommandBuffer::Shard& CommandBuffer::getShard() {
+    return shards[std::hash<std::thread::id>{}(std::this_thread::get_id()) % shardCount];
+}
+
+
+
+
+
+CommandBuffer::Shard::~Shard() {
+    clear();
+}
+
+
+
+void* CommandBuffer::Shard::allocate(SizeT size, AlignT align) {
+
+    arc_assert(align <= blockAlign, "Command payload alignment %d exceeds the block alignment", align);
+
+    //Oversized payloads get a dedicated block placed behind the current one
+    if(size + align > blockSize) {
+
+        Byte* block = static_cast<Byte*>(::operator new(size, std::align_val_t(blockAlign)));
+        blocks.insert(blocks.empty() ? blocks.end() : blocks.end() - 1, block);
+
+        return block;
+
+    }
+
+    AddressT address = blocks.empty() ? 0 : Math::alignUp(reinterpret_cast<AddressT>(blocks.back()) + blockOffset, align);
+
+    if(blocks.empty() || address + size > reinterpret_cast<AddressT>(blocks.back()) + blockSize) {
+
+        blocks.push_back(static_cast<Byte*>(::operator new(blockSize, std::align_val_t(blockAlign))));
+        address = Math::alignUp(reinterpret_cast<AddressT>(blocks.back()), align);
+
+    }
+
+    blockOffset = address + size - reinterpret_cast<AddressT>(blocks.back());
+
+    return reinterpret_cast<void*>(address);
+
+}
+
+
+
+void CommandBuffer::Shard::clear() {
+
+    for(const Command& command : commands) {
+
+        if(command.payload) {
+            command.operations->destroy(command.payload);
+        }
+
+    }
+
+    for(Byte* block : blocks) {
+        ::operator delete(block, std::align_val_t(blockAlign));
+    }
+
+    commands.clear();
+    blocks.clear();
+    blockOffset = blockSize;
+
+}
\ No newline at end of file
@@ -0,0 +1,139 @@
+#pragma once
+
+#include "actor.h"
+#include "components.h"
+#include "util/concepts.h"
+#include "types.h"
+
+#include <span>
+#include <array>
+#include <mutex>
+#include <vector>
+
+
+
+class ActorManager;
+
+/*
+    Deferred structural changes
+    Records spawns, destructions and component additions/removals without touching the component storage.
+    Recording is thread-safe, so systems can record while views are being iterated, even from worker threads.
+    The buffer is applied by ActorManager::playback() in a single sorted pass: spawns, additions, removals and destructions are each grouped and executed in bulk.
+    Commands from different threads have no defined order relative to each other.
+*/
+class CommandBuffer {
+
+public:
+
+    CommandBuffer() = default;
+    ~CommandBuffer();
+
+    CommandBuffer(const CommandBuffer& buffer) = delete;
+    CommandBuffer& operator=(const CommandBuffer& buffer) = delete;
+
+
+    void spawn(ActorTypeID type);
+    void spawn(ActorTypeID type, const Transform& transform);
+    void destroy(ActorID actor);
+
+    template<Component C>
+    void addComponent(ActorID actor, C&& component) {
+
+        using T = ComponentHelper::SharedType<C>;
+
+        Shard& shard = getShard();
+        std::lock_guard lock(shard.mutex);
+
+        void* payload = shard.allocate(sizeof(T), alignof(T));
+        ::new(payload) T(std::forward<C>(component));
+
+        shard.commands.push_back(Command{CommandType::Add, ComponentHelper::getComponentID<T>(), actor, payload, &operations<T>});
+
+    }
+
+    template<Component C>
+    void removeComponent(ActorID actor) {
+
+        using T = ComponentHelper::SharedType<C>;
+
+        Shard& shard = getShard();
+        std::lock_guard lock(shard.mutex);
+
+        shard.commands.push_back(Command{CommandType::Remove, ComponentHelper::getComponentID<T>(), actor, nullptr, &operations<T>});
+
+    }
+
+
+    //Discards all recorded commands
+    void clear();
+
+    bool empty() const;
+    SizeT getCommandCount() const;
+
+private:
+
+    friend class ActorManager;
+
+    //Order defines the playback phases
+    enum class CommandType : u8 {
+        Spawn,
+        Add,
+        Remove,
+        Destroy
+    };
+
+    struct Operations {
+        void(*add)(ActorManager& manager, ActorID actor, void* payload);
+        void(*remove)(ActorManager& manager, std::span<const ActorID> actors);
+        void(*destroy)(void* payload);
+    };
+
+    struct Command {
+        CommandType type;
+        u32 key;
+        ActorID actor;
+        void* payload;
+        const Operations* operations;
+    };
+
+    struct alignas(64) Shard {
+
+        ~Shard();
+
+        //Returns memory for a payload. Blocks are never moved, so payloads stay in place until the buffer is cleared.
+        void* allocate(SizeT size, AlignT align);
+        void clear();
+
+        mutable std::mutex mutex;
+        std::vector<Command> commands;
+        std::vector<Byte*> blocks;
+        SizeT blockOffset = blockSize;
+
+    };
+
+    constexpr static SizeT shardCount = 16;
+    constexpr static SizeT blockSize = 4096;
+    constexpr static AlignT blockAlign = 64;
+
+    template<Component C>
+    static void addOperation(ActorManager& manager, ActorID actor, void* payload);
+
+    template<Component C>
+    static void removeOperation(ActorManager& manager, std::span<const ActorID> actors);
+
+    template<Component C>
+    static void destroyOperation(void* payload) {
+        static_cast<C*>(payload)->~C();
+    }
+
+    template<Component C>
+    constexpr static Operations operations = { &addOperation<C>, &removeOperation<C>, &destroyOperation<C> };
+
+    //Applies all commands to the manager and clears the buffer
+    void playback(ActorManager& manager);
+
+    Shard& getShard();
+
+    std::array<Shard, shardCount> shards;
+
+};
\ No newline at end of file
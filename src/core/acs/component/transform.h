@@ -2,6 +2,7 @@
 
 #include "component.h"
 #include "util/vector.h"
+#include "util/quaternion.h"
 
 
 class Transform : public IComponent {
@@ -9,10 +10,10 @@ class Transform : public IComponent {
 public:
 
 	constexpr Transform() : Transform(Vec3x(0)) {}
-	constexpr Transform(const Vec3x& position, const Vec3x& rotation = Vec3x(0), const Vec3x& scale = Vec3x(1)) : position(position), rotation(rotation), scale(scale) {}
+	constexpr Transform(const Vec3x& position, const Quatx& rotation = Quatx(), const Vec3x& scale = Vec3x(1)) : position(position), rotation(rotation), scale(scale) {}
 
 	Vec3x position;
-	Vec3x rotation; //ok use QuatX later
+	Quatx rotation;
 	Vec3x scale;
 
 };
\ No newline at end of file
@@ -0,0 +1,228 @@
+#pragma once
+
+#include "componentprovider.h"
+#include "component/component.h"
+#include "core/thread/taskexecutor.h"
+#include "core/memory/sizeclassallocator.h"
+#include "util/sparsearray.h"
+#include "util/concepts.h"
+
+#include <tuple>
+
+
+
+class IComponentGroup {
+
+public:
+
+    virtual ~IComponentGroup() = default;
+
+    virtual void tryAdd(ActorID actor) = 0;
+    virtual void remove(ActorID actor) = 0;
+
+};
+
+
+/*
+    Cached list of all actors owning every component in Types.
+    The list is maintained incrementally through component observers, so iterating a group costs O(matches) instead of a full view scan.
+    Only component changes issued through the ActorManager are tracked.
+    Every change of the membership bumps the group's version, so consumers can detect added or removed actors without comparing the lists.
+*/
+template<Component... Types>
+class ComponentGroup : public IComponentGroup {
+
+    using ActorArray = SparseArray<ActorID, u32, SizeClassAdapter<ActorID>>;
+
+public:
+
+    static_assert((BaseType<Types> && ...), "Group types must be non-qualified");
+
+
+    template<bool Const>
+    class IteratorBase {
+
+        using Provider = std::conditional_t<Const, const ComponentProvider, ComponentProvider>;
+
+    public:
+
+        using Tuple             = std::tuple<std::conditional_t<Const, const Types&, Types&>...>;
+
+        using iterator_category = std::bidirectional_iterator_tag;
+        using difference_type   = std::ptrdiff_t;
+        using value_type        = Tuple;
+        using pointer           = value_type;
+        using reference         = value_type;
+
+        constexpr IteratorBase() noexcept : provider(nullptr), it(nullptr) {}
+
+        template<bool ConstOther> requires (Const && !ConstOther)
+        constexpr IteratorBase(const IteratorBase<ConstOther>& other) noexcept : provider(other.provider), it(other.it) {}
+
+        constexpr IteratorBase(Provider& provider, ActorArray::ConstIterator it) noexcept : provider(&provider), it(it) {}
+
+        constexpr reference operator*() const noexcept { return std::tie(provider->template getComponent<Types>(*it)...); }
+        constexpr pointer operator->()  const noexcept { return std::tie(provider->template getComponent<Types>(*it)...); }
+
+        constexpr IteratorBase& operator++() noexcept {++it; return *this;}
+        constexpr IteratorBase operator++(int) noexcept {IteratorBase cpy = *this; ++(*this); return cpy;}
+        constexpr IteratorBase& operator--() noexcept {--it; return *this;}
+        constexpr IteratorBase operator--(int) noexcept {IteratorBase cpy = *this; --(*this); return cpy;}
+
+        constexpr bool operator==(const IteratorBase& other) const noexcept {
+            return it == other.it;
+        }
+
+        //Returns the actor the iterator currently points to
+        constexpr ActorID getActor() const noexcept {
+            return *it;
+        }
+
+    private:
+
+        template<bool>
+        friend class IteratorBase;
+
+        Provider* provider;
+        ActorArray::ConstIterator it;
+
+    };
+
+    using Iterator = IteratorBase<false>;
+    using ConstIterator = IteratorBase<true>;
+
+    using ReverseIterator = std::reverse_iterator<Iterator>;
+    using ConstReverseIterator = std::reverse_iterator<ConstIterator>;
+
+
+    explicit ComponentGroup(ComponentProvider& provider) : provider(provider), version(0) {}
+
+
+    /*
+        Adds the actor if it owns all group components.
+    */
+    virtual void tryAdd(ActorID actor) override {
+
+        if((provider.hasComponent<Types>(actor) && ...) && actors.add(getIndex(actor), actor)) {
+            version++;
+        }
+
+    }
+
+
+    /*
+        Removes the actor from the group if present.
+    */
+    virtual void remove(ActorID actor) override {
+
+        if(actors.tryRemove(getIndex(actor))) {
+            version++;
+        }
+
+    }
+
+
+    /*
+        Processes the group on the executor's worker threads in ranges of grainSize actors.
+        func is invoked as func(Types&...), func(index, Types&...) or func(index, actor, Types&...) where index is the dense position in [0, getSize()).
+        Components must not be added or removed during the call. Returns once all actors have been processed.
+    */
+    template<class Func>
+    void parallelEach(TaskExecutor& executor, SizeT grainSize, Func&& func) {
+
+        executor.parallelFor(actors.getSize(), grainSize, [&](SizeT start, SizeT end) {
+
+            auto it = actors.cbegin() + start;
+
+            for(SizeT i = start; i < end; i++, ++it) {
+
+                if constexpr (std::is_invocable_v<Func&, SizeT, ActorID, Types&...>) {
+                    func(i, *it, provider.getComponent<Types>(*it)...);
+                } else if constexpr (std::is_invocable_v<Func&, SizeT, Types&...>) {
+                    func(i, provider.getComponent<Types>(*it)...);
+                } else {
+                    func(provider.getComponent<Types>(*it)...);
+                }
+
+            }
+
+        });
+
+    }
+
+
+    /*
+        Returns the number of matching actors.
+    */
+    SizeT getSize() const noexcept {
+        return actors.getSize();
+    }
+
+
+    /*
+        Returns the number of membership changes since the group's creation.
+    */
+    u64 getVersion() const noexcept {
+        return version;
+    }
+
+
+    Iterator begin() {
+        return Iterator(provider, actors.cbegin());
+    }
+
+    ConstIterator begin() const {
+        return cbegin();
+    }
+
+    Iterator end() {
+        return Iterator(provider, actors.cend());
+    }
+
+    ConstIterator end() const {
+        return cend();
+    }
+
+    ConstIterator cbegin() const {
+        return ConstIterator(provider, actors.cbegin());
+    }
+
+    ConstIterator cend() const {
+        return ConstIterator(provider, actors.cend());
+    }
+
+    ReverseIterator rbegin() {
+        return ReverseIterator(end());
+    }
+
+    ConstReverseIterator rbegin() const {
+        return ConstReverseIterator(end());
+    }
+
+    ReverseIterator rend() {
+        return ReverseIterator(begin());
+    }
+
+    ConstReverseIterator rend() const {
+        return ConstReverseIterator(begin());
+    }
+
+    ConstReverseIterator crbegin() const {
+        return ConstReverseIterator(cend());
+    }
+
+    ConstReverseIterator crend() const {
+        return ConstReverseIterator(cbegin());
+    }
+
+private:
+
+    constexpr static u32 getIndex(ActorID actor) noexcept {
+        return actor & 0xFFFFFFFF;
+    }
+
+    ComponentProvider& provider;
+    ActorArray actors;
+    u64 version;
+
+};
\ No newline at end of file
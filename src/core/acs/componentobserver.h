@@ -1,13 +1,16 @@
 #pragma once
 
 #include "components.h"
+#include "componentprovider.h"
 #include "actor.h"
 #include "arcconfig.h"
 #include "util/log.h"
 #include "util/any.h"
 #include "util/concepts.h"
+#include "core/memory/sizeclassallocator.h"
 
 #include <vector>
+#include <span>
 #include <functional>
 
 
@@ -29,6 +32,8 @@ public:
     template<Component C>
     using Function = std::function<void(ComponentHelper::SharedType<C>&, ActorID)>;
 
+    using BatchFunction = std::function<void(std::span<const ActorID>)>;
+
     ComponentObserver() {
         observerInvokables.reserve(getObserverEntryIndex(ARC_ACS_MAX_COMPONENTS));
     }
@@ -55,6 +60,32 @@ public:
 
     }
 
+
+    /*
+        Registers a callback that receives all actors of an event batch at once.
+        Batches are produced by spawns, destroys and command buffer playback. Single spawns and destroys arrive as batches of one actor.
+    */
+    template<Component C, class Func> requires Constructible<BatchFunction, Func&&>
+    void observeBatch(ComponentEvent event, Func&& callback) {
+
+        constexpr ComponentID cid = ComponentHelper::getComponentID<C>();
+        u32 oei = getObserverEntryIndex(cid, event);
+
+        if(batchInvokables.size() <= oei) {
+
+            if(cid >= ARC_ACS_MAX_COMPONENTS) {
+                Log::error("ACS", "ID %d exceeds the maximum component ID of %d", cid, ARC_ACS_MAX_COMPONENTS - 1);
+                return;
+            }
+
+            batchInvokables.resize(oei + 1);
+
+        }
+
+        batchInvokables[oei].emplace_back(std::forward<Func>(callback));
+
+    }
+
     template<Component C>
     void clear() {
 
@@ -71,6 +102,10 @@ public:
             }
 #endif
 
+            if(batchInvokables.size() > (oei + i)) {
+                batchInvokables[oei + i].clear();
+            }
+
         }
 
     }
@@ -81,6 +116,10 @@ public:
             vec.clear();
         }
 
+        for(auto& vec : batchInvokables) {
+            vec.clear();
+        }
+
     }
 
     template<Component C>
@@ -110,29 +149,124 @@ public:
 
     }
 
+    /*
+        Invokes all observers of C for the given actors.
+        Batch observers are called once, per-actor observers once per actor.
+    */
     template<Component C>
-    void record(ComponentEvent event, C& component, ActorID actor) {
+    void invokeBatch(ComponentEvent event, ComponentProvider& provider, std::span<const ActorID> actors) {
+
+        using T = ComponentHelper::SharedType<C>;
 
         constexpr ComponentID cid = ComponentHelper::getComponentID<C>();
         u32 oei = getObserverEntryIndex(cid, event);
 
-        if(oei >= observerInvokables.size() || !observerInvokables[oei].size()) {
+        if(actors.empty()) {
             return;
         }
 
-        recordedInvokables[cid] = [=, &component, this]() {
-            invokeDirect(event, component, actor);
-        };
+        if(oei < batchInvokables.size()) {
+
+            for(const auto& func : batchInvokables[oei]) {
+                func(actors);
+            }
+
+        }
+
+        if(oei < observerInvokables.size()) {
+
+            for(const auto& func : observerInvokables[oei]) {
+
+#ifdef ARC_ACS_RUNTIME_CHECKS
+                const auto& f = func.cast<Function<T>>();
+#else
+                const auto& f = func.unsafeCast<Function<T>>();
+#endif
+
+                for(ActorID actor : actors) {
+                    f(provider.getComponent<T>(actor), actor);
+                }
+
+            }
+
+        }
+
+    }
+
+
+    /*
+        Returns true if any observer listens to the given event of C
+    */
+    template<Component C>
+    bool isObserved(ComponentEvent event) const {
+
+        u32 oei = getObserverEntryIndex(ComponentHelper::getComponentID<C>(), event);
+        return (oei < observerInvokables.size() && !observerInvokables[oei].empty()) || (oei < batchInvokables.size() && !batchInvokables[oei].empty());
+
+    }
+
+
+    /*
+        Records an event for later invocation. Recorded actors are grouped per component and event, so invokeAll() fires each observer once per batch.
+        Components may be relocated until then, hence they are fetched on invocation.
+    */
+    template<Component C>
+    void record(ComponentEvent event, ComponentProvider& provider, ActorID actor) {
+
+        constexpr ComponentID cid = ComponentHelper::getComponentID<C>();
+        u32 oei = getObserverEntryIndex(cid, event);
+
+        if(!isObserved<C>(event)) {
+            return;
+        }
+
+        if(recordedEvents.size() <= oei) {
+            recordedEvents.resize(oei + 1);
+        }
+
+        RecordedEvent& recorded = recordedEvents[oei];
+
+        if(recorded.actors.empty()) {
+
+            recorded.invoker = &ComponentObserver::invokeBatch<ComponentHelper::SharedType<C>>;
+            recorded.provider = &provider;
+            recorded.event = event;
+            recordedEntries.push_back(oei);
+
+        } else if(recorded.actors.back() == actor) {
+
+            //Overwritten components report their creation only once
+            return;
+
+        }
+
+        recorded.actors.push_back(actor);
 
     }
 
     void invokeAll() {
 
-        for(const auto&[cid, func] : recordedInvokables) {
-            func();
+        //Observers might record new events, which are then processed in the same pass
+        for(SizeT i = 0; i < recordedEntries.size(); i++) {
+
+            u32 oei = recordedEntries[i];
+            RecordedEvent recorded = std::move(recordedEvents[oei]);
+
+            recordedEvents[oei].actors.clear();
+
+            (this->*recorded.invoker)(recorded.event, *recorded.provider, recorded.actors);
+
+            //Hand the buffer back to keep its capacity
+            if(recordedEvents[oei].actors.empty()) {
+
+                recorded.actors.clear();
+                recordedEvents[oei].actors.swap(recorded.actors);
+
+            }
+
         }
 
-        recordedInvokables.clear();
+        recordedEntries.clear();
 
     }
 
@@ -143,7 +277,18 @@ private:
         return id * static_cast<u32>(eventCount) + static_cast<u32>(event);
     }
 
-    std::vector<std::vector<AnyCallback>> observerInvokables;
-    std::unordered_map<ComponentID, std::function<void()>> recordedInvokables;
+    using BatchInvoker = void(ComponentObserver::*)(ComponentEvent, ComponentProvider&, std::span<const ActorID>);
+
+    struct RecordedEvent {
+        BatchInvoker invoker = nullptr;
+        ComponentProvider* provider = nullptr;
+        ComponentEvent event = ComponentEvent::Created;
+        SizeClassVector<ActorID> actors;
+    };
+
+    SizeClassVector<SizeClassVector<AnyCallback>> observerInvokables;
+    SizeClassVector<SizeClassVector<BatchFunction>> batchInvokables;
+    SizeClassVector<RecordedEvent> recordedEvents;
+    SizeClassVector<u32> recordedEntries;
 
 };
\ No newline at end of file
@@ -2,14 +2,16 @@
 
 #include "util/sparsearray.h"
 #include "util/any.h"
+#include "core/memory/sizeclassallocator.h"
 #include "components.h"
+#include "archetype.h"
 #include "arcconfig.h"
 #include "actor.h"
 
 
 
 template<class T>
-using ComponentArray = SparseArray<T, ActorID>;
+using ComponentArray = SparseArray<T, ActorID, SizeClassAdapter<T>>;
 
 
 class ComponentProvider {
@@ -18,13 +20,18 @@ class ComponentProvider {
 
 public:
 
+#ifdef ARC_ACS_ARCHETYPE_STORAGE
+    ComponentProvider() = default;
+#else
     constexpr ComponentProvider() {
         componentArrays.reserve(ARC_ACS_MAX_COMPONENTS);
     }
+#endif
 
     template<Component C>
     void createArray() {
 
+#ifndef ARC_ACS_ARCHETYPE_STORAGE
         ComponentID id = ComponentHelper::getComponentID<C>();
 
         if(id >= componentArrays.size()) {
@@ -39,57 +46,123 @@ public:
         }
 
         componentArrays[id].emplace<ComponentArray<C>>();
+#endif
 
     }
 
     template<Component C>
     bool addComponent(ActorID actor, C&& component) {
-        return getComponentArray<C>().add(actor, std::forward<C>(component));
+#ifdef ARC_ACS_ARCHETYPE_STORAGE
+        return storage.add(actor, std::forward<C>(component));
+#else
+        return getComponentArray<C>().add(actor & 0xFFFFFFFF, std::forward<C>(component));
+#endif
     }
 
     template<Component C>
     void setComponent(ActorID actor, C&& component) {
-        getComponentArray<C>().set(actor, std::forward<C>(component));
+#ifdef ARC_ACS_ARCHETYPE_STORAGE
+        storage.set(actor, std::forward<C>(component));
+#else
+        getComponentArray<C>().set(actor & 0xFFFFFFFF, std::forward<C>(component));
+#endif
     }
 
     template<Component C>
     C& getComponent(ActorID id) {
+#ifdef ARC_ACS_ARCHETYPE_STORAGE
+        return storage.get<C>(id);
+#else
         return getComponentArray<C>()[id & 0xFFFFFFFF];
+#endif
     }
 
     template<Component C>
     const C& getComponent(ActorID id) const {
+#ifdef ARC_ACS_ARCHETYPE_STORAGE
+        return storage.get<C>(id);
+#else
         return getComponentArray<C>()[id & 0xFFFFFFFF];
+#endif
     }
 
     template<Component C>
     OptionalRef<C> tryGetComponent(ActorID id) {
+#ifdef ARC_ACS_ARCHETYPE_STORAGE
+        return storage.tryGet<C>(id);
+#else
         return getComponentArray<C>().tryGet(id & 0xFFFFFFFF);
+#endif
     }
 
     template<Component C>
     OptionalRef<const C> tryGetComponent(ActorID id) const {
+#ifdef ARC_ACS_ARCHETYPE_STORAGE
+        return storage.tryGet<C>(id);
+#else
         return getComponentArray<C>().tryGet(id & 0xFFFFFFFF);
+#endif
     }
 
     template<Component C>
     bool hasComponent(ActorID id) const {
+#ifdef ARC_ACS_ARCHETYPE_STORAGE
+        return storage.contains<C>(id);
+#else
         return getComponentArray<C>().contains(id & 0xFFFFFFFF);
+#endif
     }
 
     template<Component C>
     bool tryRemoveComponent(ActorID id) {
+#ifdef ARC_ACS_ARCHETYPE_STORAGE
+        return storage.remove<C>(id);
+#else
         return getComponentArray<C>().tryRemove(id & 0xFFFFFFFF);
+#endif
     }
 
     template<Component C>
     void removeComponent(ActorID id) {
+#ifdef ARC_ACS_ARCHETYPE_STORAGE
+        storage.remove<C>(id);
+#else
         return getComponentArray<C>().remove(id & 0xFFFFFFFF);
+#endif
     }
 
     template<Component C>
     SizeT getActorCount() const {
+#ifdef ARC_ACS_ARCHETYPE_STORAGE
+        return storage.getActorCount<C>();
+#else
         return getComponentArray<C>().getSize();
+#endif
+    }
+
+    /*
+        Reserves storage for count additional actors owning the same components as prototype.
+        slotCount is the number of actor slots the sparse indices have to cover.
+    */
+    void reserveLike(ActorID prototype, SizeT count, SizeT slotCount) {
+#ifdef ARC_ACS_ARCHETYPE_STORAGE
+        storage.reserveLike(prototype, count);
+#else
+        [&]<Component... Types>(TypeTag<std::tuple<Types...>>) {
+            ((hasComponent<Types>(prototype) ? getComponentArray<Types>().reserve(slotCount, getActorCount<Types>() + count) : void()), ...);
+        }(TypeTag<ComponentTypes>{});
+#endif
+    }
+
+    //Removes all components of the given actor
+    void destroyActor(ActorID id) {
+#ifdef ARC_ACS_ARCHETYPE_STORAGE
+        storage.destroy(id);
+#else
+        [this, id]<Component... Types>(TypeTag<std::tuple<Types...>>) {
+            (tryRemoveComponent<Types>(id), ...);
+        }(TypeTag<ComponentTypes>{});
+#endif
     }
 
 private:
@@ -97,13 +170,23 @@ private:
     template<Component... Types>
     friend class ComponentView;
 
+#ifdef ARC_ACS_ARCHETYPE_STORAGE
+
+    ArchetypeStorage& getStorage() {
+        return storage;
+    }
+
+    ArchetypeStorage storage;
+
+#else
+
     template<Component C>
-    auto& getComponentArray() {
+    ComponentArray<ComponentHelper::SharedType<C>>& getComponentArray() {
         return componentCast<C>(ComponentHelper::getComponentID<C>());
     }
 
     template<Component C>
-    const auto& getComponentArray() const {
+    const ComponentArray<ComponentHelper::SharedType<C>>& getComponentArray() const {
         return componentCast<C>(ComponentHelper::getComponentID<C>());
     }
 
@@ -127,4 +210,6 @@ private:
 
     std::vector<ComponentArrayStorage> componentArrays;
 
+#endif
+
 };
\ No newline at end of file
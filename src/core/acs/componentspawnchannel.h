@@ -16,7 +16,7 @@ public:
     void add(C&& component) {
         
         if(provider.addComponent(actor, std::forward<C>(component))) {
-            observer.record(ComponentEvent::Created, provider.getComponent<std::remove_const_t<std::remove_reference_t<C>>>(actor), actor);
+            observer.record<C>(ComponentEvent::Created, provider, actor);
         }
 
     }
@@ -25,7 +25,7 @@ public:
     void overwrite(C&& component) {
 
         provider.setComponent(actor, std::forward<C>(component));
-        observer.record(ComponentEvent::Created, provider.getComponent<std::remove_const_t<std::remove_reference_t<C>>>(actor), actor);
+        observer.record<C>(ComponentEvent::Created, provider, actor);
 
     }
 
@@ -1,8 +1,15 @@
 #pragma once
 
-#include "componentviewchannel.h"
+#include "arcconfig.h"
+
+#ifdef ARC_ACS_ARCHETYPE_STORAGE
+#include "archetypeview.h"
+#else
+
 #include "componentprovider.h"
+#include "actorregistry.h"
 #include "component/component.h"
+#include "core/thread/taskexecutor.h"
 #include "util/concepts.h"
 
 #include <tuple>
@@ -13,153 +20,22 @@
 template<Component... Types>
 class ComponentView {
 
-    struct IteratorHelper {
-
-        template<class T, bool Const>
-        struct Container {
-
-            using Iterator = std::conditional_t<Const, typename ComponentArray<T>::ConstIterator, typename ComponentArray<T>::Iterator>;
-
-            constexpr Container(ComponentArray<T>& array, bool begin) : array(array), iterator([&]() { if constexpr (Const) { return begin ? array.cbegin() : array.cend(); } else { return begin ? array.begin() : array.end(); }}()) {}
-
-            ComponentArray<T>& array;
-            Iterator iterator;
-
-        };
-
-        using AnyContainer = FastAny<Container<void*, true>>;
-
-        enum class Action {
-            Reset,
-            Increment,
-            Decrement
-        };
-
-        template<class T, bool Const>
-        static AnyContainer construct(ComponentProvider& provider, ComponentViewChannel& channel, bool begin) {
-
-            AnyContainer container(TypeTag<Container<T, Const>>{}, provider.getComponentArray<T>(), begin);
-
-            if(begin) {
-                execute<T, Const>(container, channel, Action::Reset);   
-            } else {
-                channel.shift(-1);
-            }
-
-            return container;
-
-        }
-
-        template<class T, class... Pack>
-        struct Exclude {
-            using Tuple = decltype(std::tuple_cat(std::declval<std::conditional_t<std::is_same_v<T, Pack>, std::tuple<>, std::tuple<Pack>>>()...));
-        };
-
-        template<class>
-        struct ApplyComposition;
-
-        template<template<class...> class Tuple, class... Pack>
-        struct ApplyComposition<Tuple<Pack...>> {
-
-            static bool validateCompositionInternal(const ComponentViewChannel& channel) {
-                return (channel.contains<Pack>() && ...);
-            }
-
-        };
-
-        template<class T>
-        static bool validateComposition(const ComponentViewChannel& channel) {
-            return ApplyComposition<Exclude<T, Types...>::Tuple>::validateCompositionInternal(channel);
-        }
-
-        template<class T>
-        constexpr static bool unequalEnd(const ComponentArray<T>& array, const typename ComponentArray<T>::ConstIterator& it) {
-            return it != array.cend();
-        }
-
-        template<class T>
-        constexpr static bool unequalEnd(const ComponentArray<T>& array, const typename ComponentArray<T>::Iterator& it) {
-            return it != array.end();
-        }
-
-
-        template<class T, bool Const>
-        static void execute(AnyContainer& containerHandle, ComponentViewChannel& channel, Action action) {
-
-            Container<T, Const>& container = containerHandle.unsafeCast<Container<T, Const>>();
-            auto& array = container.array;
-            auto& it = container.iterator;
-
-            switch(action) {
-
-                case Action::Reset:
-                    {
-                        for(; unequalEnd(array, it); ++it) {
-
-                            channel.shift(container.array.invert(it));
-
-                            if(validateComposition<T>(channel)) {
-                                return;
-                            }
-
-                        }
-
-                        //Set to end
-                        channel.shift(-1);
-                    }
-                    break;
-
-                case Action::Increment:
-                    {
-                        while(true) {
-
-                            ++it;
-
-                            if(!unequalEnd(array, it)) {
-                                channel.shift(-1);
-                                break;
-                            }
-
-                            channel.shift(container.array.invert(it));
-
-                            if(validateComposition<T>(channel)) {
-                                break;
-                            }
-
-                        }
-                    }
-                    break;
-
-                case Action::Decrement:
-                    {            
-                        while(true) {
-
-                            --it;
-
-                            channel.shift(container.array.invert(it));
-                         
-                            if(validateComposition<T>(channel)) {
-                                break;
-                            }
-
-                        }
-                    }
-                    break;
+    //Returns the actor slot at the given dense index of the driving component array
+    using SlotFetcher = u32(*)(const ComponentProvider&, SizeT);
 
-                default:
-                    arc_force_assert("Illegal case in component view iterator helper encountered");
-                    break;
+    template<class T>
+    static u32 fetchSlot(const ComponentProvider& provider, SizeT index) {
 
-            }
+        const auto& array = provider.getComponentArray<T>();
+        return static_cast<u32>(array.invert(array.cbegin() + index));
 
-        }
+    }
 
+    struct Driver {
+        SlotFetcher fetcher;
+        SizeT size;
     };
 
-    using IteratorConstructor = IteratorHelper::AnyContainer(*)(ComponentProvider&, ComponentViewChannel&, bool);
-    using IteratorExecutor = void(*)(IteratorHelper::AnyContainer&, ComponentViewChannel&, IteratorHelper::Action);
-
-
 public:
 
     static_assert((BaseType<Types> && ...), "View types must be non-qualified");
@@ -170,52 +46,94 @@ public:
     template<bool Const>
     class IteratorBase {
 
+        using Provider = std::conditional_t<Const, const ComponentProvider, ComponentProvider>;
+
     public:
 
         using Tuple             = std::tuple<std::conditional_t<Const, const Types&, Types&>...>;
 
+        using iterator_category = std::bidirectional_iterator_tag;
         using difference_type   = std::ptrdiff_t;
         using value_type        = Tuple;
         using pointer           = value_type;
         using reference         = value_type;
 
-        constexpr IteratorBase() noexcept : provider(nullptr), executor(nullptr) {}
+        constexpr IteratorBase() noexcept : provider(nullptr), registry(nullptr), fetcher(nullptr), index(0), size(0), actor(0) {}
 
-        template<class = std::enable_if_t<Const, void>>
-        constexpr IteratorBase(const IteratorBase<false>& it) noexcept : provider(it.provider), channel(it.channel), executor(it.executor), container(it.container) {}
+        template<bool ConstOther> requires (Const && !ConstOther)
+        constexpr IteratorBase(const IteratorBase<ConstOther>& it) noexcept : provider(it.provider), registry(it.registry), fetcher(it.fetcher), index(it.index), size(it.size), actor(it.actor) {}
 
-        IteratorBase(ComponentProvider& provider, bool begin, IteratorConstructor invokableCtor, IteratorExecutor invokableExec) : provider(&provider), channel(provider, -1), executor(invokableExec), container([&]() { arc_assert(invokableCtor, "View iterator constructor cannot be null"); return invokableCtor(provider, channel, begin); } ()) {
-            arc_assert(invokableExec, "View iterator executor cannot be null");
+        IteratorBase(Provider& provider, const ActorRegistry& registry, const Driver& driver, bool begin) : provider(&provider), registry(&registry), fetcher(driver.fetcher), index(begin ? 0 : driver.size), size(driver.size), actor(0) {
+            seek();
         }
 
-        constexpr reference operator*() const noexcept { return std::tie(provider->getComponent<Types>(channel.getActor())...); }
-        constexpr pointer operator->()  const noexcept { return std::tie(provider->getComponent<Types>(channel.getActor())...); }
+        constexpr reference operator*() const noexcept { return std::tie(provider->template getComponent<Types>(actor)...); }
+        constexpr pointer operator->()  const noexcept { return std::tie(provider->template getComponent<Types>(actor)...); }
 
         IteratorBase& operator++() {step(); return *this;}
         IteratorBase operator++(int) {IteratorBase cpy = *this; ++(*this); return cpy;}
         IteratorBase& operator--() {retreat(); return *this;}
         IteratorBase operator--(int) {IteratorBase cpy = *this; --(*this); return cpy;}
-  
-        constexpr auto operator<=>(const IteratorBase& other) const noexcept = default;
 
-        constexpr auto operator==(const IteratorBase& other) const noexcept {
-            return channel.getActor() == other.channel.getActor();
+        constexpr bool operator==(const IteratorBase& other) const noexcept {
+            return index == other.index;
+        }
+
+        //Returns the actor the iterator currently points to
+        constexpr ActorID getActor() const noexcept {
+            return actor;
         }
 
     private:
 
+        template<bool>
+        friend class IteratorBase;
+
+        bool matches() const {
+            return (provider->template hasComponent<Types>(actor) && ...);
+        }
+
+        //Moves forward until an actor owning all components is found or the end is reached
+        void seek() {
+
+            for(; index < size; index++) {
+
+                actor = registry->getActor(fetcher(*provider, index));
+
+                if(matches()) {
+                    return;
+                }
+
+            }
+
+        }
+
         void step() {
-            executor(container, channel, IteratorHelper::Action::Increment);
+
+            index++;
+            seek();
+
         }
 
         void retreat() {
-            executor(container, channel, IteratorHelper::Action::Decrement);
+
+            do {
+
+                arc_assert(index > 0, "Cannot decrement view iterator past the beginning");
+
+                index--;
+                actor = registry->getActor(fetcher(*provider, index));
+
+            } while(!matches());
+
         }
 
-        ComponentProvider* provider;
-        ComponentViewChannel channel;
-        IteratorExecutor executor;
-        IteratorHelper::AnyContainer container;
+        Provider* provider;
+        const ActorRegistry* registry;
+        SlotFetcher fetcher;
+        SizeT index;
+        SizeT size;
+        ActorID actor;
 
     };
 
@@ -226,31 +144,47 @@ public:
     using ConstReverseIterator = std::reverse_iterator<ConstIterator>;
 
 
-    ComponentView(ComponentProvider& provider) : provider(provider) {
+    constexpr ComponentView(ComponentProvider& provider, const ActorRegistry& registry) noexcept : provider(provider), registry(registry) {}
+
+
+    /*
+        Processes the view on the executor's worker threads in ranges of grainSize elements of the driving array.
+        func is invoked as func(Types&...) or func(index, Types&...) where index is the position in the driving array.
+        Components must not be added or removed during the call. Returns once all elements have been processed.
+    */
+    template<class Func>
+    void parallelEach(TaskExecutor& executor, SizeT grainSize, Func&& func) {
+
+        Driver driver = selectDriver();
+
+        executor.parallelFor(driver.size, grainSize, [&](SizeT start, SizeT end) {
+
+            for(SizeT i = start; i < end; i++) {
 
-        SizeT sizes[TypeCount] = {provider.getActorCount<Types>()...};
+                ActorID actor = registry.getActor(driver.fetcher(provider, i));
 
-        constexpr static IteratorConstructor itCtor[TypeCount] = {&IteratorHelper::template construct<Types, false>...};
-        constexpr static IteratorConstructor constItCtor[TypeCount] = {&IteratorHelper::template construct<Types, true>...};
-        constexpr static IteratorExecutor itExec[TypeCount] = {&IteratorHelper::template execute<Types, false>...};
-        constexpr static IteratorExecutor constItExec[TypeCount] = {&IteratorHelper::template execute<Types, true>...};
-        
-        const auto min = std::min_element(std::begin(sizes), std::end(sizes));
-        SizeT typeIndex = std::distance(std::begin(sizes), min);
+                if(!(provider.hasComponent<Types>(actor) && ...)) {
+                    continue;
+                }
+
+                if constexpr (std::is_invocable_v<Func&, SizeT, Types&...>) {
+                    func(i, provider.getComponent<Types>(actor)...);
+                } else {
+                    func(provider.getComponent<Types>(actor)...);
+                }
+
+            }
 
-        iterCtor = itCtor[typeIndex];
-        iterExec = itExec[typeIndex];
-        constIterCtor = constItCtor[typeIndex];
-        constIterExec = constItExec[typeIndex];
+        });
 
     }
-    
+
 
     /*
         Returns an iterator to the start of the view.
     */
     Iterator begin() {
-        return Iterator(provider, true, iterCtor, iterExec);
+        return Iterator(provider, registry, selectDriver(), true);
     }
 
 
@@ -263,7 +197,7 @@ public:
         Returns an iterator to the end of the view.
     */
     Iterator end() {
-        return Iterator(provider, false, iterCtor, iterExec);
+        return Iterator(provider, registry, selectDriver(), false);
     }
 
 
@@ -276,16 +210,16 @@ public:
     /*
         Returns a const iterator to the start of the view.
     */
-    ConstIterator cbegin() {
-        return ConstIterator(provider, true, constIterCtor, constIterExec);
+    ConstIterator cbegin() const {
+        return ConstIterator(provider, registry, selectDriver(), true);
     }
 
 
     /*
         Returns a const iterator to the end of the view.
     */
-    ConstIterator cend() {
-        return ConstIterator(provider, false, constIterCtor, constIterExec);
+    ConstIterator cend() const {
+        return ConstIterator(provider, registry, selectDriver(), false);
     }
 
 
@@ -318,7 +252,7 @@ public:
     /*
         Returns a const reverse iterator to the start of the view.
     */
-    ConstReverseIterator crbegin() {
+    ConstReverseIterator crbegin() const {
         return ConstReverseIterator(cend());
     }
 
@@ -326,17 +260,31 @@ public:
     /*
         Returns a const reverse iterator to the end of the view.
     */
-    ConstReverseIterator crend() {
+    ConstReverseIterator crend() const {
         return ConstReverseIterator(cbegin());
     }
 
 
 private:
 
+    /*
+        Picks the smallest participating component array to drive the iteration.
+        Selection happens on every begin()/end() so the choice reflects the current array sizes.
+    */
+    Driver selectDriver() const {
+
+        constexpr static SlotFetcher fetchers[TypeCount] = {&fetchSlot<Types>...};
+        const SizeT sizes[TypeCount] = {provider.getActorCount<Types>()...};
+
+        SizeT typeIndex = std::distance(std::begin(sizes), std::min_element(std::begin(sizes), std::end(sizes)));
+
+        return Driver{fetchers[typeIndex], sizes[typeIndex]};
+
+    }
+
     ComponentProvider& provider;
-    IteratorConstructor iterCtor;
-    IteratorConstructor constIterCtor;
-    IteratorExecutor iterExec;
-    IteratorExecutor constIterExec;
+    const ActorRegistry& registry;
+
+};
 
-};
\ No newline at end of file
+#endif
\ No newline at end of file
@@ -2,8 +2,11 @@
 #include "util/file.h"
 #include "util/log.h"
 #include "util/matrix.h"
+#include "core/memory/sizeclassallocator.h"
 #include "config.h"
 
+#include <charconv>
+
 
 Engine::Engine() : game(window) {}
 
@@ -52,28 +55,39 @@ void Engine::run() {
 	//Start FPS tracker
 	tracker.start();
 
-	//Create the tick timer
-	Timer timer;
-	timer.start();
+	//Scratch memory for the main thread's per-frame data
+	frameArena.create(frameArenaSize);
+
+	//Start the fixed-step simulation, it runs decoupled from the frame rate
+	game.start();
 
 	//Loop until window close event is requested
 	while (!window.closeRequested()) {
 
+		//Recycle the frame memory of the frame before the last one
+		frameArena.nextFrame();
+		SizeClassAllocator::getDefault().nextFrame();
+
 		//Update window and input system
 		window.pollEvents();
 
-		//Update game
+		//Start the game's frame tasks
 		game.update();
 
-		//Render game
+		//Debug FPS, overlapped with the frame tasks
+		char fps[32];
+		auto [fpsEnd, fpsError] = std::to_chars(fps, fps + sizeof(fps), tracker.getFPS(), std::chars_format::fixed, 6);
+
+		FrameString title(frameArena);
+		title.append(Config::getBaseWindowTitle()).append(" | FPS: ").append(fps, fpsError == std::errc() ? fpsEnd : fps);
+		window.setTitle(title.c_str());
+
+		//Render the interpolated simulation state once the frame tasks have finished
 		game.render();
 
 		//Swap render buffers
 		window.swapBuffers();
 
-		//Debug FPS
-		window.setTitle(Config::getBaseWindowTitle() + " | FPS: " + std::to_string(tracker.getFPS()));
-
 	}
 
 }
@@ -86,6 +100,9 @@ void Engine::shutdown() {
 	Log::info("Core", "Shutting down engine");
 	game.destroy();
 
+	//Report where small-object memory went
+	SizeClassAllocator::getDefault().logStatistics();
+
 	//Close instances
 	window.close();
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "util/fpstracker.h"
+#include "core/memory/framearena.h"
 #include "window.h"
 #include "game.h"
 
@@ -24,5 +25,8 @@ private:
 	Game game;
 	FPSTracker tracker;
 	Window window;
+	FrameArena frameArena;
+
+	constexpr static AddressT frameArenaSize = 4096;
 	
 };
\ No newline at end of file
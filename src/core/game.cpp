@@ -12,9 +12,12 @@
 #include "acs/component/model.h"
 #include "acs/component/boxcollider.h"
 #include "input/inputcontext.h"
+#include "util/log.h"
 
+#include <chrono>
 
-Game::Game(Window& window) : window(window), physicsEngine(manager), renderer(manager) {}
+
+Game::Game(Window& window) : window(window), physicsEngine(manager, executor), renderer(stateBuffer, executor), audioEnabled(false), simulating(false), statePublished(false), publishedGroupVersion(0) {}
 
 Game::~Game() {}
 
@@ -23,6 +26,10 @@ bool Game::init() {
 
 	profiler.start();
 
+	//Leave one hardware thread to the main thread
+	executor.setThreadCount(Math::max<u32, u32>(Thread::getHardwareThreadCount(), 2) - 1);
+	executor.start();
+
 	window.disableVSync();
 
 	renderer.init();
@@ -82,23 +89,44 @@ bool Game::init() {
 	manager.registerActor<ExampleActor>(0);
 	manager.registerActor<BoxActor>(1);
 
-	manager.addObserver<BoxCollider>(ComponentEvent::Created, [this](BoxCollider& collider, ActorID id) { physicsEngine.onBoxCreated(collider, id); });
+	manager.observeBatch<BoxCollider>(ComponentEvent::Created, [this](std::span<const ActorID> actors) { physicsEngine.addBodies(actors); });
 	manager.addObserver<BoxCollider>(ComponentEvent::Destroyed, [this](BoxCollider& collider, ActorID id) { physicsEngine.onBoxDestroyed(collider, id); });
 	
-	physicsEngine.init(20);
+	physicsEngine.init(ARC_SIMULATION_TICK_RATE);
+
+	std::vector<Transform> boxTransforms;
+	boxTransforms.reserve(15 * 15 * 15);
 
 	for(u32 i = 0; i < 15; i++) {
 
 		for(u32 j = 0; j < 15; j++) {
 
 			for(u32 k = 0; k < 15; k++) {
-				manager.spawn(1, Transform(Vec3x(i, j, k)));
+				boxTransforms.emplace_back(Vec3x(i, j, k));
 			}
 
 		}
 
 	}
 
+	boxes = manager.spawnBatch(1, boxTransforms.size(), boxTransforms);
+
+	audioEnabled = audioEngine.initialize();
+
+	if (!audioEnabled) {
+		Log::warn("Game", "Audio engine unavailable, continuing without sound");
+	}
+
+	//Frame task graph: Input and audio run in parallel, render preparation waits for input. The simulation runs on its own thread.
+	TaskNode& inputTask = frameGraph.add([this]() { inputSystem.updateContinuous(1); });
+	TaskNode& prepareTask = frameGraph.add([this]() { renderer.prepare(); });
+
+	prepareTask.succeed(inputTask);
+
+	if (audioEnabled) {
+		frameGraph.add([this]() { audioEngine.update(); });
+	}
+
 	profiler.stop("Initialization");
 
 	return true;
@@ -107,10 +135,24 @@ bool Game::init() {
 
 
 
+void Game::start() {
+
+	ticker.start(ARC_SIMULATION_TICK_RATE, ARC_SIMULATION_MAX_CATCHUP);
+	stateBuffer.setTickDuration(ticker.getTickDuration());
+
+	//Give the renderer an initial state to draw until the first tick completes
+	publishState();
+
+	simulating.store(true, std::memory_order_release);
+	simulationThread.start(&Game::simulationMain, this);
+
+}
+
+
+
 void Game::update() {
 
-	inputSystem.updateContinuous(1);
-	physicsEngine.update();
+	frameGraph.dispatch(executor);
 
 }
 
@@ -118,6 +160,7 @@ void Game::update() {
 
 void Game::render() {
 
+	frameGraph.wait();
 	renderer.render();
 
 }
@@ -127,12 +170,112 @@ void Game::render() {
 void Game::destroy() {
 
 	profiler.start();
+
+	//The simulation owns the actors while running, stop it before tearing them down
+	simulating.store(false, std::memory_order_release);
+	simulationThread.finish();
+
+	frameGraph.wait();
 	renderer.destroy();
 
-	for(u32 i = 0; i < 15 * 15 * 15; i++) {
-		manager.destroy(i);
+	if (audioEnabled) {
+		audioEngine.shutdown();
 	}
 
+	manager.destroyBatch(boxes);
+	boxes.clear();
+
 	profiler.stop("Destruction");
 
+}
+
+
+
+void Game::simulationMain() {
+
+	while (simulating.load(std::memory_order_acquire)) {
+
+		u32 ticks = ticker.getTicks();
+
+		for (u32 i = 0; i < ticks; i++) {
+			tick();
+		}
+
+		//Sleep through most of the remaining time, the last bit is yielded away since sleeping is too coarse on most systems
+		u64 remaining = ticker.getTimeUntilTick();
+
+		if (remaining > simulationSleepMargin) {
+			std::this_thread::sleep_for(std::chrono::nanoseconds(remaining - simulationSleepMargin));
+		} else {
+			std::this_thread::yield();
+		}
+
+	}
+
+}
+
+
+
+void Game::tick() {
+
+	physicsEngine.simulate();
+	physicsEngine.sync();
+
+	//Scene queries must not overlap with a step, so they are answered between two
+	physicsEngine.runQueries();
+	publishState();
+
+}
+
+
+
+void Game::publishState() {
+
+	auto& group = manager.group<Transform, BoxCollider>();
+	std::span<const ActorID> changed = physicsEngine.getChangedActors();
+
+	//Added or removed actors require a full snapshot, otherwise only the actors moved by the last sync are sent
+	bool snapshot = !statePublished || group.getVersion() != publishedGroupVersion;
+
+	if (!snapshot && changed.empty()) {
+		return;
+	}
+
+	SimulationState& state = stateBuffer.acquire();
+	state.snapshot = snapshot;
+
+	if (snapshot) {
+
+		state.actors.resize(group.getSize());
+		state.transforms.resize(group.getSize());
+
+		group.parallelEach(executor, stateGrainSize, [&state](SizeT index, ActorID actor, const Transform& transform, const BoxCollider& collider) {
+
+			state.actors[index] = actor;
+			state.transforms[index] = transform;
+
+		});
+
+	} else {
+
+		ComponentProvider& provider = manager.getProvider();
+
+		state.actors.assign(changed.begin(), changed.end());
+		state.transforms.resize(changed.size());
+
+		executor.parallelFor(changed.size(), stateGrainSize, [&state, &provider](SizeT start, SizeT end) {
+
+			for (SizeT i = start; i < end; i++) {
+				state.transforms[i] = provider.getComponent<Transform>(state.actors[i]);
+			}
+
+		});
+
+	}
+
+	statePublished = true;
+	publishedGroupVersion = group.getVersion();
+
+	stateBuffer.publish();
+
 }
\ No newline at end of file
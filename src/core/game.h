@@ -4,8 +4,15 @@
 #include "render/physicsrenderer.h"
 #include "input/inputsystem.h"
 #include "acs/actormanager.h"
+#include "thread/taskexecutor.h"
+#include "thread/taskgraph.h"
+#include "thread/thread.h"
+#include "statebuffer.h"
+#include "audio/audioengine.h"
 #include "util/profiler.h"
+#include "util/ticker.h"
 
+#include <atomic>
 #include <vector>
 #include <memory>
 
@@ -21,19 +28,54 @@ public:
 	~Game();
 
 	bool init();
+
+	//Starts the simulation thread
+	void start();
+
+	//Dispatches the frame's tasks and returns immediately
 	void update();
+
+	//Waits for the frame's tasks and submits the frame
 	void render();
 	void destroy();
 
 private:
 
+	//Simulation thread entry, runs fixed ticks until destruction
+	void simulationMain();
+
+	//Advances the simulation by one tick, answers the submitted scene queries and publishes the resulting state
+	void tick();
+
+	//Publishes the transforms changed by the last tick to the state buffer
+	void publishState();
+
 	Window& window;
 	InputSystem inputSystem;
 	InputHandler inputHandler;
+	TaskExecutor executor;
 	ActorManager manager;
 	PhysicsEngine physicsEngine;
+	StateBuffer stateBuffer;
 	PhysicsRenderer renderer;
+	AudioEngine audioEngine;
+
+	TaskGraph frameGraph;
+	bool audioEnabled;
+
+	Thread simulationThread;
+	Ticker ticker;
+	std::atomic<bool> simulating;
+
+	//Group version of the last published state, a differing version forces a snapshot
+	bool statePublished;
+	u64 publishedGroupVersion;
+
+	std::vector<ActorID> boxes;
 
 	Profiler profiler;
 
+	constexpr static SizeT stateGrainSize = 512;
+	constexpr static u64 simulationSleepMargin = 2000000;
+
 };
\ No newline at end of file
@@ -1,8 +1,11 @@
 #include "chunkallocator.h"
 #include "util/math.h"
 #include "util/log.h"
+#include "util/assert.h"
 #include "arcconfig.h"
 #include <new>
+#include <utility>
+#include <bit>
 
 
 
@@ -13,9 +16,11 @@ ChunkAllocator::~ChunkAllocator() noexcept {
 
 
 ChunkAllocator::ChunkAllocator(ChunkAllocator&& allocator) noexcept :
-	heap(std::exchange(allocator.heap, nullptr)),
-	head(std::exchange(allocator.head, nullptr)),
-	totalSize(allocator.totalSize),
+	available(std::exchange(allocator.available, nullptr)),
+	full(std::exchange(allocator.full, nullptr)),
+	chunkCount(std::exchange(allocator.chunkCount, 0)),
+	chunkSize(allocator.chunkSize),
+	blockOffset(allocator.blockOffset),
 	blockSize(allocator.blockSize),
 	blockAlign(allocator.blockAlign),
 	chunkBlocks(allocator.chunkBlocks) {}
@@ -24,14 +29,24 @@ ChunkAllocator::ChunkAllocator(ChunkAllocator&& allocator) noexcept :
 
 ChunkAllocator& ChunkAllocator::operator=(ChunkAllocator&& allocator) noexcept {
 
-	heap = std::exchange(allocator.heap, nullptr);
-	head = std::exchange(allocator.head, nullptr);
-	totalSize = allocator.totalSize;
-	blockSize = allocator.blockSize;
-	blockAlign = allocator.blockAlign;
-	chunkBlocks = allocator.chunkBlocks;
+	if (this != &allocator) {
+
+		//Release our own heap first, it would leak otherwise
+		clear();
+
+		available = std::exchange(allocator.available, nullptr);
+		full = std::exchange(allocator.full, nullptr);
+		chunkCount = std::exchange(allocator.chunkCount, 0);
+		chunkSize = allocator.chunkSize;
+		blockOffset = allocator.blockOffset;
+		blockSize = allocator.blockSize;
+		blockAlign = allocator.blockAlign;
+		chunkBlocks = allocator.chunkBlocks;
+
+	}
 
 	return *this;
+
 }
 
 
@@ -45,21 +60,16 @@ void ChunkAllocator::create(AddressT blockSize, AlignT blockAlign, AddressT chun
 		AddressT baseSize = Math::max(blockSize, sizeof(Storage));
 		AlignT baseAlign = Math::max(blockAlign, alignof(Storage));
 		AddressT alignedSize = Math::alignUp(baseSize, baseAlign);
-		AddressT chunkSize = chunkBlocks * alignedSize + sizeof(ChunkLink);
+		AddressT offset = Math::alignUp(sizeof(ChunkHeader), baseAlign);
+		AddressT size = std::bit_ceil(offset + chunkBlocks * alignedSize);
 
-		this->totalSize = chunkSize;
+		this->chunkSize = size;
+		this->blockOffset = offset;
 		this->blockSize = alignedSize;
 		this->blockAlign = baseAlign;
-		this->chunkBlocks = chunkBlocks;
-		this->heap = static_cast<Byte*>(::operator new(chunkSize, std::align_val_t(baseAlign)));
+		this->chunkBlocks = (size - offset) / alignedSize;
 
-		generateChunk(heap);
-
-		head = reinterpret_cast<Storage*>(heap);
-
-#ifdef ARC_ALLOCATOR_DEBUG_LOG
-		Log::debug("Chunk Allocator", "Chunk created at %p. Block size: %d, chunk size: %d,", heap, alignedSize, totalSize);
-#endif
+		createChunk();
 
 	}
 
@@ -69,24 +79,16 @@ void ChunkAllocator::create(AddressT blockSize, AlignT blockAlign, AddressT chun
 
 void ChunkAllocator::clear() noexcept {
 
-	Byte* chunk = heap;
-
-	while (chunk) {
-
-		Byte* nextChunk = getChunkLink(chunk)->next;
-		::operator delete(chunk, std::align_val_t(blockAlign));
-
-	#ifdef ARC_ALLOCATOR_DEBUG_LOG
-		Log::debug("Chunk Allocator", "Chunk destroyed at %p.", heap);
-	#endif
-
-		chunk = nextChunk;
+	while (available) {
+		destroyChunk(available);
+	}
 
+	while (full) {
+		destroyChunk(full);
 	}
 
-	heap = nullptr;
-	head = nullptr;
-	totalSize = 0;
+	chunkSize = 0;
+	blockOffset = 0;
 	blockSize = 0;
 	blockAlign = 0;
 	chunkBlocks = 0;
@@ -97,34 +99,26 @@ void ChunkAllocator::clear() noexcept {
 
 [[nodiscard]] void* ChunkAllocator::allocate() {
 
-	if (!head) {
-
-		//If all chunks are full, allocate a new one
-		AddressT chunkSize = blockSize * chunkBlocks + sizeof(ChunkLink);
-		Byte* chunk = static_cast<Byte*>(::operator new(chunkSize, std::align_val_t(blockAlign)));
-
-		//Populate chunk
-		generateChunk(chunk);
-
-		//Insert chunk to the heap's front
-		getChunkLink(chunk)->next = heap;
-		heap = chunk;
-		head = reinterpret_cast<Storage*>(chunk);
-
-#ifdef ARC_ALLOCATOR_DEBUG_LOG
-			Log::debug("Chunk Allocator", "Chunk created at %p. Block size: %d, chunk size: %d,", heap, blockSize, chunkSize);
-#endif
-
+	if (!chunkSize) {
+		throw std::bad_alloc();
 	}
 
+	//If all chunks are full, allocate a new one
+	ChunkHeader* chunk = available ? available : createChunk();
+
 	//Acquire the head pointer and prepare to return it
-	void* allocPtr = head;
+	Storage* allocPtr = chunk->head;
 
 	//Next head is the next block of the previous head
-	head = head->next;
+	chunk->head = allocPtr->next;
+
+	if (!--chunk->freeBlocks) {
+		unlink(available, chunk);
+		link(full, chunk);
+	}
 
 #ifdef ARC_ALLOCATOR_DEBUG_LOG
-	Log::debug("Chunk Allocator", "Chunk %p allocated memory at %p.", heap, allocPtr);
+	Log::debug("Chunk Allocator", "Chunk %p allocated memory at %p.", chunk, allocPtr);
 #endif
 
 	return allocPtr;
@@ -137,25 +131,68 @@ void ChunkAllocator::deallocate(void* ptr) noexcept {
 
 	if (ptr) {
 
-		//Simply relink it to head
-		Storage* storagePtr = ::new(ptr) Storage(head);
-		head = storagePtr;
+		ChunkHeader* chunk = getChunk(ptr);
+
+#ifdef ARC_ALLOCATOR_DEBUG_CHECKS
+		AddressT offset = Math::address(ptr) - Math::address(chunk);
+		arc_assert(offset >= blockOffset && !((offset - blockOffset) % blockSize) && chunk->freeBlocks < chunkBlocks, "Pointer %p has not been allocated by this allocator", ptr);
+#endif
+
+		//Simply relink it to the chunk's head
+		chunk->head = ::new(ptr) Storage(chunk->head);
+
+		if (!chunk->freeBlocks++) {
+			unlink(full, chunk);
+			link(available, chunk);
+		}
 
 #ifdef ARC_ALLOCATOR_DEBUG_LOG
-		Log::debug("Pool Allocator", "Pool %p deallocated memory at %p.", heap, ptr);
+		Log::debug("Chunk Allocator", "Chunk %p deallocated memory at %p.", chunk, ptr);
 #endif
 
+		//Reclaim entirely free chunks, but keep one around to avoid thrashing at chunk boundaries
+		if (chunk->freeBlocks == chunkBlocks && (chunk->prev || chunk->next)) {
+			destroyChunk(chunk);
+		}
+
 	}
 
 }
 
 
 
-void ChunkAllocator::generateChunk(Byte* chunkPtr) {
+AddressT ChunkAllocator::getChunkCount() const noexcept {
+	return chunkCount;
+}
+
+
+
+AddressT ChunkAllocator::getChunkSize() const noexcept {
+	return chunkSize;
+}
+
+
+
+AddressT ChunkAllocator::getBlockSize() const noexcept {
+	return blockSize;
+}
+
+
+
+AddressT ChunkAllocator::getChunkBlocks() const noexcept {
+	return chunkBlocks;
+}
+
+
+
+ChunkAllocator::ChunkHeader* ChunkAllocator::createChunk() {
+
+	Byte* chunkPtr = static_cast<Byte*>(::operator new(chunkSize, std::align_val_t(chunkSize)));
+	Byte* blocks = chunkPtr + blockOffset;
 
 	for (AddressT i = 0; i < chunkBlocks; i++) {
 
-		Byte* ptr = chunkPtr + i * blockSize;
+		Byte* ptr = blocks + i * blockSize;
 		Byte* next = ptr + blockSize;
 
 		if (i == (chunkBlocks - 1)) {
@@ -166,12 +203,66 @@ void ChunkAllocator::generateChunk(Byte* chunkPtr) {
 
 	}
 
-	::new(getChunkLink(chunkPtr)) ChunkLink(nullptr);
+	ChunkHeader* chunk = ::new(chunkPtr) ChunkHeader{ nullptr, nullptr, reinterpret_cast<Storage*>(blocks), chunkBlocks };
+	link(available, chunk);
+	chunkCount++;
+
+#ifdef ARC_ALLOCATOR_DEBUG_LOG
+	Log::debug("Chunk Allocator", "Chunk created at %p. Block size: %d, chunk size: %d,", chunkPtr, blockSize, chunkSize);
+#endif
+
+	return chunk;
+
+}
+
+
+
+void ChunkAllocator::destroyChunk(ChunkHeader* chunk) noexcept {
+
+	unlink(chunk->freeBlocks ? available : full, chunk);
+	chunkCount--;
+
+	::operator delete(chunk, std::align_val_t(chunkSize));
+
+#ifdef ARC_ALLOCATOR_DEBUG_LOG
+	Log::debug("Chunk Allocator", "Chunk destroyed at %p.", chunk);
+#endif
+
+}
+
+
+
+ChunkAllocator::ChunkHeader* ChunkAllocator::getChunk(void* ptr) const noexcept {
+	return reinterpret_cast<ChunkHeader*>(Math::alignDown(Math::address(ptr), chunkSize));
+}
+
+
+
+void ChunkAllocator::link(ChunkHeader*& list, ChunkHeader* chunk) noexcept {
+
+	chunk->prev = nullptr;
+	chunk->next = list;
+
+	if (list) {
+		list->prev = chunk;
+	}
+
+	list = chunk;
 
 }
 
 
 
-ChunkAllocator::ChunkLink* ChunkAllocator::getChunkLink(Byte* chunkPtr) const noexcept {
-	return reinterpret_cast<ChunkLink*>(chunkPtr + blockSize * chunkBlocks);
+void ChunkAllocator::unlink(ChunkHeader*& list, ChunkHeader* chunk) noexcept {
+
+	if (chunk->prev) {
+		chunk->prev->next = chunk->next;
+	} else {
+		list = chunk->next;
+	}
+
+	if (chunk->next) {
+		chunk->next->prev = chunk->prev;
+	}
+
 }
\ No newline at end of file
@@ -7,14 +7,22 @@
 	ChunkAllocator
 
 	Manages a resizeable heap divided into fixed-size blocks.
-	Allows allocation/deallocation in O(1).TODO
+	Allows allocation/deallocation in O(1).
+
+	The heap consists of chunks aligned to their own power-of-two size, so the owning chunk of a block is found by masking its address.
+	Each chunk starts with a header holding its own free list and is linked into either the list of chunks with free blocks or the list of full chunks.
+	Chunks becoming entirely free are returned to the system unless they are the last chunk with free blocks.
+
+	+--------+-------+-------+-----+-------+
+	| Header | Block | Block | ... | Block |		<- chunkSize aligned
+	+--------+-------+-------+-----+-------+
 */
 class ChunkAllocator {
 
 public:
 
 	//Creates a new ChunkAllocator instance. No memory is allocated upon construction.
-	constexpr ChunkAllocator() noexcept : heap(nullptr), head(nullptr), totalSize(0), blockSize(0), blockAlign(0), chunkBlocks(0) {}
+	constexpr ChunkAllocator() noexcept : available(nullptr), full(nullptr), chunkCount(0), chunkSize(0), blockOffset(0), blockSize(0), blockAlign(0), chunkBlocks(0) {}
 
 	//Memory is freed automatically. However, the user must ensure every destructor is called before destroying the allocator itself.
 	~ChunkAllocator() noexcept;
@@ -32,7 +40,7 @@ public:
 
 		blockSize:		Specifies the size of the block.
 		blockAlign:		Specifies the alignment of the block.
-		chunkBlocks:	Number of blocks per chunk
+		chunkBlocks:	Minimum number of blocks per chunk. Chunks are rounded up to a power of two and filled with as many blocks as fit.
 
 		The actual block size/alignment has a minimum as specified by Storage.
 	*/
@@ -54,7 +62,7 @@ public:
 
 
 	/*
-		Acquires a block of allocated memory. Throws std::bad_alloc if no memory has been allocated or there is no free block left.
+		Acquires a block of allocated memory. Throws std::bad_alloc if no memory has been allocated or a new chunk could not be allocated.
 		returns:	A pointer to the allocated block.
 	*/
 	[[nodiscard]] void* allocate();
@@ -67,6 +75,18 @@ public:
 	void deallocate(void* ptr) noexcept;
 
 
+	//Returns the number of chunks currently allocated
+	AddressT getChunkCount() const noexcept;
+
+	//Returns the size of a chunk in bytes
+	AddressT getChunkSize() const noexcept;
+
+	//Returns the size of a block including padding
+	AddressT getBlockSize() const noexcept;
+
+	//Returns the number of blocks per chunk
+	AddressT getChunkBlocks() const noexcept;
+
 private:
 
 	//Stores a pointer to the next free block.
@@ -77,33 +97,39 @@ private:
 
 	};
 
-	//Chunk link to the next chunk.
-	struct ChunkLink {
+	//Chunk header preceding the blocks
+	struct ChunkHeader {
 
-		constexpr ChunkLink(Byte* next) noexcept : next(next) {}
-		Byte* next;
+		ChunkHeader* prev;
+		ChunkHeader* next;
+		Storage* head;
+		AddressT freeBlocks;
 
 	};
 
 
 	/*
-		Initializes the chunk given by the pointer.
-		chunkPtr:	Pointer to the chunk's start. Result is undefined if it's null.
+		Allocates and initializes a new chunk and links it into the available list.
+		May throw std::bad_alloc.
 	*/
-	void generateChunk(Byte* chunkPtr);
+	ChunkHeader* createChunk();
 
+	//Returns a chunk to the system
+	void destroyChunk(ChunkHeader* chunk) noexcept;
 
-	/*
-		Returns a pointer to the chunk's link.
-		chunkPtr:	Pointer to the chunk's link. Result is undefined if it's null.
-	*/
-	ChunkLink* getChunkLink(Byte* chunkPtr) const noexcept;
+	//Returns the chunk containing ptr
+	ChunkHeader* getChunk(void* ptr) const noexcept;
+
+	static void link(ChunkHeader*& list, ChunkHeader* chunk) noexcept;
+	static void unlink(ChunkHeader*& list, ChunkHeader* chunk) noexcept;
 
 
-	Byte* heap;
-	Storage* head;
-	AddressT totalSize;
+	ChunkHeader* available;
+	ChunkHeader* full;
+	AddressT chunkCount;
 
+	AddressT chunkSize;
+	AddressT blockOffset;
 	AddressT blockSize;
 	AlignT blockAlign;
 	AddressT chunkBlocks;
@@ -0,0 +1,384 @@
+#include "concurrentchunkallocator.h"
+#include "util/math.h"
+
+#include <new>
+#include <vector>
+#include <utility>
+
+
+
+namespace {
+
+	constexpr u32 unassignedIndex = -1;
+
+	//Hands out dense thread indices and recycles those of exited threads
+	class ThreadIndexRegistry {
+
+	public:
+
+		u32 acquire() {
+
+			std::lock_guard lock(mutex);
+
+			if (!freeIndices.empty()) {
+
+				u32 index = freeIndices.back();
+				freeIndices.pop_back();
+
+				return index;
+
+			}
+
+			return nextIndex++;
+
+		}
+
+		void release(u32 index) {
+
+			std::lock_guard lock(mutex);
+			freeIndices.push_back(index);
+
+		}
+
+	private:
+
+		std::mutex mutex;
+		std::vector<u32> freeIndices;
+		u32 nextIndex = 0;
+
+	};
+
+
+	ThreadIndexRegistry& getRegistry() {
+
+		static ThreadIndexRegistry registry;
+		return registry;
+
+	}
+
+
+	//Trivially constructed so that the hot path needs no initialization guard
+	thread_local u32 threadIndex = unassignedIndex;
+
+	struct ThreadIndexReleaser {
+
+		~ThreadIndexReleaser() {
+			getRegistry().release(std::exchange(threadIndex, unassignedIndex));
+		}
+
+	};
+
+
+	u32 assignThreadIndex() {
+
+		thread_local ThreadIndexReleaser releaser;
+
+		threadIndex = getRegistry().acquire();
+		return threadIndex;
+
+	}
+
+}
+
+
+
+ConcurrentChunkAllocator::ConcurrentChunkAllocator() noexcept : magazineCapacity(0) {}
+
+
+
+ConcurrentChunkAllocator::~ConcurrentChunkAllocator() noexcept {
+	clear();
+}
+
+
+
+void ConcurrentChunkAllocator::create(AddressT blockSize, AlignT blockAlign, AddressT chunkBlocks) {
+
+	clear();
+
+	chunks.create(blockSize, blockAlign, chunkBlocks);
+	caches = std::make_unique<ThreadCache[]>(MaxThreads);
+
+	//Large blocks are cached in smaller numbers so that idle threads do not hoard memory
+	magazineCapacity = Math::clamp(MagazineBytes / chunks.getBlockSize(), AddressT(2), MagazineSize);
+
+}
+
+
+
+void ConcurrentChunkAllocator::clear() noexcept {
+
+	//Cached blocks are released together with their chunks, only the magazines themselves need to be deleted
+	if (caches) {
+
+		for (u32 i = 0; i < MaxThreads; i++) {
+
+			delete caches[i].loaded;
+			delete caches[i].previous;
+
+		}
+
+		caches.reset();
+
+	}
+
+	Magazine* magazine;
+
+	while (fullMagazines.pop(magazine)) {
+		delete magazine;
+	}
+
+	while (emptyMagazines.pop(magazine)) {
+		delete magazine;
+	}
+
+	chunks.clear();
+
+}
+
+
+
+[[nodiscard]] void* ConcurrentChunkAllocator::allocate() {
+
+	ThreadCache* cache = getThreadCache();
+
+	if (cache) {
+
+		Magazine* magazine = cache->loaded;
+
+		if (magazine && magazine->count) {
+			return magazine->blocks[--magazine->count];
+		}
+
+		return allocateSlow(*cache);
+
+	}
+
+	std::lock_guard lock(mutex);
+	return chunks.allocate();
+
+}
+
+
+
+void ConcurrentChunkAllocator::deallocate(void* ptr) noexcept {
+
+	if (!ptr) {
+		return;
+	}
+
+	ThreadCache* cache = getThreadCache();
+
+	if (cache) {
+
+		Magazine* magazine = cache->loaded;
+
+		if (magazine && magazine->count < magazineCapacity) {
+			magazine->blocks[magazine->count++] = ptr;
+			return;
+		}
+
+		deallocateSlow(*cache, ptr);
+		return;
+
+	}
+
+	std::lock_guard lock(mutex);
+	chunks.deallocate(ptr);
+
+}
+
+
+
+void ConcurrentChunkAllocator::trim() noexcept {
+
+	Magazine* magazine;
+
+	while (fullMagazines.pop(magazine)) {
+
+		drain(*magazine);
+		delete magazine;
+
+	}
+
+	while (emptyMagazines.pop(magazine)) {
+		delete magazine;
+	}
+
+}
+
+
+
+AddressT ConcurrentChunkAllocator::getReservedSize() const noexcept {
+
+	std::lock_guard lock(mutex);
+	return chunks.getChunkCount() * chunks.getChunkSize();
+
+}
+
+
+
+ConcurrentChunkAllocator::ThreadCache* ConcurrentChunkAllocator::getThreadCache() noexcept {
+
+	u32 index = threadIndex;
+
+	if (index == unassignedIndex) {
+
+		try {
+			index = assignThreadIndex();
+		} catch (...) {
+			return nullptr;
+		}
+
+	}
+
+	return caches && index < MaxThreads ? &caches[index] : nullptr;
+
+}
+
+
+
+void* ConcurrentChunkAllocator::allocateSlow(ThreadCache& cache) {
+
+	//Swap in the second magazine if it still holds blocks
+	if (cache.previous && cache.previous->count) {
+
+		std::swap(cache.loaded, cache.previous);
+		return cache.loaded->blocks[--cache.loaded->count];
+
+	}
+
+	//Both magazines are empty, exchange one for a full magazine from the depot
+	Magazine* full;
+
+	if (fullMagazines.pop(full)) {
+
+		releaseEmpty(cache.previous);
+		cache.previous = cache.loaded;
+		cache.loaded = full;
+
+		return full->blocks[--full->count];
+
+	}
+
+	//The depot ran dry, fetch fresh blocks from the chunks
+	if (!cache.loaded) {
+
+		cache.loaded = acquireEmpty();
+
+		if (!cache.loaded) {
+			throw std::bad_alloc();
+		}
+
+	}
+
+	refill(*cache.loaded);
+
+	return cache.loaded->blocks[--cache.loaded->count];
+
+}
+
+
+
+void ConcurrentChunkAllocator::deallocateSlow(ThreadCache& cache, void* ptr) noexcept {
+
+	//Swap in the second magazine if it has room left
+	if (cache.previous && cache.previous->count < magazineCapacity) {
+
+		std::swap(cache.loaded, cache.previous);
+		cache.loaded->blocks[cache.loaded->count++] = ptr;
+
+		return;
+
+	}
+
+	Magazine* empty = acquireEmpty();
+
+	if (!empty) {
+
+		std::lock_guard lock(mutex);
+		chunks.deallocate(ptr);
+
+		return;
+
+	}
+
+	//Both magazines are full, hand one over to the depot
+	releaseFull(cache.previous);
+	cache.previous = cache.loaded;
+	cache.loaded = empty;
+
+	empty->blocks[empty->count++] = ptr;
+
+}
+
+
+
+void ConcurrentChunkAllocator::refill(Magazine& magazine) {
+
+	std::lock_guard lock(mutex);
+
+	//The first block must succeed, afterwards we settle for what we get
+	void* block = chunks.allocate();
+	magazine.blocks[magazine.count++] = block;
+
+	try {
+
+		while (magazine.count < magazineCapacity) {
+			magazine.blocks[magazine.count] = chunks.allocate();
+			magazine.count++;
+		}
+
+	} catch (...) {}
+
+}
+
+
+
+void ConcurrentChunkAllocator::drain(Magazine& magazine) noexcept {
+
+	std::lock_guard lock(mutex);
+
+	while (magazine.count) {
+		chunks.deallocate(magazine.blocks[--magazine.count]);
+	}
+
+}
+
+
+
+ConcurrentChunkAllocator::Magazine* ConcurrentChunkAllocator::acquireEmpty() noexcept {
+
+	Magazine* magazine;
+
+	if (emptyMagazines.pop(magazine)) {
+		return magazine;
+	}
+
+	return new (std::nothrow) Magazine;
+
+}
+
+
+
+void ConcurrentChunkAllocator::releaseFull(Magazine* magazine) noexcept {
+
+	if (!magazine || fullMagazines.push(std::move(magazine))) {
+		return;
+	}
+
+	//The depot is saturated, give the blocks back so that chunks can be reclaimed
+	drain(*magazine);
+	releaseEmpty(magazine);
+
+}
+
+
+
+void ConcurrentChunkAllocator::releaseEmpty(Magazine* magazine) noexcept {
+
+	if (magazine && !emptyMagazines.push(std::move(magazine))) {
+		delete magazine;
+	}
+
+}
\ No newline at end of file
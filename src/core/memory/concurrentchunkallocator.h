@@ -0,0 +1,136 @@
+#pragma once
+
+#include "chunkallocator.h"
+#include "core/thread/concurrentqueue.h"
+#include "arcconfig.h"
+#include "types.h"
+
+#include <mutex>
+#include <memory>
+
+
+/*
+	ConcurrentChunkAllocator
+
+	Thread-safe front-end to ChunkAllocator.
+	Every thread owns a cache of two magazines, i.e. small stacks of free blocks. Allocation and deallocation pop from/push to the loaded magazine without synchronization.
+	If the loaded magazine runs empty or full, it is swapped with the second one. Only if neither fits, the thread exchanges magazines with the depot,
+	a pair of lock-free queues holding full and empty magazines.
+
+	The underlying chunk allocator is accessed under a lock when the depot has no full magazine left or when it overflows.
+	Overflowing magazines are returned block by block to their chunks, which allows chunks that become entirely free to be reclaimed.
+
+	Caches are addressed by a process-wide thread index. Indices are recycled when threads exit and the next thread receiving an index inherits its caches.
+*/
+class ConcurrentChunkAllocator {
+
+public:
+
+	//Creates a new ConcurrentChunkAllocator instance. No memory is allocated upon construction.
+	ConcurrentChunkAllocator() noexcept;
+
+	//Memory is freed automatically. The user must ensure every destructor is called and no other thread accesses the allocator anymore.
+	~ConcurrentChunkAllocator() noexcept;
+
+	//Threads address the allocator's caches directly, hence it can neither be copied nor moved
+	ConcurrentChunkAllocator(const ConcurrentChunkAllocator& allocator) = delete;
+	ConcurrentChunkAllocator& operator=(const ConcurrentChunkAllocator& allocator) = delete;
+
+
+	/*
+		Creates a new heap. The previously created heap will be destroyed. Not thread-safe.
+		May throw std::bad_alloc if initial allocation failed.
+		See ChunkAllocator::create(blockSize, blockAlign, chunkBlocks) for more information.
+	*/
+	void create(AddressT blockSize, AlignT blockAlign, AddressT chunkBlocks);
+
+
+	/*
+		Creates a new heap whereas block size/alignment is deduced by T.
+		See create(blockSize, blockAlign, chunkBlocks) for more information.
+	*/
+	template<class T>
+	void create(AddressT chunkBlocks) {
+		create(sizeof(T), alignof(T), chunkBlocks);
+	}
+
+
+	//Deallocates the heap including all cached blocks. Not thread-safe.
+	void clear() noexcept;
+
+
+	/*
+		Acquires a block of allocated memory. Thread-safe.
+		Throws std::bad_alloc if no memory has been allocated or a new chunk could not be allocated.
+		returns:	A pointer to the allocated block.
+	*/
+	[[nodiscard]] void* allocate();
+
+
+	/*
+		Deallocates a pointer. Thread-safe. The block may have been allocated by a different thread.
+		ptr:		The pointer to be deallocated. nullptr has no effect.
+	*/
+	void deallocate(void* ptr) noexcept;
+
+
+	//Returns the magazines held by the depot to their chunks, releasing chunks that become entirely free. Thread-safe.
+	void trim() noexcept;
+
+
+	//Returns the number of bytes currently reserved by chunks. Thread-safe.
+	AddressT getReservedSize() const noexcept;
+
+private:
+
+	constexpr static AddressT MagazineSize = ARC_ALLOCATOR_MAGAZINE_SIZE;
+	constexpr static AddressT MagazineBytes = ARC_ALLOCATOR_MAGAZINE_BYTES;
+	constexpr static u32 DepotSize = ARC_ALLOCATOR_DEPOT_SIZE;
+	constexpr static u32 MaxThreads = ARC_ALLOCATOR_MAX_THREADS;
+
+	struct Magazine {
+
+		AddressT count = 0;
+		void* blocks[MagazineSize];
+
+	};
+
+	struct alignas(64) ThreadCache {
+
+		Magazine* loaded = nullptr;
+		Magazine* previous = nullptr;
+
+	};
+
+	typedef ConcurrentQueue<Magazine*, DepotSize> Depot;
+
+
+	//Returns the calling thread's cache or nullptr if the thread has none
+	ThreadCache* getThreadCache() noexcept;
+
+	void* allocateSlow(ThreadCache& cache);
+	void deallocateSlow(ThreadCache& cache, void* ptr) noexcept;
+
+	//Fills the magazine with blocks from the chunks
+	void refill(Magazine& magazine);
+
+	//Returns all blocks of the magazine to their chunks
+	void drain(Magazine& magazine) noexcept;
+
+	//Takes an empty magazine from the depot or creates a new one. Returns nullptr if allocation failed.
+	Magazine* acquireEmpty() noexcept;
+
+	//Hands a magazine over to the depot, draining or deleting it if the depot is full
+	void releaseFull(Magazine* magazine) noexcept;
+	void releaseEmpty(Magazine* magazine) noexcept;
+
+
+	std::unique_ptr<ThreadCache[]> caches;
+	AddressT magazineCapacity;
+	Depot fullMagazines;
+	Depot emptyMagazines;
+
+	mutable std::mutex mutex;
+	ChunkAllocator chunks;
+
+};
\ No newline at end of file
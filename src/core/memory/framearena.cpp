@@ -0,0 +1,253 @@
+#include "framearena.h"
+#include "util/math.h"
+#include "util/log.h"
+#include "util/assert.h"
+#include "arcconfig.h"
+#include <new>
+#include <utility>
+
+
+
+FrameArena::~FrameArena() noexcept {
+	clear();
+}
+
+
+
+FrameArena::FrameArena(FrameArena&& arena) noexcept :
+	buffers{ std::exchange(arena.buffers[0], {}), std::exchange(arena.buffers[1], {}) },
+	active(arena.active) {}
+
+
+
+FrameArena& FrameArena::operator=(FrameArena&& arena) noexcept {
+
+	if (this != &arena) {
+
+		clear();
+
+		buffers[0] = std::exchange(arena.buffers[0], {});
+		buffers[1] = std::exchange(arena.buffers[1], {});
+		active = arena.active;
+
+	}
+
+	return *this;
+
+}
+
+
+
+void FrameArena::create(AddressT bufferSize) {
+
+	clear();
+
+	if (bufferSize) {
+
+		for (Buffer& buffer : buffers) {
+
+			Block* block = createBlock(bufferSize);
+			buffer = { block, block, 0 };
+
+		}
+
+	}
+
+}
+
+
+
+void FrameArena::clear() noexcept {
+
+	for (Buffer& buffer : buffers) {
+		destroyBlocks(buffer);
+	}
+
+	active = 0;
+
+}
+
+
+
+[[nodiscard]] void* FrameArena::allocate(AddressT size, AlignT align) {
+
+	Buffer& buffer = buffers[active];
+
+	if (buffer.current) {
+
+		AddressT base = Math::address(getData(buffer.current));
+		AddressT start = Math::alignUp(base + buffer.offset, align) - base;
+
+		if (start + size <= buffer.current->size) {
+			buffer.offset = start + size;
+			return getData(buffer.current) + start;
+		}
+
+	}
+
+	return allocateSlow(size, align);
+
+}
+
+
+
+FrameArena::Marker FrameArena::getMarker() const noexcept {
+
+	const Buffer& buffer = buffers[active];
+	return { buffer.current, buffer.offset };
+
+}
+
+
+
+void FrameArena::rewind(const Marker& marker) noexcept {
+
+	//Blocks following the marker's block stay chained and are reused by subsequent allocations
+	Buffer& buffer = buffers[active];
+
+	//A marker taken before the first block existed rewinds to the start of the chain, which may have been created since
+	if (!marker.block) {
+
+		buffer.current = buffer.head;
+		buffer.offset = 0;
+		return;
+
+	}
+
+	buffer.current = marker.block;
+	buffer.offset = marker.offset;
+
+}
+
+
+
+void FrameArena::nextFrame() {
+
+	active ^= 1;
+
+	Buffer& buffer = buffers[active];
+
+	//Merge an overflown buffer into a single block large enough for the whole frame
+	if (buffer.head && buffer.head->next) {
+
+		AddressT capacity = getCapacity();
+		destroyBlocks(buffer);
+
+		Block* block = createBlock(capacity);
+		buffer.head = block;
+
+#ifdef ARC_ALLOCATOR_DEBUG_LOG
+		Log::debug("Frame Arena", "Arena %p grown to %d bytes.", this, capacity);
+#endif
+
+	}
+
+	buffer.current = buffer.head;
+	buffer.offset = 0;
+
+}
+
+
+
+AddressT FrameArena::getUsedSize() const noexcept {
+
+	const Buffer& buffer = buffers[active];
+	AddressT used = buffer.offset;
+
+	for (Block* block = buffer.head; block && block != buffer.current; block = block->next) {
+		used += block->size;
+	}
+
+	return used;
+
+}
+
+
+
+AddressT FrameArena::getCapacity() const noexcept {
+
+	AddressT capacity = 0;
+
+	for (Block* block = buffers[active].head; block; block = block->next) {
+		capacity += block->size;
+	}
+
+	return capacity;
+
+}
+
+
+
+void* FrameArena::allocateSlow(AddressT size, AlignT align) {
+
+	Buffer& buffer = buffers[active];
+
+	//Try the blocks following the current one first, they might be left over from a rewind
+	while (buffer.current && buffer.current->next) {
+
+		buffer.current = buffer.current->next;
+		buffer.offset = 0;
+
+		AddressT base = Math::address(getData(buffer.current));
+		AddressT start = Math::alignUp(base, align) - base;
+
+		if (start + size <= buffer.current->size) {
+			buffer.offset = start + size;
+			return getData(buffer.current) + start;
+		}
+
+	}
+
+	//Append a new block, at least doubling the capacity
+	Block* block = createBlock(Math::max<AddressT, AddressT>(size + align, getCapacity()));
+
+	//A null current block implies an empty chain, everything else has been walked to the tail above
+	if (buffer.current) {
+		buffer.current->next = block;
+	} else {
+		arc_assert(!buffer.head, "Frame arena block chain lost");
+		buffer.head = block;
+	}
+
+	buffer.current = block;
+
+	AddressT base = Math::address(getData(block));
+	AddressT start = Math::alignUp(base, align) - base;
+	buffer.offset = start + size;
+
+	return getData(block) + start;
+
+}
+
+
+
+FrameArena::Block* FrameArena::createBlock(AddressT size) {
+
+	Byte* ptr = static_cast<Byte*>(::operator new(blockHeaderSize + size, std::align_val_t(blockAlign)));
+	return ::new(ptr) Block{ nullptr, size };
+
+}
+
+
+
+void FrameArena::destroyBlocks(Buffer& buffer) noexcept {
+
+	Block* block = buffer.head;
+
+	while (block) {
+
+		Block* next = block->next;
+		::operator delete(block, std::align_val_t(blockAlign));
+		block = next;
+
+	}
+
+	buffer = {};
+
+}
+
+
+
+Byte* FrameArena::getData(Block* block) noexcept {
+	return reinterpret_cast<Byte*>(block) + blockHeaderSize;
+}
\ No newline at end of file
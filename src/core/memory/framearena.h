@@ -0,0 +1,160 @@
+#pragma once
+
+#include "types.h"
+
+#include <string>
+#include <cstddef>
+#include <vector>
+
+
+/*
+	FrameArena
+
+	Linear allocator for per-frame scratch memory.
+	Allocation bumps an offset and memory is never freed individually. Instead, the arena is rewound to a previously taken marker or reset as a whole.
+
+	The arena is double-buffered: nextFrame() switches to the other buffer and resets it, so everything allocated during the previous frame remains valid
+	while the next frame is being filled. A buffer overflowing its block is extended by additional blocks, which are merged into a single larger block
+	upon its next reset. After a few frames, the arena therefore allocates from a single block without touching the heap.
+
+	Not thread-safe. Memory handed out is not constructed and destructors are never called.
+*/
+class FrameArena {
+
+	struct Block {
+
+		Block* next;
+		AddressT size;
+
+	};
+
+public:
+
+	//Position within the current frame's buffer
+	struct Marker {
+
+		Block* block;
+		AddressT offset;
+
+	};
+
+	//Creates a new FrameArena instance. No memory is allocated upon construction.
+	constexpr FrameArena() noexcept : buffers{}, active(0) {}
+
+	~FrameArena() noexcept;
+
+	//Move allowed, copy disabled.
+	FrameArena(const FrameArena& arena) = delete;
+	FrameArena& operator=(const FrameArena& arena) = delete;
+	FrameArena(FrameArena&& arena) noexcept;
+	FrameArena& operator=(FrameArena&& arena) noexcept;
+
+
+	/*
+		Creates both buffers with bufferSize bytes each. The previously created buffers will be destroyed.
+		May throw std::bad_alloc if allocation failed.
+	*/
+	void create(AddressT bufferSize);
+
+
+	//Deallocates both buffers. All memory handed out becomes invalid.
+	void clear() noexcept;
+
+
+	/*
+		Allocates size bytes aligned to align from the current frame's buffer. The buffer grows if necessary.
+		May throw std::bad_alloc.
+	*/
+	[[nodiscard]] void* allocate(AddressT size, AlignT align = alignof(std::max_align_t));
+
+
+	//Allocates uninitialized storage for count objects of type T
+	template<class T>
+	[[nodiscard]] T* allocate(AddressT count) {
+		return static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+	}
+
+
+	//Returns a marker to the current position
+	Marker getMarker() const noexcept;
+
+	//Releases everything allocated after marker was taken. The marker must stem from the current frame.
+	void rewind(const Marker& marker) noexcept;
+
+	//Switches to the other buffer and resets it. Memory of the previous frame stays valid until the next call.
+	void nextFrame();
+
+
+	//Returns the number of bytes allocated in the current frame, including alignment padding
+	AddressT getUsedSize() const noexcept;
+
+	//Returns the total capacity of the current frame's buffer
+	AddressT getCapacity() const noexcept;
+
+private:
+
+	struct Buffer {
+
+		Block* head;
+		Block* current;
+		AddressT offset;
+
+	};
+
+	constexpr static AlignT blockAlign = 64;
+	constexpr static AddressT blockHeaderSize = (sizeof(Block) + blockAlign - 1) & ~(blockAlign - 1);
+
+	void* allocateSlow(AddressT size, AlignT align);
+
+	static Block* createBlock(AddressT size);
+	static void destroyBlocks(Buffer& buffer) noexcept;
+	static Byte* getData(Block* block) noexcept;
+
+	Buffer buffers[2];
+	u32 active;
+
+};
+
+
+
+/*
+	STL-compatible allocator adapter for FrameArena.
+	Deallocation is a no-op, memory is reclaimed once the arena buffer is reset.
+*/
+template<class T>
+class FrameAllocator {
+
+public:
+
+	using value_type = T;
+
+	FrameAllocator(FrameArena& arena) noexcept : arena(&arena) {}
+
+	template<class U>
+	FrameAllocator(const FrameAllocator<U>& allocator) noexcept : arena(allocator.arena) {}
+
+	[[nodiscard]] T* allocate(SizeT n) {
+		return arena->allocate<T>(n);
+	}
+
+	void deallocate(T* ptr, SizeT n) noexcept {}
+
+	template<class U>
+	bool operator==(const FrameAllocator<U>& allocator) const noexcept {
+		return arena == allocator.arena;
+	}
+
+private:
+
+	template<class U>
+	friend class FrameAllocator;
+
+	FrameArena* arena;
+
+};
+
+
+typedef std::basic_string<char, std::char_traits<char>, FrameAllocator<char>> FrameString;
+
+template<class T>
+using FrameVector = std::vector<T, FrameAllocator<T>>;
\ No newline at end of file
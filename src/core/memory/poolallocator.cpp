@@ -3,6 +3,7 @@
 #include "util/log.h"
 #include "arcconfig.h"
 #include <new>
+#include <utility>
 
 
 PoolAllocator::~PoolAllocator() noexcept {
@@ -22,11 +23,18 @@ PoolAllocator::PoolAllocator(PoolAllocator&& allocator) noexcept :
 
 PoolAllocator& PoolAllocator::operator=(PoolAllocator&& allocator) noexcept {
 
-	heap = std::exchange(allocator.heap, nullptr);
-	head = std::exchange(allocator.head, nullptr);
-	totalSize = allocator.totalSize;
-	blockSize = allocator.blockSize;
-	blockAlign = allocator.blockAlign;
+	if (this != &allocator) {
+
+		//Release our own heap first, it would leak otherwise
+		clear();
+
+		heap = std::exchange(allocator.heap, nullptr);
+		head = std::exchange(allocator.head, nullptr);
+		totalSize = allocator.totalSize;
+		blockSize = allocator.blockSize;
+		blockAlign = allocator.blockAlign;
+
+	}
 
 	return *this;
 
@@ -0,0 +1,237 @@
+#include "sizeclassallocator.h"
+#include "util/math.h"
+#include "util/log.h"
+#include "util/assert.h"
+
+#include <new>
+#include <bit>
+
+
+
+namespace {
+
+	constexpr SizeT minChunkSize = 16384;
+	constexpr SizeT minChunkBlocks = 16;
+	constexpr SizeT chunkHeaderSize = 64;
+
+}
+
+
+
+double SizeClassAllocator::ClassStatistics::getInternalFragmentation() const noexcept {
+
+	SizeT usedBytes = liveBlocks * blockSize;
+	return usedBytes ? 1.0 - static_cast<double>(requestedBytes) / usedBytes : 0.0;
+
+}
+
+
+
+double SizeClassAllocator::ClassStatistics::getExternalFragmentation() const noexcept {
+	return reservedBytes ? 1.0 - static_cast<double>(liveBlocks * blockSize) / reservedBytes : 0.0;
+}
+
+
+
+SizeClassAllocator::SizeClassAllocator()
+#ifdef ARC_ALLOCATOR_STATISTICS
+	: liveBytes(0), peakBytes(0), allocations(0), largeAllocations(0), frameAllocations(0), lastFrameAllocations(0)
+#endif
+{
+
+	for (u32 i = 0; i < ClassCount; i++) {
+
+		//Leave room for the chunk header so that chunks stay at a power of two instead of doubling
+		SizeT blockSize = ClassSizes[i];
+		SizeT chunkSize = std::bit_ceil(Math::max<SizeT, SizeT>(minChunkSize, blockSize * minChunkBlocks));
+		SizeT chunkBlocks = (chunkSize - chunkHeaderSize) / blockSize;
+
+		classes[i].create(blockSize, Math::min<SizeT, SizeT>(blockSize, MaxAlign), chunkBlocks);
+
+	}
+
+}
+
+
+
+SizeClassAllocator::~SizeClassAllocator() {}
+
+
+
+void SizeClassAllocator::nextFrame() noexcept {
+
+#ifdef ARC_ALLOCATOR_STATISTICS
+	lastFrameAllocations.store(frameAllocations.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+#endif
+
+}
+
+
+
+void SizeClassAllocator::trim() noexcept {
+
+	for (ConcurrentChunkAllocator& allocator : classes) {
+		allocator.trim();
+	}
+
+}
+
+
+
+SizeClassAllocator::Statistics SizeClassAllocator::getStatistics() const noexcept {
+
+	Statistics statistics {};
+
+#ifdef ARC_ALLOCATOR_STATISTICS
+	statistics.liveBytes = liveBytes.load(std::memory_order_relaxed);
+	statistics.peakBytes = peakBytes.load(std::memory_order_relaxed);
+	statistics.allocations = allocations.load(std::memory_order_relaxed);
+	statistics.largeAllocations = largeAllocations.load(std::memory_order_relaxed);
+	statistics.frameAllocations = lastFrameAllocations.load(std::memory_order_relaxed);
+#endif
+
+	return statistics;
+
+}
+
+
+
+SizeClassAllocator::ClassStatistics SizeClassAllocator::getClassStatistics(u32 sizeClass) const noexcept {
+
+	arc_assert(sizeClass < ClassCount, "Size class %d out of bounds", sizeClass);
+
+	ClassStatistics statistics {};
+	statistics.blockSize = ClassSizes[sizeClass];
+	statistics.reservedBytes = classes[sizeClass].getReservedSize();
+
+#ifdef ARC_ALLOCATOR_STATISTICS
+	const ClassCounters& counter = counters[sizeClass];
+	statistics.liveBlocks = counter.liveBlocks.load(std::memory_order_relaxed);
+	statistics.peakBlocks = counter.peakBlocks.load(std::memory_order_relaxed);
+	statistics.requestedBytes = counter.requestedBytes.load(std::memory_order_relaxed);
+	statistics.allocations = counter.allocations.load(std::memory_order_relaxed);
+#endif
+
+	return statistics;
+
+}
+
+
+
+void SizeClassAllocator::logStatistics() const {
+
+	Statistics statistics = getStatistics();
+
+	Log::info("Size Class Allocator", "Live: %zu bytes, peak: %zu bytes, allocations: %zu (%zu large), last frame: %zu",
+		statistics.liveBytes, statistics.peakBytes, statistics.allocations, statistics.largeAllocations, statistics.frameAllocations);
+
+	for (u32 i = 0; i < ClassCount; i++) {
+
+		ClassStatistics cs = getClassStatistics(i);
+
+		if (!cs.allocations) {
+			continue;
+		}
+
+		Log::info("Size Class Allocator", "[%zu] live: %zu, peak: %zu, allocations: %zu, reserved: %zu bytes, internal fragmentation: %.1f%%, external fragmentation: %.1f%%",
+			cs.blockSize, cs.liveBlocks, cs.peakBlocks, cs.allocations, cs.reservedBytes, cs.getInternalFragmentation() * 100, cs.getExternalFragmentation() * 100);
+
+	}
+
+}
+
+
+
+SizeClassAllocator& SizeClassAllocator::getDefault() {
+
+	//Intentionally leaked, see declaration
+	static SizeClassAllocator* allocator = new SizeClassAllocator;
+	return *allocator;
+
+}
+
+
+
+void* SizeClassAllocator::do_allocate(SizeT size, SizeT align) {
+
+	void* ptr;
+
+	if (isSmall(size, align)) {
+
+		u32 sizeClass = getSizeClass(Math::max<SizeT, SizeT>(size, align));
+		ptr = classes[sizeClass].allocate();
+
+#ifdef ARC_ALLOCATOR_STATISTICS
+		ClassCounters& counter = counters[sizeClass];
+		updatePeak(counter.peakBlocks, counter.liveBlocks.fetch_add(1, std::memory_order_relaxed) + 1);
+		counter.requestedBytes.fetch_add(size, std::memory_order_relaxed);
+		counter.allocations.fetch_add(1, std::memory_order_relaxed);
+#endif
+
+	} else {
+
+		ptr = ::operator new(size, std::align_val_t(align));
+
+#ifdef ARC_ALLOCATOR_STATISTICS
+		largeAllocations.fetch_add(1, std::memory_order_relaxed);
+#endif
+
+	}
+
+#ifdef ARC_ALLOCATOR_STATISTICS
+	updatePeak(peakBytes, liveBytes.fetch_add(size, std::memory_order_relaxed) + size);
+	allocations.fetch_add(1, std::memory_order_relaxed);
+	frameAllocations.fetch_add(1, std::memory_order_relaxed);
+#endif
+
+	return ptr;
+
+}
+
+
+
+void SizeClassAllocator::do_deallocate(void* ptr, SizeT size, SizeT align) {
+
+	if (isSmall(size, align)) {
+
+		u32 sizeClass = getSizeClass(Math::max<SizeT, SizeT>(size, align));
+		classes[sizeClass].deallocate(ptr);
+
+#ifdef ARC_ALLOCATOR_STATISTICS
+		ClassCounters& counter = counters[sizeClass];
+		counter.liveBlocks.fetch_sub(1, std::memory_order_relaxed);
+		counter.requestedBytes.fetch_sub(size, std::memory_order_relaxed);
+#endif
+
+	} else {
+
+		::operator delete(ptr, size, std::align_val_t(align));
+
+	}
+
+#ifdef ARC_ALLOCATOR_STATISTICS
+	liveBytes.fetch_sub(size, std::memory_order_relaxed);
+#endif
+
+}
+
+
+
+bool SizeClassAllocator::do_is_equal(const std::pmr::memory_resource& resource) const noexcept {
+	return this == &resource;
+}
+
+
+
+bool SizeClassAllocator::isSmall(SizeT size, AlignT align) noexcept {
+	return size <= MaxSize && align <= MaxAlign;
+}
+
+
+
+void SizeClassAllocator::updatePeak(std::atomic<SizeT>& peak, SizeT value) noexcept {
+
+	SizeT current = peak.load(std::memory_order_relaxed);
+	while (value > current && !peak.compare_exchange_weak(current, value, std::memory_order_relaxed));
+
+}
\ No newline at end of file
@@ -0,0 +1,203 @@
+#pragma once
+
+#include "concurrentchunkallocator.h"
+#include "arcconfig.h"
+#include "types.h"
+
+#include <array>
+#include <atomic>
+#include <vector>
+#include <cstddef>
+#include <functional>
+#include <unordered_map>
+#include <memory_resource>
+
+
+/*
+	SizeClassAllocator
+
+	General-purpose allocator for small objects.
+	Requests of up to MaxSize bytes are rounded up to one of several size classes, each served by its own ConcurrentChunkAllocator.
+	Larger or over-aligned requests are forwarded to the system allocator.
+
+	Usable as std::pmr::memory_resource or through SizeClassAdapter. Deallocation requires the size and alignment passed to allocation.
+	With ARC_ALLOCATOR_STATISTICS, live and peak usage, allocations per frame and per-class fragmentation are tracked.
+*/
+class SizeClassAllocator : public std::pmr::memory_resource {
+
+public:
+
+	constexpr static SizeT MinSize = 8;
+	constexpr static SizeT MaxSize = 4096;
+	constexpr static AlignT MaxAlign = 16;
+
+	//Block sizes of the size classes, two per power of two
+	constexpr static std::array<SizeT, 17> ClassSizes = { 8, 16, 32, 48, 64, 96, 128, 192, 256, 384, 512, 768, 1024, 1536, 2048, 3072, 4096 };
+	constexpr static u32 ClassCount = ClassSizes.size();
+
+
+	struct ClassStatistics {
+
+		SizeT blockSize;
+		SizeT liveBlocks;
+		SizeT peakBlocks;
+		SizeT requestedBytes;
+		SizeT allocations;
+		SizeT reservedBytes;
+
+		//Fraction of live block memory lost to rounding up to the class size
+		double getInternalFragmentation() const noexcept;
+
+		//Fraction of reserved chunk memory not occupied by live blocks
+		double getExternalFragmentation() const noexcept;
+
+	};
+
+	struct Statistics {
+
+		SizeT liveBytes;
+		SizeT peakBytes;
+		SizeT allocations;
+		SizeT largeAllocations;
+		SizeT frameAllocations;
+
+	};
+
+
+	SizeClassAllocator();
+	~SizeClassAllocator() override;
+
+	SizeClassAllocator(const SizeClassAllocator& allocator) = delete;
+	SizeClassAllocator& operator=(const SizeClassAllocator& allocator) = delete;
+
+
+	//Marks the start of a new frame, making the allocation count of the finished frame available in the statistics
+	void nextFrame() noexcept;
+
+	//Returns memory held by the size classes' depots to the system where possible
+	void trim() noexcept;
+
+
+	//Returns the global statistics. frameAllocations refers to the last finished frame.
+	Statistics getStatistics() const noexcept;
+
+	//Returns the statistics of the given size class
+	ClassStatistics getClassStatistics(u32 sizeClass) const noexcept;
+
+	//Writes the statistics of all size classes to the log
+	void logStatistics() const;
+
+
+	//Returns the size class serving size bytes. size must not exceed MaxSize.
+	constexpr static u32 getSizeClass(SizeT size) noexcept {
+		return classLookup[(size + MinSize - 1) / MinSize];
+	}
+
+
+	//Returns the process-wide instance. It is never destroyed, so containers with static storage duration may safely outlive everything else.
+	static SizeClassAllocator& getDefault();
+
+protected:
+
+	void* do_allocate(SizeT size, SizeT align) override;
+	void do_deallocate(void* ptr, SizeT size, SizeT align) override;
+	bool do_is_equal(const std::pmr::memory_resource& resource) const noexcept override;
+
+private:
+
+	struct alignas(64) ClassCounters {
+
+		std::atomic<SizeT> liveBlocks = 0;
+		std::atomic<SizeT> peakBlocks = 0;
+		std::atomic<SizeT> requestedBytes = 0;
+		std::atomic<SizeT> allocations = 0;
+
+	};
+
+	constexpr static auto classLookup = []() {
+
+		std::array<u8, MaxSize / MinSize + 1> lookup {};
+		u32 sizeClass = 0;
+
+		for (SizeT i = 0; i < lookup.size(); i++) {
+
+			while (ClassSizes[sizeClass] < i * MinSize) {
+				sizeClass++;
+			}
+
+			lookup[i] = sizeClass;
+
+		}
+
+		return lookup;
+
+	}();
+
+	static bool isSmall(SizeT size, AlignT align) noexcept;
+	static void updatePeak(std::atomic<SizeT>& peak, SizeT value) noexcept;
+
+	ConcurrentChunkAllocator classes[ClassCount];
+
+#ifdef ARC_ALLOCATOR_STATISTICS
+	ClassCounters counters[ClassCount];
+
+	alignas(64) std::atomic<SizeT> liveBytes;
+	std::atomic<SizeT> peakBytes;
+	std::atomic<SizeT> allocations;
+	std::atomic<SizeT> largeAllocations;
+	std::atomic<SizeT> frameAllocations;
+	std::atomic<SizeT> lastFrameAllocations;
+#endif
+
+};
+
+
+
+/*
+	STL-compatible allocator adapter for SizeClassAllocator.
+	Default-constructed adapters use the default instance, so containers can switch to it by changing their allocator type only.
+*/
+template<class T>
+class SizeClassAdapter {
+
+public:
+
+	using value_type = T;
+
+	SizeClassAdapter() noexcept : allocator(&SizeClassAllocator::getDefault()) {}
+	SizeClassAdapter(SizeClassAllocator& allocator) noexcept : allocator(&allocator) {}
+
+	template<class U>
+	SizeClassAdapter(const SizeClassAdapter<U>& adapter) noexcept : allocator(adapter.allocator) {}
+
+	[[nodiscard]] T* allocate(SizeT n) {
+		return static_cast<T*>(allocator->allocate(n * sizeof(T), alignof(T)));
+	}
+
+	void deallocate(T* ptr, SizeT n) noexcept {
+		allocator->deallocate(ptr, n * sizeof(T), alignof(T));
+	}
+
+	template<class U>
+	bool operator==(const SizeClassAdapter<U>& adapter) const noexcept {
+		return allocator == adapter.allocator;
+	}
+
+private:
+
+	template<class U>
+	friend class SizeClassAdapter;
+
+	SizeClassAllocator* allocator;
+
+};
+
+
+template<class T>
+using SizeClassVector = std::vector<T, SizeClassAdapter<T>>;
+
+template<class K, class V, class Hash = std::hash<K>, class Equal = std::equal_to<K>>
+using SizeClassMap = std::unordered_map<K, V, Hash, Equal, SizeClassAdapter<std::pair<const K, V>>>;
+
+template<class K, class V, class Hash = std::hash<K>, class Equal = std::equal_to<K>>
+using SizeClassMultimap = std::unordered_multimap<K, V, Hash, Equal, SizeClassAdapter<std::pair<const K, V>>>;
\ No newline at end of file
@@ -0,0 +1,182 @@
+#include "statebuffer.h"
+#include "util/math.h"
+#include "util/time.h"
+#include "util/assert.h"
+
+#include <utility>
+
+
+StateBuffer::View::View() noexcept : buffer(nullptr), timestamp(0) {}
+
+StateBuffer::View::View(StateBuffer& buffer, std::span<SimulationState* const> states, u64 timestamp) noexcept : buffer(&buffer), states(states), timestamp(timestamp) {}
+
+StateBuffer::View::~View() {
+	reset();
+}
+
+
+
+StateBuffer::View::View(View&& view) noexcept :
+	buffer(std::exchange(view.buffer, nullptr)),
+	states(std::exchange(view.states, {})),
+	timestamp(view.timestamp) {}
+
+
+
+StateBuffer::View& StateBuffer::View::operator=(View&& view) noexcept {
+
+	if (this != &view) {
+
+		reset();
+		buffer = std::exchange(view.buffer, nullptr);
+		states = std::exchange(view.states, {});
+		timestamp = view.timestamp;
+
+	}
+
+	return *this;
+
+}
+
+
+
+SizeT StateBuffer::View::getSize() const noexcept {
+	return states.size();
+}
+
+
+
+const SimulationState& StateBuffer::View::operator[](SizeT index) const noexcept {
+	return *states[index];
+}
+
+
+
+double StateBuffer::View::getInterpolation(u64 time) const noexcept {
+
+	if (!buffer) {
+		return 1.0;
+	}
+
+	if (time <= timestamp) {
+		return 0.0;
+	}
+
+	return Math::min<double, double>(static_cast<double>(time - timestamp) / buffer->tickDuration, 1.0);
+
+}
+
+
+
+void StateBuffer::View::reset() noexcept {
+
+	if (buffer) {
+
+		std::exchange(buffer, nullptr)->release();
+		states = {};
+
+	}
+
+}
+
+
+
+StateBuffer::StateBuffer() : pending(nullptr), timestamp(0), tickDuration(1), reading(false) {}
+
+
+
+void StateBuffer::setTickDuration(u64 duration) {
+
+	arc_assert(duration, "Tick duration must be non-zero");
+	tickDuration = duration;
+
+}
+
+
+
+SimulationState& StateBuffer::acquire() {
+
+	std::lock_guard lock(mutex);
+
+	if (!pending) {
+
+		if (freeStates.empty()) {
+
+			pending = states.emplace_back(std::make_unique<SimulationState>()).get();
+
+		} else {
+
+			pending = freeStates.back();
+			freeStates.pop_back();
+
+		}
+
+	}
+
+	return *pending;
+
+}
+
+
+
+void StateBuffer::publish() {
+
+	std::lock_guard lock(mutex);
+
+	arc_assert(pending, "No state has been acquired");
+
+	timestamp = Time::getTimeSinceEpoch(Time::Unit::Nanoseconds);
+	pending->timestamp = timestamp;
+
+	//A snapshot replaces everything the reader has not taken yet
+	if (pending->snapshot) {
+
+		freeStates.insert(freeStates.end(), publishedStates.begin(), publishedStates.end());
+		publishedStates.clear();
+
+	}
+
+	publishedStates.push_back(std::exchange(pending, nullptr));
+
+}
+
+
+
+StateBuffer::View StateBuffer::read() {
+
+	std::lock_guard lock(mutex);
+
+	arc_assert(!reading, "State buffer supports a single view at a time");
+
+	//The read list has been emptied by the last release, so the publisher continues on the former one
+	readStates.swap(publishedStates);
+	reading = true;
+
+	return View(*this, readStates, timestamp);
+
+}
+
+
+
+Transform StateBuffer::interpolate(const Transform& from, const Transform& to, double factor) {
+
+	Transform transform;
+	transform.position = from.position + (to.position - from.position) * factor;
+	transform.scale = from.scale + (to.scale - from.scale) * factor;
+	transform.rotation = Quatx::slerp(from.rotation, to.rotation, factor);
+
+	return transform;
+
+}
+
+
+
+void StateBuffer::release() noexcept {
+
+	std::lock_guard lock(mutex);
+
+	freeStates.insert(freeStates.end(), readStates.begin(), readStates.end());
+	readStates.clear();
+	reading = false;
+
+}
\ No newline at end of file
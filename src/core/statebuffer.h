@@ -0,0 +1,103 @@
+#pragma once
+
+#include "acs/actor.h"
+#include "acs/component/transform.h"
+#include "types.h"
+
+#include <mutex>
+#include <memory>
+#include <span>
+#include <vector>
+
+
+
+/*
+	Transforms of the simulated actors changed by a tick.
+	A snapshot holds every simulated actor instead and replaces all former states, it is published whenever actors have been added or removed.
+*/
+struct SimulationState {
+
+	std::vector<ActorID> actors;
+	std::vector<Transform> transforms;
+	u64 timestamp = 0;
+	bool snapshot = false;
+
+};
+
+
+
+/*
+	Hands simulation states from the simulation thread to the render thread.
+	The producer fills the state returned by acquire() and publishes it. Ticks without changes publish nothing.
+	The single reader takes all states published since its previous read in order and applies them on top of what it has already seen.
+	States are recycled once the reader's view is released, so the buffer only grows while the reader holds on to a view.
+*/
+class StateBuffer {
+
+public:
+
+	class View {
+
+	public:
+
+		View() noexcept;
+		View(StateBuffer& buffer, std::span<SimulationState* const> states, u64 timestamp) noexcept;
+		~View();
+
+		View(const View& view) = delete;
+		View& operator=(const View& view) = delete;
+		View(View&& view) noexcept;
+		View& operator=(View&& view) noexcept;
+
+		//Returns the number of states published since the previous read
+		SizeT getSize() const noexcept;
+
+		//Returns the index-th state, oldest first
+		const SimulationState& operator[](SizeT index) const noexcept;
+
+		//Returns the interpolation factor between the last two ticks at time (in nanoseconds since epoch)
+		double getInterpolation(u64 time) const noexcept;
+
+	private:
+
+		void reset() noexcept;
+
+		StateBuffer* buffer;
+		std::span<SimulationState* const> states;
+		u64 timestamp;
+
+	};
+
+
+	StateBuffer();
+
+	//Sets the duration of a tick in nanoseconds. Must not be called while the buffer is in use.
+	void setTickDuration(u64 duration);
+
+	//Returns the state to be filled by the producer. Only one state may be acquired at a time.
+	SimulationState& acquire();
+
+	//Publishes the acquired state
+	void publish();
+
+	//Takes all states published since the previous read. Only one view may exist at a time.
+	View read();
+
+	//Interpolates between two transforms. Rotations are interpolated spherically along the shorter arc.
+	static Transform interpolate(const Transform& from, const Transform& to, double factor);
+
+private:
+
+	void release() noexcept;
+
+	std::mutex mutex;
+	std::vector<std::unique_ptr<SimulationState>> states;
+	std::vector<SimulationState*> freeStates;
+	std::vector<SimulationState*> publishedStates;
+	std::vector<SimulationState*> readStates;
+	SimulationState* pending;
+	u64 timestamp;
+	u64 tickDuration;
+	bool reading;
+
+};
\ No newline at end of file
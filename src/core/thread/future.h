@@ -1,16 +1,267 @@
 #pragma once
 
+#include "taskpool.h"
+#include "arcintrinsic.h"
+#include "types.h"
+
+#include <new>
+#include <atomic>
 #include <future>
+#include <utility>
+#include <exception>
+#include <type_traits>
+
+
+
+class TaskExecutor;
+
+//Executes one queued task of the executor on the calling thread. Returns false if no task was available.
+bool assistTaskExecutor(TaskExecutor& executor) noexcept;
+
+
+
+/*
+	Shared state between a TaskPromise and a TaskFuture.
+	Result slots are allocated from the TaskPool if they fit into a block and are reference counted by their promise and future.
+*/
+template<class T>
+class TaskResult {
+
+	struct Empty {};
+
+	using Value = std::conditional_t<std::is_void_v<T>, Empty, T>;
+
+	enum State : u32 {
+		Pending,
+		Ready,
+		Failed
+	};
+
+public:
+
+	TaskResult(const TaskResult& result) = delete;
+	TaskResult& operator=(const TaskResult& result) = delete;
+
+
+	//Creates a new slot referenced by one promise and one future
+	static TaskResult* create() {
+
+		if constexpr (Pooled) {
+			static_assert(sizeof(TaskResult) <= TaskPool::blockSize, "Pooled task result exceeds the block size");
+			return ::new(TaskPool::allocate()) TaskResult();
+		} else {
+			return new TaskResult();
+		}
+
+	}
+
+	template<class... Args>
+	void setValue(Args&&... args) {
+
+		::new(storage) Value(std::forward<Args>(args)...);
+		state.store(Ready, std::memory_order_release);
+
+	}
+
+	void setException(std::exception_ptr e) noexcept {
+
+		exception = e;
+		state.store(Failed, std::memory_order_release);
+
+	}
+
+	bool ready() const noexcept {
+		return state.load(std::memory_order_acquire) != Pending;
+	}
+
+	//Moves the value out of the slot or rethrows the stored exception. Must only be called once the slot is ready.
+	T take() {
+
+		if (state.load(std::memory_order_acquire) == Failed) {
+			std::rethrow_exception(exception);
+		}
+
+		if constexpr (!std::is_void_v<T>) {
+			return std::move(*getValue());
+		}
+
+	}
+
+	//Drops one reference and destroys the slot once both sides have released it
+	void release() noexcept {
+
+		if (references.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+			return;
+		}
+
+		if (state.load(std::memory_order_relaxed) == Ready) {
+			getValue()->~Value();
+		}
+
+		if constexpr (Pooled) {
+			this->~TaskResult();
+			TaskPool::free(this);
+		} else {
+			delete this;
+		}
+
+	}
+
+private:
+
+	TaskResult() : references(2), state(Pending) {}
+	~TaskResult() = default;
+
+	Value* getValue() noexcept {
+		return std::launder(reinterpret_cast<Value*>(storage));
+	}
+
+	std::atomic<u32> references;
+	std::atomic<u32> state;
+	std::exception_ptr exception;
+	alignas(Value) Byte storage[sizeof(Value)];
+
+	constexpr static bool Pooled = 2 * sizeof(u32) + sizeof(std::exception_ptr) + alignof(Value) + sizeof(Value) <= TaskPool::blockSize && alignof(Value) <= TaskPool::blockAlign;
+
+};
+
+
+
+/*
+	Producer side of a task result.
+	If the promise is destroyed without a result, e.g. because its task has been discarded, the future receives a broken promise error.
+*/
+template<class T>
+class TaskPromise {
+
+public:
 
+	explicit TaskPromise(TaskResult<T>* result) noexcept : result(result) {}
 
+	TaskPromise(TaskPromise&& promise) noexcept : result(std::exchange(promise.result, nullptr)) {}
+	TaskPromise& operator=(TaskPromise&& promise) = delete;
+
+	~TaskPromise() {
+
+		if (result) {
+			result->setException(std::make_exception_ptr(std::future_error(std::future_errc::broken_promise)));
+			result->release();
+		}
+
+	}
+
+	template<class... Args>
+	void setValue(Args&&... args) {
+
+		result->setValue(std::forward<Args>(args)...);
+		std::exchange(result, nullptr)->release();
+
+	}
+
+	void setException(std::exception_ptr e) noexcept {
+
+		result->setException(e);
+		std::exchange(result, nullptr)->release();
+
+	}
+
+private:
+
+	TaskResult<T>* result;
+
+};
+
+
+
+/*
+	Typed handle to the result of an asynchronous task.
+	Waiting on a future executes queued tasks of the associated executor instead of blocking.
+*/
+template<class T>
 class TaskFuture {
 
-	explicit TaskFuture(std::future<std::any>&& future) : future(std::move(future)) {}
+public:
+
+	TaskFuture() noexcept : result(nullptr), executor(nullptr) {}
+	TaskFuture(TaskResult<T>* result, TaskExecutor* executor) noexcept : result(result), executor(executor) {}
+
+	TaskFuture(const TaskFuture& future) = delete;
+	TaskFuture& operator=(const TaskFuture& future) = delete;
+
+	TaskFuture(TaskFuture&& future) noexcept : result(std::exchange(future.result, nullptr)), executor(future.executor) {}
+
+	TaskFuture& operator=(TaskFuture&& future) noexcept {
+
+		if (this != &future) {
+
+			reset();
+			result = std::exchange(future.result, nullptr);
+			executor = future.executor;
 
+		}
 
+		return *this;
+
+	}
+
+	~TaskFuture() {
+		reset();
+	}
+
+
+	//Returns true if the future refers to a task
+	bool valid() const noexcept {
+		return result;
+	}
+
+	//Returns true if the task has finished
+	bool ready() const noexcept {
+		return result && result->ready();
+	}
+
+	//Waits until the task has finished
+	void wait() const {
+
+		while (!result->ready()) {
+
+			if (!executor || !assistTaskExecutor(*executor)) {
+				arc_spin_yield();
+			}
+
+		}
+
+	}
+
+	//Waits for and returns the result. Exceptions thrown by the task are rethrown. Invalidates the future.
+	T get() {
+
+		wait();
+
+		struct Releaser {
+
+			~Releaser() {
+				result->release();
+			}
+
+			TaskResult<T>* result;
+
+		} releaser{ std::exchange(result, nullptr) };
+
+		return releaser.result->take();
+
+	}
 
 private:
 
-	std::future<std::any> future;
+	void reset() noexcept {
+
+		if (result) {
+			std::exchange(result, nullptr)->release();
+		}
+
+	}
+
+	TaskResult<T>* result;
+	TaskExecutor* executor;
 
 };
\ No newline at end of file
@@ -0,0 +1,133 @@
+#pragma once
+
+#include "taskpool.h"
+#include "util/concepts.h"
+#include "types.h"
+
+#include <new>
+#include <type_traits>
+
+
+
+/*
+	Type-erased task of fixed size.
+	Similar to FastAny, the callable is stored inline if it fits into the task's buffer; larger callables are moved to the heap.
+	Tasks are created in TaskPool blocks and only referenced by pointer, so submitting a task performs no allocation on the hot path.
+*/
+class InlineTask final {
+
+	enum class Operation {
+		Invoke,
+		Destroy
+	};
+
+	typedef void(*Executor)(InlineTask*, Operation);
+
+public:
+
+	constexpr static SizeT Size = TaskPool::blockSize - sizeof(Executor);
+	constexpr static AlignT Align = PointerAlign;
+
+	//Returns true if the callable is stored inline
+	template<class Function>
+	constexpr static bool StoredInline = sizeof(Function) <= Size && alignof(Function) <= Align;
+
+
+	InlineTask(const InlineTask& task) = delete;
+	InlineTask& operator=(const InlineTask& task) = delete;
+
+
+	//Creates a new task holding function
+	template<class Function>
+	static InlineTask* create(Function&& function) {
+
+		void* block = TaskPool::allocate();
+
+		try {
+			return ::new(block) InlineTask(std::forward<Function>(function));
+		} catch (...) {
+			TaskPool::free(block);
+			throw;
+		}
+
+	}
+
+	//Destroys the task and returns its memory to the pool
+	static void destroy(InlineTask* task) noexcept {
+
+		task->executor(task, Operation::Destroy);
+		task->~InlineTask();
+		TaskPool::free(task);
+
+	}
+
+
+	//Invokes the stored callable
+	void operator()() {
+		executor(this, Operation::Invoke);
+	}
+
+private:
+
+	template<class Function>
+	explicit InlineTask(Function&& function) {
+
+		using F = std::decay_t<Function>;
+
+		if constexpr (StoredInline<F>) {
+			::new(storage.buffer) F(std::forward<Function>(function));
+		} else {
+			storage.ptr = new F(std::forward<Function>(function));
+		}
+
+		executor = &execute<F>;
+
+	}
+
+	~InlineTask() = default;
+
+	template<class F>
+	static void execute(InlineTask* task, Operation operation) {
+
+		F* function;
+
+		if constexpr (StoredInline<F>) {
+			function = std::launder(reinterpret_cast<F*>(task->storage.buffer));
+		} else {
+			function = static_cast<F*>(task->storage.ptr);
+		}
+
+		switch (operation) {
+
+			case Operation::Invoke:
+				(*function)();
+				break;
+
+			case Operation::Destroy:
+
+				if constexpr (StoredInline<F>) {
+					function->~F();
+				} else {
+					delete function;
+				}
+
+				break;
+
+		}
+
+	}
+
+	Executor executor;
+
+	union Storage {
+
+		constexpr Storage() : ptr(nullptr) {}
+
+		void* ptr;
+		alignas(Align) Byte buffer[Size];
+
+	} storage;
+
+};
+
+static_assert(sizeof(InlineTask) <= TaskPool::blockSize, "InlineTask exceeds the task pool's block size");
\ No newline at end of file
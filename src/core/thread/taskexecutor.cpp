@@ -2,8 +2,12 @@
 
 
 
+thread_local TaskExecutor::WorkerContext TaskExecutor::localContext = { nullptr, nullptr };
+
+
+
 TaskExecutor::TaskExecutor() {
-	
+
 }
 
 
@@ -15,6 +19,7 @@ TaskExecutor::~TaskExecutor() {
 #endif
 
 	stop();
+	forceClear();
 
 }
 
@@ -24,8 +29,8 @@ void TaskExecutor::start() {
 
 	running.test_and_set(std::memory_order_release);
 
-	for (Thread& t : threads) {
-		t.start(&TaskExecutor::taskMain, this, false);
+	for (u32 i = 0; i < threads.size(); i++) {
+		threads[i].start(&TaskExecutor::taskMain, this, u32(i));
 	}
 
 }
@@ -33,23 +38,53 @@ void TaskExecutor::start() {
 
 
 void TaskExecutor::assistDispatch() noexcept {
-	taskMain(true);
+
+	Worker* worker = getLocalWorker();
+
+	while (InlineTask* task = acquireTask(worker)) {
+		execute(task);
+	}
+
+}
+
+
+
+bool TaskExecutor::tryExecute() noexcept {
+
+	if (InlineTask* task = acquireTask(getLocalWorker())) {
+		execute(task);
+		return true;
+	}
+
+	return false;
+
 }
 
 
 
 void TaskExecutor::forceClear() noexcept {
 
-	TaskFunction function;
+	InlineTask* task;
+	u32 count = 0;
 
-	for (i32 i = 4; i >= 0; i--) {
+	while (injector.pop(task)) {
+		InlineTask::destroy(task);
+		count++;
+	}
 
-		while (!taskQueues[i].empty()) {
-			taskQueues[i].pop(function);
+	for (auto& worker : workers) {
+
+		while (worker->deque.steal(task)) {
+			InlineTask::destroy(task);
+			count++;
 		}
 
 	}
 
+#ifndef ARC_TASK_PERIODIC_SLEEP
+	queuedTaskCount.fetch_sub(count, std::memory_order_seq_cst);
+#endif
+
 }
 
 
@@ -74,59 +109,179 @@ void TaskExecutor::stop() {
 
 
 void TaskExecutor::setThreadCount(u32 threadCount) {
+
+	arc_assert(!running.test(std::memory_order_acquire), "Cannot change the thread count of a running executor");
+
 	threads.resize(threadCount);
+	workers.resize(threadCount);
+
+	for (u32 i = 0; i < threadCount; i++) {
+
+		if (!workers[i]) {
+
+			workers[i] = std::make_unique<Worker>();
+			workers[i]->victimSeed = i * 0x9E3779B9 + 1;
+
+		}
+
+	}
+
 }
 
 
 
-void TaskExecutor::taskMain(bool assist) {
+u32 TaskExecutor::getThreadCount() const noexcept {
+	return threads.size();
+}
+
+
+
+void TaskExecutor::submit(InlineTask* task) {
+
+#if defined(ARC_TASK_SLEEP_ATOMIC) || defined(ARC_TASK_SPIN)
+	queuedTaskCount.fetch_add(1, std::memory_order_seq_cst);
+#endif
+
+	if (Worker* worker = getLocalWorker()) {
+
+		worker->deque.push(task);
+
+	} else {
+
+		//Injector is full (task has not been moved from), help draining it instead of dropping the task
+		while (!injector.push(std::move(task))) {
+
+			if (InlineTask* other = acquireTask(nullptr)) {
+				execute(other);
+			} else {
+				arc_spin_yield();
+			}
+
+		}
+
+	}
+
+#ifdef ARC_TASK_SLEEP_ATOMIC
+	queuedTaskCount.notify_one();
+#endif
+
+}
 
-	TaskFunction function;
-	std::any result;
 
-	while (running.test(std::memory_order_acquire)) {
 
-		for (i32 i = 4; i >= 0; i--) {
+InlineTask* TaskExecutor::acquireTask(Worker* worker) noexcept {
 
-			if (taskQueues[i].pop(function)) {
+	InlineTask* task = nullptr;
+
+	if ((worker && worker->deque.pop(task)) || injector.pop(task) || (task = stealTask(worker))) {
 
 #ifndef ARC_TASK_PERIODIC_SLEEP
-				queuedTaskCount.fetch_sub(1, std::memory_order_seq_cst);
+		queuedTaskCount.fetch_sub(1, std::memory_order_seq_cst);
 #endif
-				try {
-					function(result);
-				} catch (std::exception& e) {
-					Log::error("Task Executor", "An exception has been thrown in an async function: %s", e.what());
-				}
 
-				goto end_cycle;
+		return task;
 
-			}
+	}
+
+	return nullptr;
+
+}
+
+
+
+InlineTask* TaskExecutor::stealTask(Worker* thief) noexcept {
+
+	SizeT count = workers.size();
+
+	if (!count) {
+		return nullptr;
+	}
+
+	//Start at a pseudo-random victim so thieves spread over the workers
+	u32 start = 0;
+
+	if (thief) {
 
+		u32& seed = thief->victimSeed;
+		seed ^= seed << 13;
+		seed ^= seed >> 17;
+		seed ^= seed << 5;
+		start = seed % count;
+
+	}
+
+	InlineTask* task;
+
+	for (SizeT i = 0; i < count; i++) {
+
+		Worker* victim = workers[(start + i) % count].get();
+
+		if (victim != thief && victim->deque.steal(task)) {
+			return task;
 		}
 
-		if(!assist) {
+	}
+
+	return nullptr;
+
+}
+
+
+
+void TaskExecutor::execute(InlineTask* task) noexcept {
 
-			//Wait until there is a new element
+	try {
+		(*task)();
+	} catch (std::exception& e) {
+		Log::error("Task Executor", "An exception has been thrown in an async function: %s", e.what());
+	}
+
+	InlineTask::destroy(task);
+
+}
+
+
+
+void TaskExecutor::taskMain(u32 index) {
+
+	Worker* worker = workers[index].get();
+	localContext = { this, worker };
+
+	while (running.test(std::memory_order_acquire)) {
+
+		if (InlineTask* task = acquireTask(worker)) {
+			execute(task);
+			continue;
+		}
+
+		//Wait until there is a new element
 
 #ifdef ARC_TASK_SLEEP_ATOMIC
-			queuedTaskCount.wait(0, std::memory_order_seq_cst);
+		queuedTaskCount.wait(0, std::memory_order_seq_cst);
 #elif defined(ARC_TASK_SPIN)
 
-			while(!queuedTaskCount.load(std::memory_order_acquire)) {
-				arc_spin_yield();
-			}
-		
+		while(!queuedTaskCount.load(std::memory_order_acquire)) {
+			arc_spin_yield();
+		}
+
 #elif defined(ARC_TASK_PERIODIC_SLEEP)
-			std::this_thread::sleep_for(std::chrono::microseconds(ARC_TASK_SLEEP_DURATION));
+		std::this_thread::sleep_for(std::chrono::microseconds(ARC_TASK_SLEEP_DURATION));
 #endif
-		} else {
-			//If we're in assist mode, return here
-			return;
-		}
 
-	end_cycle:;
+	}
+
+	localContext = { nullptr, nullptr };
+
+}
+
+
+
+TaskExecutor::Worker* TaskExecutor::getLocalWorker() const noexcept {
+	return localContext.executor == this ? localContext.worker : nullptr;
+}
+
 
-	};
 
+bool assistTaskExecutor(TaskExecutor& executor) noexcept {
+	return executor.tryExecute();
 }
\ No newline at end of file
@@ -1,19 +1,21 @@
 #pragma once
 
 #include <vector>
-#include <unordered_map>
+#include <tuple>
+#include <memory>
+#include <new>
 
 #include "arcconfig.h"
 #include "arcintrinsic.h"
 #include "concurrentqueue.h"
+#include "workstealingdeque.h"
 #include "thread.h"
-#include "task.h"
+#include "inlinetask.h"
+#include "future.h"
+#include "util/math.h"
 #include "types.h"
 
 
-typedef u64 TaskID;
-typedef std::function<void(std::any&)> TaskFunction;
-
 enum class TaskPriority {
 	Weak,
 	Low,
@@ -23,12 +25,22 @@ enum class TaskPriority {
 };
 
 
+/*
+	Work-stealing task executor.
+	Every worker owns a Chase-Lev deque: tasks submitted from a worker are pushed to its own deque and popped LIFO, which keeps fork/join trees local.
+	Tasks submitted from other threads go to a bounded injector queue. Idle workers drain the injector and then steal from random victims.
+	Submission never drops tasks: if the injector is full, the submitting thread executes queued tasks until there is room again.
+	Tasks are InlineTasks living in TaskPool blocks, so submission does not allocate as long as the captured state fits into a task.
+*/
 class TaskExecutor {
 
 public:
 
-	constexpr static inline u32 queueSize = 512;
-	typedef ConcurrentQueue<TaskFunction, queueSize> TaskQueue;
+	constexpr static inline u32 injectorSize = ARC_TASK_INJECTOR_SIZE;
+	constexpr static inline u32 dequeSize = ARC_TASK_DEQUE_SIZE;
+
+	typedef ConcurrentQueue<InlineTask*, injectorSize> TaskQueue;
+	typedef WorkStealingDeque<InlineTask*> TaskDeque;
 
 	TaskExecutor();
 	~TaskExecutor();
@@ -39,41 +51,174 @@ public:
 	void assistDispatch() noexcept;
 	void forceClear() noexcept;
 
-	template<class Function, class... Args, typename Result = std::invoke_result_t<Function, Args...>>
-	TaskID run(Function&& function, Args&&... args) {
+	/*
+		Submits function(args...) for asynchronous execution.
+		The function and its arguments are copied/moved into the task, so temporaries may be passed safely.
+	*/
+	template<class Function, class... Args>
+	void run(Function&& function, Args&&... args) {
+
+		if constexpr (sizeof...(Args) == 0) {
+
+			submit(InlineTask::create(std::forward<Function>(function)));
+
+		} else {
+
+			submit(InlineTask::create([function = std::forward<Function>(function), arguments = std::make_tuple(std::forward<Args>(args)...)]() mutable {
+				std::apply(function, arguments);
+			}));
+
+		}
+
+	}
+
+
+	/*
+		Like run(), but returns a future receiving the result of function(args...).
+		Exceptions thrown by the function are forwarded to the future.
+	*/
+	template<class Function, class... Args, class Result = std::invoke_result_t<std::decay_t<Function>&, std::decay_t<Args>&...>>
+	TaskFuture<Result> async(Function&& function, Args&&... args) {
+
+		TaskResult<Result>* result = TaskResult<Result>::create();
+		TaskFuture<Result> future(result, this);
+
+		run([promise = TaskPromise<Result>(result), function = std::forward<Function>(function)](auto&&... arguments) mutable {
+
+			try {
 
-		TaskFunction x = [&](std::any& result) {
+				if constexpr (std::is_void_v<Result>) {
+					function(arguments...);
+					promise.setValue();
+				} else {
+					promise.setValue(function(arguments...));
+				}
 
-			if constexpr (std::is_same_v<Result, void>) {
-				std::invoke(std::forward<Function>(function), std::forward<Args>(args)...);
+			} catch (...) {
+				promise.setException(std::current_exception());
+			}
+
+		}, std::forward<Args>(args)...);
+
+		return future;
+
+	}
+
+
+	//Executes one queued task on the calling thread. Returns false if no task was available.
+	bool tryExecute() noexcept;
+
+
+	/*
+		Executes queued tasks on the calling thread until done() returns true.
+		Use this instead of blocking so that waiting threads keep contributing to the work they wait for.
+	*/
+	template<class Predicate>
+	void waitUntil(Predicate&& done) {
+
+		Worker* worker = getLocalWorker();
+
+		while (!done()) {
+
+			if (InlineTask* task = acquireTask(worker)) {
+				execute(task);
 			} else {
-				result = std::invoke(std::forward<Function>(function), std::forward<Args>(args)...);
+				arc_spin_yield();
+			}
+
+		}
+
+	}
+
+	/*
+		Splits [0, count) into ranges of grainSize elements and invokes function(start, end) for each range on the worker threads.
+		The calling thread processes ranges as well. Returns once every range has been processed.
+	*/
+	template<class Function>
+	void parallelFor(SizeT count, SizeT grainSize, Function&& function) {
+
+		grainSize = Math::max<SizeT, SizeT>(grainSize, 1);
+		SizeT rangeCount = (count + grainSize - 1) / grainSize;
+
+		if (rangeCount <= 1 || threads.empty() || !running.test(std::memory_order_acquire)) {
+
+			if (count) {
+				function(SizeT(0), count);
+			}
+
+			return;
+
+		}
+
+		std::atomic<SizeT> nextRange = 0;
+		std::atomic<SizeT> activeHelpers = Math::min<SizeT, SizeT>(threads.size(), rangeCount - 1);
+
+		auto process = [&]() {
+
+			for (SizeT range = nextRange.fetch_add(1, std::memory_order_relaxed); range < rangeCount; range = nextRange.fetch_add(1, std::memory_order_relaxed)) {
+
+				SizeT start = range * grainSize;
+				function(start, Math::min<SizeT, SizeT>(start + grainSize, count));
+
 			}
 
 		};
 
-		if (taskQueues[2].push(std::move(x))) {
-#if defined(ARC_TASK_SLEEP_ATOMIC)
-			queuedTaskCount.fetch_add(1, std::memory_order_seq_cst);
-			queuedTaskCount.notify_one();
-#elif defined(ARC_TASK_SPIN)
-			queuedTaskCount.fetch_add(1, std::memory_order_seq_cst);
-#endif
+		auto helper = [&]() {
+
+			process();
+			activeHelpers.fetch_sub(1, std::memory_order_release);
+
+		};
+
+		for (SizeT i = activeHelpers.load(std::memory_order_relaxed); i > 0; i--) {
+			run(helper);
 		}
 
-		return 0;
+		process();
+
+		//Helpers reference this stack frame, so wait until all of them have left
+		waitUntil([&]() {
+			return !activeHelpers.load(std::memory_order_acquire);
+		});
 
 	}
 
+
 	void setThreadCount(u32 threadCount);
+	u32 getThreadCount() const noexcept;
 
 private:
 
-	void taskMain(bool assist);
+	struct alignas(std::hardware_destructive_interference_size) Worker {
+
+		Worker() : deque(dequeSize), victimSeed(0) {}
+
+		TaskDeque deque;
+		u32 victimSeed;
+
+	};
+
+	//Identifies the executor and worker the current thread belongs to
+	struct WorkerContext {
+		TaskExecutor* executor;
+		Worker* worker;
+	};
+
+	void submit(InlineTask* task);
+	InlineTask* acquireTask(Worker* worker) noexcept;
+	InlineTask* stealTask(Worker* thief) noexcept;
+	void execute(InlineTask* task) noexcept;
+
+	void taskMain(u32 index);
+
+	Worker* getLocalWorker() const noexcept;
+
+	static thread_local WorkerContext localContext;
 
 	std::vector<Thread> threads;
-	TaskQueue taskQueues[5];
-	std::unordered_map<TaskID, Task> tasks;
+	std::vector<std::unique_ptr<Worker>> workers;
+	TaskQueue injector;
 	std::atomic_flag running;
 
 #if defined(ARC_TASK_SLEEP_ATOMIC) || defined(ARC_TASK_SPIN)
@@ -0,0 +1,197 @@
+#include "taskgraph.h"
+#include "taskexecutor.h"
+#include "util/assert.h"
+#include "util/log.h"
+
+
+
+void TaskNode::addSuccessor(TaskNode& successor) {
+
+	arc_assert(&graph == &successor.graph, "Cannot link nodes of different task graphs");
+	arc_assert(graph.finished(), "Cannot link nodes of a running task graph");
+
+	successors.push_back(&successor);
+	successor.predecessorCount++;
+	graph.validated = false;
+
+}
+
+
+
+
+
+TaskGraph::TaskGraph() : executor(nullptr), remainingNodes(0), validated(true) {}
+
+
+
+TaskGraph::~TaskGraph() {
+
+	if (!finished()) {
+		wait();
+	}
+
+}
+
+
+
+void TaskGraph::dispatch(TaskExecutor& executor) {
+
+	arc_assert(finished(), "Task graph has been dispatched while still running");
+
+	if (!validated) {
+		validate();
+	}
+
+	if (nodes.empty()) {
+		return;
+	}
+
+	this->executor = &executor;
+
+	for (auto& node : nodes) {
+		node->pendingPredecessors.store(node->predecessorCount, std::memory_order_relaxed);
+	}
+
+	remainingNodes.store(nodes.size(), std::memory_order_release);
+
+	for (TaskNode* node : roots) {
+		schedule(node);
+	}
+
+}
+
+
+
+void TaskGraph::wait() {
+
+	if (!executor) {
+		return;
+	}
+
+	executor->waitUntil([this]() {
+		return finished();
+	});
+
+}
+
+
+
+void TaskGraph::run(TaskExecutor& executor) {
+
+	dispatch(executor);
+	wait();
+
+}
+
+
+
+bool TaskGraph::finished() const noexcept {
+	return remainingNodes.load(std::memory_order_acquire) == 0;
+}
+
+
+
+void TaskGraph::clear() {
+
+	arc_assert(finished(), "Cannot clear a running task graph");
+
+	nodes.clear();
+	roots.clear();
+	validated = true;
+
+}
+
+
+
+SizeT TaskGraph::getNodeCount() const noexcept {
+	return nodes.size();
+}
+
+
+
+//Collects the root nodes and checks the graph for cycles (Kahn's algorithm)
+void TaskGraph::validate() {
+
+	roots.clear();
+
+	for (auto& node : nodes) {
+
+		node->pendingPredecessors.store(node->predecessorCount, std::memory_order_relaxed);
+
+		if (!node->predecessorCount) {
+			roots.push_back(node.get());
+		}
+
+	}
+
+	std::vector<TaskNode*> ready = roots;
+	SizeT visited = 0;
+
+	while (!ready.empty()) {
+
+		TaskNode* node = ready.back();
+		ready.pop_back();
+		visited++;
+
+		for (TaskNode* successor : node->successors) {
+
+			if (successor->pendingPredecessors.fetch_sub(1, std::memory_order_relaxed) == 1) {
+				ready.push_back(successor);
+			}
+
+		}
+
+	}
+
+	arc_assert(visited == nodes.size(), "Task graph contains a cycle");
+
+	validated = true;
+
+}
+
+
+
+void TaskGraph::schedule(TaskNode* node) {
+
+	executor->run([this, node]() {
+		execute(node);
+	});
+
+}
+
+
+
+void TaskGraph::execute(TaskNode* node) {
+
+	while (node) {
+
+		try {
+			node->function();
+		} catch (std::exception& e) {
+			Log::error("Task Graph", "An exception has been thrown in a task node: %s", e.what());
+		}
+
+		//Continue with the first ready successor on this thread, hand the others to the executor
+		TaskNode* next = nullptr;
+
+		for (TaskNode* successor : node->successors) {
+
+			if (successor->pendingPredecessors.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+
+				if (!next) {
+					next = successor;
+				} else {
+					schedule(successor);
+				}
+
+			}
+
+		}
+
+		//The graph may be destroyed as soon as the last node has finished, so it must not be touched afterwards
+		remainingNodes.fetch_sub(1, std::memory_order_acq_rel);
+		node = next;
+
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <functional>
+
+#include "util/assert.h"
+#include "types.h"
+
+
+
+class TaskGraph;
+class TaskExecutor;
+
+/*
+	Single node of a task graph.
+	A node becomes ready once all of its predecessors have finished.
+*/
+class TaskNode {
+
+public:
+
+	TaskNode(const TaskNode& node) = delete;
+	TaskNode& operator=(const TaskNode& node) = delete;
+
+	//Makes all given nodes run after this node
+	template<class... Nodes>
+	TaskNode& precede(Nodes&... successors) {
+		(addSuccessor(successors), ...);
+		return *this;
+	}
+
+	//Makes this node run after all given nodes
+	template<class... Nodes>
+	TaskNode& succeed(Nodes&... predecessors) {
+		(predecessors.addSuccessor(*this), ...);
+		return *this;
+	}
+
+	u32 getPredecessorCount() const noexcept {
+		return predecessorCount;
+	}
+
+	SizeT getSuccessorCount() const noexcept {
+		return successors.size();
+	}
+
+private:
+
+	friend class TaskGraph;
+
+	TaskNode(TaskGraph& graph, std::function<void()>&& function) : graph(graph), function(std::move(function)), predecessorCount(0), pendingPredecessors(0) {}
+
+	void addSuccessor(TaskNode& successor);
+
+	TaskGraph& graph;
+	std::function<void()> function;
+	std::vector<TaskNode*> successors;
+	u32 predecessorCount;
+	std::atomic<u32> pendingPredecessors;
+
+};
+
+
+
+/*
+	Dependency graph of tasks executed on a TaskExecutor.
+	Nodes without predecessors are submitted on dispatch. When a node finishes, it decrements the pending predecessor count of its successors;
+	the first successor becoming ready is continued on the same thread, the others are submitted to the executor.
+	A graph is built once and can be dispatched any number of times, e.g. once per frame. It must not be modified while running.
+*/
+class TaskGraph {
+
+public:
+
+	TaskGraph();
+	~TaskGraph();
+
+	TaskGraph(const TaskGraph& graph) = delete;
+	TaskGraph& operator=(const TaskGraph& graph) = delete;
+
+
+	//Adds a node executing function(). Nodes are stable for the graph's lifetime.
+	template<class Function>
+	TaskNode& add(Function&& function) {
+
+		arc_assert(finished(), "Cannot add nodes to a running task graph");
+
+		nodes.emplace_back(new TaskNode(*this, std::function<void()>(std::forward<Function>(function))));
+		validated = false;
+
+		return *nodes.back();
+
+	}
+
+	//Starts executing the graph on the executor and returns immediately
+	void dispatch(TaskExecutor& executor);
+
+	//Blocks until the graph has finished. The calling thread executes pending tasks while waiting.
+	void wait();
+
+	//Dispatches the graph and waits for it
+	void run(TaskExecutor& executor);
+
+	//Returns true if the graph is not running
+	bool finished() const noexcept;
+
+	//Removes all nodes
+	void clear();
+
+	SizeT getNodeCount() const noexcept;
+
+private:
+
+	friend class TaskNode;
+
+	void validate();
+	void schedule(TaskNode* node);
+	void execute(TaskNode* node);
+
+	std::vector<std::unique_ptr<TaskNode>> nodes;
+	std::vector<TaskNode*> roots;
+	TaskExecutor* executor;
+	std::atomic<SizeT> remainingNodes;
+	bool validated;
+
+};
\ No newline at end of file
@@ -0,0 +1,40 @@
+#include "taskpool.h"
+#include "core/memory/concurrentchunkallocator.h"
+
+
+
+namespace {
+
+	constexpr AddressT chunkBlocks = 128;
+
+	struct Pool {
+
+		Pool() {
+			allocator.create(TaskPool::blockSize, TaskPool::blockAlign, chunkBlocks);
+		}
+
+		ConcurrentChunkAllocator allocator;
+
+	};
+
+
+	ConcurrentChunkAllocator& getAllocator() {
+
+		static Pool pool;
+		return pool.allocator;
+
+	}
+
+}
+
+
+
+void* TaskPool::allocate() {
+	return getAllocator().allocate();
+}
+
+
+
+void TaskPool::free(void* ptr) noexcept {
+	getAllocator().deallocate(ptr);
+}
\ No newline at end of file
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "types.h"
+
+
+
+/*
+	Fixed-size block pool for task objects and result slots.
+	Backed by a ConcurrentChunkAllocator, so allocation and deallocation are a pointer pop/push on a thread-local magazine in the common case.
+*/
+class TaskPool {
+
+public:
+
+	constexpr static SizeT blockSize = 64;
+	constexpr static AlignT blockAlign = 64;
+
+	//Returns an uninitialized block of blockSize bytes
+	static void* allocate();
+
+	//Returns a block to the pool. The block may have been allocated by a different thread.
+	static void free(void* block) noexcept;
+
+};
\ No newline at end of file
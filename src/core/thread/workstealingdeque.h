@@ -0,0 +1,183 @@
+/*
+	Work-stealing deque after Chase and Lev, "Dynamic Circular Work-Stealing Deque" (2005),
+	with the memory orderings of Le et al., "Correct and Efficient Work-Stealing for Weak Memory Models" (2013).
+*/
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <type_traits>
+
+#include "util/bits.h"
+#include "util/assert.h"
+#include "types.h"
+
+
+
+/*
+	Single-owner deque with concurrent stealing.
+	The owner thread pushes and pops at the bottom (LIFO), any other thread may steal from the top (FIFO).
+	The ring buffer grows on demand, so push never fails. Replaced buffers are retired until destruction since thieves might still read from them.
+	T must be trivially copyable since elements are read speculatively by thieves.
+*/
+template<class T>
+class WorkStealingDeque final {
+
+	static_assert(std::is_trivially_copyable_v<T>, "Deque elements must be trivially copyable");
+
+	constexpr static inline std::size_t hdiSize = std::hardware_destructive_interference_size;
+
+	class Buffer {
+
+	public:
+
+		explicit Buffer(i64 capacity) : capacity(capacity), mask(capacity - 1), data(std::make_unique<std::atomic<T>[]>(capacity)) {}
+
+		i64 getCapacity() const noexcept {
+			return capacity;
+		}
+
+		T get(i64 index) const noexcept {
+			return data[index & mask].load(std::memory_order_relaxed);
+		}
+
+		void put(i64 index, T element) noexcept {
+			data[index & mask].store(element, std::memory_order_relaxed);
+		}
+
+		//Creates a buffer of twice the size containing the elements in [top, bottom)
+		std::unique_ptr<Buffer> grow(i64 top, i64 bottom) const {
+
+			auto buffer = std::make_unique<Buffer>(capacity * 2);
+
+			for (i64 i = top; i < bottom; i++) {
+				buffer->put(i, get(i));
+			}
+
+			return buffer;
+
+		}
+
+	private:
+
+		i64 capacity;
+		i64 mask;
+		std::unique_ptr<std::atomic<T>[]> data;
+
+	};
+
+public:
+
+	explicit WorkStealingDeque(u32 initialCapacity = 256) : top(0), bottom(0) {
+
+		arc_assert(Bits::popcount(initialCapacity) == 1, "Deque capacity must be a power of two");
+
+		buffers.push_back(std::make_unique<Buffer>(initialCapacity));
+		buffer.store(buffers.back().get(), std::memory_order_relaxed);
+
+	}
+
+	WorkStealingDeque(const WorkStealingDeque& deque) = delete;
+	WorkStealingDeque& operator=(const WorkStealingDeque& deque) = delete;
+
+
+	//Owner only: Pushes an element to the bottom
+	void push(T element) {
+
+		i64 b = bottom.load(std::memory_order_relaxed);
+		i64 t = top.load(std::memory_order_acquire);
+		Buffer* a = buffer.load(std::memory_order_relaxed);
+
+		if (b - t > a->getCapacity() - 1) {
+
+			buffers.push_back(a->grow(t, b));
+			a = buffers.back().get();
+			buffer.store(a, std::memory_order_release);
+
+		}
+
+		a->put(b, element);
+		std::atomic_thread_fence(std::memory_order_release);
+		bottom.store(b + 1, std::memory_order_relaxed);
+
+	}
+
+
+	//Owner only: Pops the most recently pushed element. Returns false if the deque is empty.
+	bool pop(T& element) noexcept {
+
+		i64 b = bottom.load(std::memory_order_relaxed) - 1;
+		Buffer* a = buffer.load(std::memory_order_relaxed);
+		bottom.store(b, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		i64 t = top.load(std::memory_order_relaxed);
+
+		if (t > b) {
+
+			//Empty
+			bottom.store(b + 1, std::memory_order_relaxed);
+			return false;
+
+		}
+
+		element = a->get(b);
+
+		if (t == b) {
+
+			//Last element, race against thieves
+			bool won = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+			bottom.store(b + 1, std::memory_order_relaxed);
+
+			return won;
+
+		}
+
+		return true;
+
+	}
+
+
+	//Any thread: Steals the oldest element. Returns false if the deque is empty or the steal lost a race.
+	bool steal(T& element) noexcept {
+
+		i64 t = top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		i64 b = bottom.load(std::memory_order_acquire);
+
+		if (t >= b) {
+			return false;
+		}
+
+		Buffer* a = buffer.load(std::memory_order_acquire);
+		element = a->get(t);
+
+		return top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+
+	}
+
+
+	//Returns the approximate number of elements. The value might be outdated by the time it is returned.
+	SizeT size() const noexcept {
+
+		i64 b = bottom.load(std::memory_order_relaxed);
+		i64 t = top.load(std::memory_order_relaxed);
+
+		return b > t ? b - t : 0;
+
+	}
+
+	//Returns whether the deque is approximately empty
+	bool empty() const noexcept {
+		return size() == 0;
+	}
+
+private:
+
+	alignas(hdiSize) std::atomic<i64> top;
+	alignas(hdiSize) std::atomic<i64> bottom;
+	alignas(hdiSize) std::atomic<Buffer*> buffer;
+	std::vector<std::unique_ptr<Buffer>> buffers;
+
+};
\ No newline at end of file
@@ -340,9 +340,15 @@ void Window::setSize(u32 w, u32 h) {
 
 
 void Window::setTitle(const std::string& title) {
+	setTitle(title.c_str());
+}
+
+
+
+void Window::setTitle(const char* title) {
 
 	arc_assert(isOpen(), "Tried to set window title for non-existing window");
-	glfwSetWindowTitle(windowHandle->handle, title.c_str());
+	glfwSetWindowTitle(windowHandle->handle, title);
 
 }
 
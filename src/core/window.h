@@ -114,6 +114,7 @@ public:
 
 	void setSize(u32 w, u32 h);
 	void setTitle(const std::string& title);
+	void setTitle(const char* title);
 	void setX(u32 x);
 	void setY(u32 y);
 	void setPosition(u32 x, u32 y);
@@ -2,6 +2,7 @@
 
 #include "input/keytrigger.h"
 #include "input/inputhandler.h"
+#include "core/memory/sizeclassallocator.h"
 #include <unordered_map>
 #include <optional>
 
@@ -18,8 +19,8 @@ class InputContext {
 		inline State(bool disablePropagation = false) : disablePropagation(disablePropagation) {}
 
 		bool disablePropagation;
-		std::unordered_multimap<Key, KeyAction> keyLookup;
-		std::vector<KeyAction> coActions;
+		SizeClassMultimap<Key, KeyAction> keyLookup;
+		SizeClassVector<KeyAction> coActions;
 
 	};
 
@@ -82,8 +83,8 @@ private:
 	bool enabled;
 	u32 currentState;
 	InputHandler* handler;
-	std::unordered_map<u32, State> inputStates;
-	std::unordered_map<KeyAction, std::pair<KeyTrigger, bool>> actionBindings;
-	std::unordered_map<KeyAction, KeyTrigger> defaultBindings;
+	SizeClassMap<u32, State> inputStates;
+	SizeClassMap<KeyAction, std::pair<KeyTrigger, bool>> actionBindings;
+	SizeClassMap<KeyAction, KeyTrigger> defaultBindings;
 
 };
\ No newline at end of file
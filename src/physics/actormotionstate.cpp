@@ -0,0 +1,64 @@
+#include "actormotionstate.h"
+
+
+ActorMotionState::ActorMotionState(const btTransform& transform, ActorID actor, DirtyList& dirtyList) : transform(transform), dirtyList(&dirtyList), actor(actor), dirtyIndex(CleanIndex) {}
+
+ActorMotionState::~ActorMotionState() {
+
+	if (!isDirty()) {
+		return;
+	}
+
+	//Swap the last entry into the freed position so the list stays compact
+	ActorMotionState* last = dirtyList->back();
+	(*dirtyList)[dirtyIndex] = last;
+	last->dirtyIndex = dirtyIndex;
+
+	dirtyList->pop_back();
+
+}
+
+
+
+void ActorMotionState::getWorldTransform(btTransform& worldTransform) const {
+	worldTransform = transform;
+}
+
+
+
+void ActorMotionState::setWorldTransform(const btTransform& worldTransform) {
+
+	transform = worldTransform;
+
+	if (!isDirty()) {
+
+		dirtyIndex = static_cast<u32>(dirtyList->size());
+		dirtyList->push_back(this);
+
+	}
+
+}
+
+
+
+void ActorMotionState::clean() noexcept {
+	dirtyIndex = CleanIndex;
+}
+
+
+
+bool ActorMotionState::isDirty() const noexcept {
+	return dirtyIndex != CleanIndex;
+}
+
+
+
+ActorID ActorMotionState::getActor() const noexcept {
+	return actor;
+}
+
+
+
+const btTransform& ActorMotionState::getTransform() const noexcept {
+	return transform;
+}
\ No newline at end of file
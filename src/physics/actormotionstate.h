@@ -0,0 +1,54 @@
+#pragma once
+
+#include "core/acs/actor.h"
+#include "types.h"
+
+#include "LinearMath/btMotionState.h"
+#include "LinearMath/btTransform.h"
+
+#include <vector>
+
+
+/*
+	Motion state binding a rigid body to its actor.
+	Bullet calls setWorldTransform only for bodies that moved during a step, so the state appends itself to a shared dirty list at that point.
+	Sleeping bodies never enter the list and cost nothing during synchronization.
+	The dirty list is not synchronized, motion states must be updated from one thread at a time.
+*/
+class ActorMotionState : public btMotionState {
+
+public:
+
+	BT_DECLARE_ALIGNED_ALLOCATOR();
+
+	using DirtyList = std::vector<ActorMotionState*>;
+
+	constexpr static ActorID NoActor = -1;
+
+
+	ActorMotionState(const btTransform& transform, ActorID actor, DirtyList& dirtyList);
+	~ActorMotionState() override;
+
+	ActorMotionState(const ActorMotionState& state) = delete;
+	ActorMotionState& operator=(const ActorMotionState& state) = delete;
+
+	void getWorldTransform(btTransform& worldTransform) const override;
+	void setWorldTransform(const btTransform& worldTransform) override;
+
+	//Removes the dirty mark. The owner of the dirty list clears the list afterwards.
+	void clean() noexcept;
+
+	bool isDirty() const noexcept;
+	ActorID getActor() const noexcept;
+	const btTransform& getTransform() const noexcept;
+
+private:
+
+	constexpr static u32 CleanIndex = -1;
+
+	btTransform transform;
+	DirtyList* dirtyList;
+	ActorID actor;
+	u32 dirtyIndex;
+
+};
\ No newline at end of file
@@ -1,7 +1,9 @@
 #pragma once
 
 #include "LinearMath/btVector3.h"
+#include "LinearMath/btQuaternion.h"
 #include "util/vector.h"
+#include "util/quaternion.h"
 
 
 namespace Bullet {
@@ -14,4 +16,12 @@ namespace Bullet {
         return btVector3(v.x, v.y, v.z);
     }
 
+    inline Quatx fromBtQuaternion(const btQuaternion& q) {
+        return Quatx(q.x(), q.y(), q.z(), q.w());
+    }
+
+    inline btQuaternion fromQuatx(const Quatx& q) {
+        return btQuaternion(q.x, q.y, q.z, q.w);
+    }
+
 }
\ No newline at end of file
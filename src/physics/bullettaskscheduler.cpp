@@ -0,0 +1,62 @@
+#include "bullettaskscheduler.h"
+#include "core/thread/taskexecutor.h"
+#include "util/math.h"
+#include "util/assert.h"
+
+#include <atomic>
+
+
+BulletTaskScheduler::BulletTaskScheduler(TaskExecutor& executor) : btITaskScheduler("Arclight"), executor(executor) {
+	arc_assert(executor.getThreadCount() + externalThreads <= BT_MAX_THREAD_COUNT, "Bullet supports at most %d threads", BT_MAX_THREAD_COUNT);
+}
+
+
+
+int BulletTaskScheduler::getMaxNumThreads() const {
+
+	//Every thread with a Bullet thread index needs its own slot, the highest index being the last worker's
+	return Math::min<int, int>(executor.getThreadCount() + externalThreads, BT_MAX_THREAD_COUNT);
+
+}
+
+
+
+int BulletTaskScheduler::getNumThreads() const {
+	return getMaxNumThreads();
+}
+
+
+
+void BulletTaskScheduler::setNumThreads(int numThreads) {}
+
+
+
+void BulletTaskScheduler::parallelFor(int begin, int end, int grainSize, const btIParallelForBody& body) {
+
+	if (begin >= end) {
+		return;
+	}
+
+	executor.parallelFor(end - begin, grainSize, [begin, &body](SizeT start, SizeT stop) {
+		body.forLoop(begin + static_cast<int>(start), begin + static_cast<int>(stop));
+	});
+
+}
+
+
+
+btScalar BulletTaskScheduler::parallelSum(int begin, int end, int grainSize, const btIParallelSumBody& body) {
+
+	if (begin >= end) {
+		return 0;
+	}
+
+	std::atomic<btScalar> sum = 0;
+
+	executor.parallelFor(end - begin, grainSize, [begin, &body, &sum](SizeT start, SizeT stop) {
+		sum.fetch_add(body.sumLoop(begin + static_cast<int>(start), begin + static_cast<int>(stop)), std::memory_order_relaxed);
+	});
+
+	return sum.load(std::memory_order_relaxed);
+
+}
\ No newline at end of file
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "LinearMath/btThreads.h"
+
+
+class TaskExecutor;
+
+/*
+	Bullet task scheduler running parallel loops on the engine's TaskExecutor.
+	Physics therefore shares the engine's worker threads instead of spawning its own.
+	The thread count is owned by the executor, requests by Bullet to change it are ignored.
+
+	Bullet hands out a thread index to every thread that enters it and sizes its per-thread storage by getNumThreads().
+	Only the following threads may therefore call into Bullet:
+	 - the thread installing the scheduler, which receives index 0 (PhysicsEngine::init)
+	 - the simulation thread stepping the world and joining its parallel loops
+	 - the executor's worker threads
+*/
+class BulletTaskScheduler : public btITaskScheduler {
+
+public:
+
+	explicit BulletTaskScheduler(TaskExecutor& executor);
+
+	int getMaxNumThreads() const override;
+	int getNumThreads() const override;
+	void setNumThreads(int numThreads) override;
+
+	void parallelFor(int begin, int end, int grainSize, const btIParallelForBody& body) override;
+	btScalar parallelSum(int begin, int end, int grainSize, const btIParallelSumBody& body) override;
+
+private:
+
+	//The installing thread and the simulation thread in addition to the workers
+	constexpr static int externalThreads = 2;
+
+	TaskExecutor& executor;
+
+};
\ No newline at end of file
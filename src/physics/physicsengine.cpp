@@ -1,22 +1,63 @@
 #include "physicsengine.h"
+#include "actormotionstate.h"
 #include "bulletconv.h"
 #include "core/acs/actormanager.h"
+#include "core/thread/taskexecutor.h"
 #include "util/log.h"
+#include "util/assert.h"
+#include "arcconfig.h"
 #include "types.h"
 
 #include "btBulletDynamicsCommon.h"
 
+#ifdef ARC_PHYSICS_MULTITHREADED
+#include "bullettaskscheduler.h"
+#include "BulletCollision/CollisionDispatch/btCollisionDispatcherMt.h"
+#include "BulletDynamics/ConstraintSolver/btSequentialImpulseConstraintSolverMt.h"
+#include "BulletDynamics/Dynamics/btDiscreteDynamicsWorldMt.h"
+#endif
 
-PhysicsEngine::PhysicsEngine(ActorManager& actorManager) : collisionConfiguration(nullptr), dispatcher(nullptr), overlappingPairCache(nullptr), solver(nullptr), dynamicsWorld(nullptr), actorManager(actorManager) {}
+
+PhysicsEngine::PhysicsEngine(ActorManager& actorManager, TaskExecutor& executor) : collisionConfiguration(nullptr), dispatcher(nullptr), overlappingPairCache(nullptr), solver(nullptr), solverPool(nullptr), dynamicsWorld(nullptr), taskScheduler(nullptr), actorManager(actorManager), executor(executor), tps(1) {}
 
 PhysicsEngine::~PhysicsEngine() {
 
-	if (dynamicsWorld) {delete dynamicsWorld;}
+	if (dynamicsWorld) {
+
+		//Bodies still in the world are owned by the engine, e.g. the ground
+		btCollisionObjectArray& objects = dynamicsWorld->getCollisionObjectArray();
+
+		for (i32 i = objects.size() - 1; i >= 0; i--) {
+
+			btRigidBody* body = btRigidBody::upcast(objects[i]);
+			dynamicsWorld->removeCollisionObject(objects[i]);
+
+			if (body) {
+				resources.destroyBody(body);
+			}
+
+		}
+
+		delete dynamicsWorld;
+
+	}
+
 	if (collisionConfiguration) {delete collisionConfiguration;}
 	if (dispatcher) {delete dispatcher;}
 	if (overlappingPairCache) {delete overlappingPairCache;}
 	if (solver) {delete solver;}
 
+#ifdef ARC_PHYSICS_MULTITHREADED
+	if (solverPool) {delete solverPool;}
+
+	if (taskScheduler) {
+
+		btSetTaskScheduler(nullptr);
+		delete taskScheduler;
+
+	}
+#endif
+
 }
 
 
@@ -28,38 +69,38 @@ void PhysicsEngine::init(u32 ticksPerSecond) {
 	///collision configuration contains default setup for memory, collision setup. Advanced users can create their own configuration.
 	collisionConfiguration = new btDefaultCollisionConfiguration();
 
-	///use the default collision dispatcher. For parallel processing you can use a diffent dispatcher (see Extras/BulletMultiThreaded)
-	dispatcher = new btCollisionDispatcher(collisionConfiguration);
-
 	///btDbvtBroadphase is a good general purpose broadphase. You can also try out btAxis3Sweep.
 	overlappingPairCache = new btDbvtBroadphase();
 
-	///the default constraint solver. For parallel processing you can use a different solver (see Extras/BulletMultiThreaded)
-	solver = new btSequentialImpulseConstraintSolver;
+#ifdef ARC_PHYSICS_MULTITHREADED
+	//Bullet's parallel loops are scheduled on our own worker threads
+	taskScheduler = new BulletTaskScheduler(executor);
+	btSetTaskScheduler(taskScheduler);
 
-	dynamicsWorld = new btDiscreteDynamicsWorld(dispatcher, overlappingPairCache, solver, collisionConfiguration);
-	dynamicsWorld->setGravity(btVector3(0, -10, 0));
+	dispatcher = new btCollisionDispatcherMt(collisionConfiguration, dispatchGrainSize);
 
-	{ 
-		btCollisionShape* groundShape = new btBoxShape(btVector3(btScalar(50.), btScalar(50.), btScalar(50.)));
+	//Islands are solved in parallel by a pool holding one solver per thread
+	solverPool = new btConstraintSolverPoolMt(taskScheduler->getNumThreads());
+	solver = new btSequentialImpulseConstraintSolverMt;
 
-		btTransform groundTransform;
-		groundTransform.setIdentity();
-		groundTransform.setOrigin(btVector3(0, -56, 0));
+	dynamicsWorld = new btDiscreteDynamicsWorldMt(dispatcher, overlappingPairCache, solverPool, solver, collisionConfiguration);
 
-		btScalar mass(0.);
+	Log::info("Physics Engine", "Using the multithreaded dynamics world with %d threads", taskScheduler->getNumThreads());
+#else
+	///use the default collision dispatcher. For parallel processing, enable ARC_PHYSICS_MULTITHREADED
+	dispatcher = new btCollisionDispatcher(collisionConfiguration);
 
-		//rigidbody is dynamic if and only if mass is non zero, otherwise static
-		bool isDynamic = (mass != 0.f);
+	///the default constraint solver. For parallel processing, enable ARC_PHYSICS_MULTITHREADED
+	solver = new btSequentialImpulseConstraintSolver;
 
-		btVector3 localInertia(0, 0, 0);
-		if (isDynamic)
-			groundShape->calculateLocalInertia(mass, localInertia);
+	dynamicsWorld = new btDiscreteDynamicsWorld(dispatcher, overlappingPairCache, solver, collisionConfiguration);
+#endif
+
+	dynamicsWorld->setGravity(btVector3(0, -10, 0));
 
-		//using motionstate is optional, it provides interpolation capabilities, and only synchronizes 'active' objects
-		btDefaultMotionState* myMotionState = new btDefaultMotionState(groundTransform);
-		btRigidBody::btRigidBodyConstructionInfo rbInfo(mass, myMotionState, groundShape, localInertia);
-		btRigidBody* body = new btRigidBody(rbInfo);
+	{ 
+		//The ground is static, hence its mass is zero
+		btRigidBody* body = resources.createBody(resources.acquireBoxShape(Vec3x(50)), 0, Vec3x(0, -56, 0), ActorMotionState::NoActor);
 		body->setRestitution(0.9);
 
 		//add the body to the dynamics world
@@ -68,39 +109,52 @@ void PhysicsEngine::init(u32 ticksPerSecond) {
 	}
 
 	tps = ticksPerSecond;
-	simTimer.start();
 
 }
 
 
 
-void PhysicsEngine::update() {
+void PhysicsEngine::simulate() {
 
 	profiler.start();
 
-	double dt = simTimer.getElapsedTime(Time::Unit::Seconds);
-	dynamicsWorld->stepSimulation(dt, 1, 1.0 / tps);
-	
-	simTimer.start();
+	//The caller provides the fixed timestep, so disable Bullet's internal substepping and motion state interpolation
+	dynamicsWorld->stepSimulation(1.0 / tps, 0);
 
 	profiler.stop("PhysicsSim");
 
+}
+
+
+
+void PhysicsEngine::sync() {
+
 	profiler.start();
-	ComponentView view = actorManager.view<Transform, BoxCollider>();
 
-	for(auto [transform, collider] : view) {
+	//Only bodies moved by the last step have reported a new transform
+	std::span<ActorMotionState* const> states = resources.getDirtyStates();
+	ComponentProvider& provider = actorManager.getProvider();
 
-		btRigidBody* body = static_cast<btRigidBody*>(collider.handle);
-		btTransform rbtransform;
-		body->getMotionState()->getWorldTransform(rbtransform);
+	changedActors.resize(states.size());
 
-		transform.position = Bullet::fromBtVector3(rbtransform.getOrigin());
+	executor.parallelFor(states.size(), syncGrainSize, [this, states, &provider](SizeT start, SizeT end) {
 
-		btScalar rx, ry, rz;
-		rbtransform.getRotation().getEulerZYX(rz, ry, rx);
-		transform.rotation = Vec3x(rx, ry, rz);
+		for (SizeT i = start; i < end; i++) {
 
-	}
+			const ActorMotionState& state = *states[i];
+			const btTransform& bodyTransform = state.getTransform();
+			Transform& transform = provider.getComponent<Transform>(state.getActor());
+
+			transform.position = Bullet::fromBtVector3(bodyTransform.getOrigin());
+			transform.rotation = Bullet::fromBtQuaternion(bodyTransform.getRotation());
+
+			changedActors[i] = state.getActor();
+
+		}
+
+	});
+
+	resources.cleanStates();
 
 	profiler.stop("PhysicSync");
 
@@ -108,35 +162,35 @@ void PhysicsEngine::update() {
 
 
 
-void PhysicsEngine::onBoxCreated(BoxCollider& collider, ActorID actor) {
+void PhysicsEngine::addBodies(std::span<const ActorID> actors) {
 
-	const Transform& transform = actorManager.getProvider().getComponent<Transform>(actor);
-	btCollisionShape* box = new btBoxShape(Bullet::fromVec3x(collider.size / 2.0));
+	ComponentProvider& provider = actorManager.getProvider();
 
-	btTransform groundTransform;
-	groundTransform.setIdentity();
-	groundTransform.setOrigin(Bullet::fromVec3x(transform.position));
+	//Grow the world's object array once for the whole batch
+	btCollisionObjectArray& objects = dynamicsWorld->getCollisionObjectArray();
+	objects.reserve(objects.size() + static_cast<i32>(actors.size()));
 
-	btScalar mass(1.0f);
-	bool isDynamic = (mass != 0.f);
+	for (ActorID actor : actors) {
 
-	btVector3 localInertia(0, 0, 0);
+		BoxCollider& collider = provider.getComponent<BoxCollider>(actor);
+		const Transform& transform = provider.getComponent<Transform>(actor);
+
+		btRigidBody* body = resources.createBody(resources.acquireBoxShape(collider.size / 2.0), boxMass, transform.position, actor);
+		body->setRestitution(2);
+		body->setDamping(0, 0);
+		body->setFriction(0);
+
+		dynamicsWorld->addRigidBody(body);
+		collider.handle = body;
 
-	if (isDynamic) {
-		box->calculateLocalInertia(mass, localInertia);
 	}
 
-	btDefaultMotionState* myMotionState = new btDefaultMotionState(groundTransform);
-	btRigidBody::btRigidBodyConstructionInfo rbInfo(mass, myMotionState, box, localInertia);
-	btRigidBody* body = new btRigidBody(rbInfo);
-	body->setRestitution(2);
-	body->setDamping(0, 0);
-	body->setFriction(0);
-	//body->applyCentralImpulse(btVector3(0, -200, 0));
+}
 
-	dynamicsWorld->addRigidBody(body);
-	collider.handle = body;
 
+
+std::span<const ActorID> PhysicsEngine::getChangedActors() const noexcept {
+	return changedActors;
 }
 
 
@@ -145,10 +199,167 @@ void PhysicsEngine::onBoxDestroyed(BoxCollider& collider, ActorID actor) {
 
 	btRigidBody* body = static_cast<btRigidBody*>(collider.handle);
 
-	delete body->getCollisionShape();
-	delete body->getMotionState();
-	delete body;
+	dynamicsWorld->removeRigidBody(body);
+	resources.destroyBody(body);
+
+	collider.handle = nullptr;
+
+}
+
+
+
+void PhysicsEngine::submitQuery(QueryFunction&& query) {
+
+	std::lock_guard lock(queryMutex);
+	submittedQueries.push_back(std::move(query));
+
+}
+
+
+
+void PhysicsEngine::runQueries() {
+
+	{
+		//Queries may submit follow-ups, which then run after the next step
+		std::lock_guard lock(queryMutex);
+		runningQueries.swap(submittedQueries);
+	}
+
+	for (const QueryFunction& query : runningQueries) {
+		query(*this);
+	}
+
+	runningQueries.clear();
+
+}
+
+
+
+RayHit PhysicsEngine::raycast(const Ray& ray) const {
+
+	btVector3 start = Bullet::fromVec3x(ray.start);
+	btVector3 end = Bullet::fromVec3x(ray.end);
+
+	btCollisionWorld::ClosestRayResultCallback callback(start, end);
+	dynamicsWorld->rayTest(start, end, callback);
+
+	RayHit hit;
+
+	if (callback.hasHit()) {
+
+		hit.actor = PhysicsResources::getActor(callback.m_collisionObject);
+		hit.point = Bullet::fromBtVector3(callback.m_hitPointWorld);
+		hit.normal = Bullet::fromBtVector3(callback.m_hitNormalWorld);
+		hit.fraction = callback.m_closestHitFraction;
+		hit.hit = true;
+
+	}
+
+	return hit;
+
+}
+
+
+
+void PhysicsEngine::raycastBatch(std::span<const Ray> rays, std::span<RayHit> hits) const {
+
+	arc_assert(hits.size() >= rays.size(), "Raycast batch of %zu rays cannot store its hits in %zu slots", rays.size(), hits.size());
+
+#ifdef ARC_PHYSICS_MULTITHREADED
+	//Thread-safe Bullet keeps one broadphase traversal stack per thread, so concurrent ray tests only read the shared tree
+	executor.parallelFor(rays.size(), raycastGrainSize, [this, rays, hits](SizeT start, SizeT end) {
+
+		for (SizeT i = start; i < end; i++) {
+			hits[i] = raycast(rays[i]);
+		}
+
+	});
+#else
+	//Without BT_THREADSAFE the broadphase shares a single traversal stack between all ray tests
+	for (SizeT i = 0; i < rays.size(); i++) {
+		hits[i] = raycast(rays[i]);
+	}
+#endif
+
+}
+
+
+
+void PhysicsEngine::sphereOverlap(const Vec3x& center, double radius, std::vector<ActorID>& actors) const {
+
+	struct OverlapCallback : public btCollisionWorld::ContactResultCallback {
+
+		OverlapCallback(const btCollisionObject* query, std::vector<ActorID>& actors) : query(query), last(nullptr), actors(actors) {}
+
+		btScalar addSingleResult(btManifoldPoint& cp, const btCollisionObjectWrapper* colObj0Wrap, int partId0, int index0, const btCollisionObjectWrapper* colObj1Wrap, int partId1, int index1) override {
+
+			const btCollisionObject* object = colObj0Wrap->getCollisionObject();
+
+			if (object == query) {
+				object = colObj1Wrap->getCollisionObject();
+			}
+
+			//Contact points of one body are reported consecutively
+			if (object != last) {
+
+				last = object;
+
+				ActorID actor = PhysicsResources::getActor(object);
+
+				if (actor != ActorMotionState::NoActor) {
+					actors.push_back(actor);
+				}
+
+			}
+
+			return 0;
+
+		}
+
+		const btCollisionObject* query;
+		const btCollisionObject* last;
+		std::vector<ActorID>& actors;
+
+	};
+
+	//The query object is never added to the world, so the broadphase stays untouched
+	btSphereShape shape(radius);
+	btCollisionObject sphere;
+	sphere.setCollisionShape(&shape);
+	sphere.getWorldTransform().setOrigin(Bullet::fromVec3x(center));
+
+	OverlapCallback callback(&sphere, actors);
+	dynamicsWorld->contactTest(&sphere, callback);
+
+}
+
+
+
+RayHit PhysicsEngine::sweep(const Ray& path, double radius) const {
+
+	btSphereShape shape(radius);
+
+	btTransform start, end;
+	start.setIdentity();
+	end.setIdentity();
+	start.setOrigin(Bullet::fromVec3x(path.start));
+	end.setOrigin(Bullet::fromVec3x(path.end));
+
+	btCollisionWorld::ClosestConvexResultCallback callback(start.getOrigin(), end.getOrigin());
+	dynamicsWorld->convexSweepTest(&shape, start, end, callback);
+
+	RayHit hit;
+
+	if (callback.hasHit()) {
+
+		hit.actor = PhysicsResources::getActor(callback.m_hitCollisionObject);
+		hit.point = Bullet::fromBtVector3(callback.m_hitPointWorld);
+		hit.normal = Bullet::fromBtVector3(callback.m_hitNormalWorld);
+		hit.fraction = callback.m_closestHitFraction;
+		hit.hit = true;
+
+	}
 
-	body = nullptr;
+	return hit;
 
 }
\ No newline at end of file
@@ -1,43 +1,105 @@
 #pragma once
 
+#include "physicsresources.h"
+#include "physicsquery.h"
 #include "core/acs/component/boxcollider.h"
 #include "core/acs/actor.h"
 #include "util/profiler.h"
 #include "types.h"
 
+#include <functional>
+#include <mutex>
+#include <span>
+#include <vector>
+
 
 class ActorManager;
+class TaskExecutor;
+class BulletTaskScheduler;
 class btDefaultCollisionConfiguration;
 class btCollisionDispatcher;
 class btBroadphaseInterface;
-class btSequentialImpulseConstraintSolver;
+class btConstraintSolver;
+class btConstraintSolverPoolMt;
 class btDiscreteDynamicsWorld;
+class PhysicsEngine;
+
+typedef std::function<void(const PhysicsEngine&)> QueryFunction;
 
 class PhysicsEngine {
 
 public:
 
-	explicit PhysicsEngine(ActorManager& actorManager);
+	PhysicsEngine(ActorManager& actorManager, TaskExecutor& executor);
 	~PhysicsEngine();
 
 	void init(u32 ticksPerSecond);
-	void update();
 
-	void onBoxCreated(BoxCollider& collider, ActorID actor);
+	//Advances the dynamics world by one fixed tick of 1 / ticksPerSecond seconds
+	void simulate();
+
+	//Writes the transforms of the bodies moved by the last step back to their actors
+	void sync();
+
+	//Returns the actors whose transforms have been written by the last sync. Only valid on the simulating thread until the next sync.
+	std::span<const ActorID> getChangedActors() const noexcept;
+
+	//Creates the bodies of all given box collider actors and adds them to the world in one pass
+	void addBodies(std::span<const ActorID> actors);
+
 	void onBoxDestroyed(BoxCollider& collider, ActorID actor);
 
+	/*
+		Scene queries
+		Queries read the world and therefore must not overlap with simulate() or any change of the bodies.
+		While the simulation thread is running, they may only be issued from a function passed to submitQuery(). Outside of it, e.g. during setup, they may be called directly.
+		A lock around the step is not an option: Threads waiting for Bullet's parallel loops execute other tasks meanwhile, which could then block on the step they are part of.
+	*/
+
+	//Queues query to run on the simulation thread after the next step. Results are delivered through the function itself. Thread-safe.
+	void submitQuery(QueryFunction&& query);
+
+	//Runs all submitted queries against the state of the last step. Called by the simulation thread between two steps.
+	void runQueries();
+
+	//Returns the closest body hit by ray
+	RayHit raycast(const Ray& ray) const;
+
+	//Casts all rays and stores the closest hit of rays[i] in hits[i]. Rays are distributed over the executor's workers if the world is multithreaded.
+	void raycastBatch(std::span<const Ray> rays, std::span<RayHit> hits) const;
+
+	//Appends the actors of all bodies touching the sphere to actors. Bodies without an actor are skipped.
+	void sphereOverlap(const Vec3x& center, double radius, std::vector<ActorID>& actors) const;
+
+	//Moves a sphere of the given radius along path and returns the first body it touches
+	RayHit sweep(const Ray& path, double radius) const;
+
 private:
 
 	btDefaultCollisionConfiguration* collisionConfiguration;
 	btCollisionDispatcher* dispatcher;
 	btBroadphaseInterface* overlappingPairCache;
-	btSequentialImpulseConstraintSolver* solver;
+	btConstraintSolver* solver;
+	btConstraintSolverPoolMt* solverPool;
 	btDiscreteDynamicsWorld* dynamicsWorld;
+	BulletTaskScheduler* taskScheduler;
+
+	PhysicsResources resources;
+	std::vector<ActorID> changedActors;
+
+	std::mutex queryMutex;
+	std::vector<QueryFunction> submittedQueries;
+	std::vector<QueryFunction> runningQueries;
 
 	ActorManager& actorManager;
+	TaskExecutor& executor;
 	
 	Profiler profiler;
-	Timer simTimer;
 	u32 tps;
 
+	constexpr static SizeT syncGrainSize = 512;
+	constexpr static double boxMass = 1.0;
+	constexpr static int dispatchGrainSize = 40;
+	constexpr static SizeT raycastGrainSize = 64;
+
 };
\ No newline at end of file
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "core/acs/actor.h"
+#include "util/vector.h"
+#include "types.h"
+
+
+/*
+	Line segment from start to end used by raycasts and sweeps
+*/
+struct Ray {
+
+	constexpr Ray() = default;
+	constexpr Ray(const Vec3x& start, const Vec3x& end) : start(start), end(end) {}
+
+	Vec3x start;
+	Vec3x end;
+
+};
+
+
+/*
+	Closest hit of a ray or sweep query.
+	Bodies that do not belong to an actor (e.g. the ground) report ActorMotionState::NoActor.
+	fraction is the relative distance along the ray in [0, 1] and 1 if nothing has been hit.
+*/
+struct RayHit {
+
+	constexpr RayHit() : actor(-1), fraction(1), hit(false) {}
+
+	ActorID actor;
+	Vec3x point;
+	Vec3x normal;
+	ARC_STD_FLOAT_TYPE fraction;
+	bool hit;
+
+};
\ No newline at end of file
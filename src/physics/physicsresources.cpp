@@ -0,0 +1,185 @@
+#include "physicsresources.h"
+#include "actormotionstate.h"
+#include "bulletconv.h"
+#include "util/assert.h"
+
+#include "btBulletDynamicsCommon.h"
+
+#include <functional>
+#include <new>
+
+
+PhysicsResources::PhysicsResources() : bodyCount(0) {
+
+	bodyPool.create<btRigidBody>(bodyChunkBlocks);
+	motionStatePool.create<ActorMotionState>(bodyChunkBlocks);
+
+}
+
+PhysicsResources::~PhysicsResources() {
+
+	arc_assert(bodyCount == 0, "%zu physics bodies have not been destroyed", bodyCount);
+
+	for (auto& [halfExtents, entry] : boxShapes) {
+		delete entry.shape;
+	}
+
+}
+
+
+
+btCollisionShape* PhysicsResources::acquireBoxShape(const Vec3x& halfExtents) {
+
+	auto [it, inserted] = boxShapes.try_emplace(halfExtents, ShapeEntry{ nullptr, 0 });
+	ShapeEntry& entry = it->second;
+
+	if (inserted) {
+
+		try {
+			entry.shape = new btBoxShape(Bullet::fromVec3x(halfExtents));
+		} catch (...) {
+			boxShapes.erase(it);
+			throw;
+		}
+
+		//Map nodes are stable, so the shape can refer back to its entry
+		entry.shape->setUserPointer(&*it);
+
+	}
+
+	entry.references++;
+
+	return entry.shape;
+
+}
+
+
+
+void PhysicsResources::releaseShape(btCollisionShape* shape) {
+
+	auto node = static_cast<ShapeMap::value_type*>(shape->getUserPointer());
+
+	if (--node->second.references == 0) {
+
+		delete shape;
+		boxShapes.erase(node->first);
+
+	}
+
+}
+
+
+
+btRigidBody* PhysicsResources::createBody(btCollisionShape* shape, double mass, const Vec3x& position, ActorID actor) {
+
+	btTransform transform;
+	transform.setIdentity();
+	transform.setOrigin(Bullet::fromVec3x(position));
+
+	//Bodies are dynamic if and only if their mass is non-zero
+	btVector3 localInertia(0, 0, 0);
+
+	if (mass != 0) {
+		shape->calculateLocalInertia(mass, localInertia);
+	}
+
+	void* motionStateBlock = motionStatePool.allocate();
+	ActorMotionState* motionState = ::new(motionStateBlock) ActorMotionState(transform, actor, dirtyStates);
+
+	btRigidBody* body;
+
+	try {
+
+		btRigidBody::btRigidBodyConstructionInfo info(mass, motionState, shape, localInertia);
+		body = ::new(bodyPool.allocate()) btRigidBody(info);
+
+	} catch (...) {
+
+		motionState->~ActorMotionState();
+		motionStatePool.deallocate(motionStateBlock);
+		throw;
+
+	}
+
+	body->setUserPointer(motionState);
+	bodyCount++;
+
+	return body;
+
+}
+
+
+
+void PhysicsResources::destroyBody(btRigidBody* body) {
+
+	btMotionState* motionState = body->getMotionState();
+	btCollisionShape* shape = body->getCollisionShape();
+
+	body->~btRigidBody();
+	bodyPool.deallocate(body);
+
+	if (motionState) {
+
+		motionState->~btMotionState();
+		motionStatePool.deallocate(motionState);
+
+	}
+
+	releaseShape(shape);
+	bodyCount--;
+
+}
+
+
+
+std::span<ActorMotionState* const> PhysicsResources::getDirtyStates() const noexcept {
+	return dirtyStates;
+}
+
+
+
+void PhysicsResources::cleanStates() noexcept {
+
+	for (ActorMotionState* state : dirtyStates) {
+		state->clean();
+	}
+
+	dirtyStates.clear();
+
+}
+
+
+
+ActorID PhysicsResources::getActor(const btCollisionObject* object) noexcept {
+
+	auto motionState = static_cast<const ActorMotionState*>(object->getUserPointer());
+	return motionState ? motionState->getActor() : ActorMotionState::NoActor;
+
+}
+
+
+
+SizeT PhysicsResources::getShapeCount() const noexcept {
+	return boxShapes.size();
+}
+
+
+
+SizeT PhysicsResources::getBodyCount() const noexcept {
+	return bodyCount;
+}
+
+
+
+SizeT PhysicsResources::ShapeKeyHash::operator()(const Vec3x& halfExtents) const noexcept {
+
+	using Scalar = decltype(halfExtents.x);
+	std::hash<Scalar> hash;
+
+	SizeT seed = hash(halfExtents.x);
+	seed ^= hash(halfExtents.y) + 0x9E3779B9 + (seed << 6) + (seed >> 2);
+	seed ^= hash(halfExtents.z) + 0x9E3779B9 + (seed << 6) + (seed >> 2);
+
+	return seed;
+
+}
\ No newline at end of file
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "core/memory/chunkallocator.h"
+#include "core/acs/actor.h"
+#include "util/vector.h"
+#include "types.h"
+
+#include <span>
+#include <vector>
+#include <unordered_map>
+
+
+class ActorMotionState;
+class btCollisionObject;
+class btCollisionShape;
+class btRigidBody;
+
+/*
+	Owns the Bullet objects backing physics bodies.
+	Box shapes are shared between all bodies of equal size and reference counted, so identical boxes do not duplicate their shape.
+	Rigid bodies and their motion states are placed into chunk pools instead of being allocated one by one.
+	Motion states of bodies moved by the simulation are collected in a dirty list until the next call to cleanStates().
+	Each body's user pointer refers to its motion state so query results can be mapped back to actors.
+*/
+class PhysicsResources {
+
+public:
+
+	PhysicsResources();
+	~PhysicsResources();
+
+	PhysicsResources(const PhysicsResources& resources) = delete;
+	PhysicsResources& operator=(const PhysicsResources& resources) = delete;
+
+	//Returns the box shape with the given half extents, creating it if it does not exist yet. Adds a reference to the shape.
+	btCollisionShape* acquireBoxShape(const Vec3x& halfExtents);
+
+	//Drops a reference to the shape and destroys it once it is unreferenced
+	void releaseShape(btCollisionShape* shape);
+
+	//Creates a pooled rigid body for actor with a pooled motion state at position. The body takes over the caller's shape reference.
+	btRigidBody* createBody(btCollisionShape* shape, double mass, const Vec3x& position, ActorID actor);
+
+	//Destroys a body created by createBody and releases its motion state and shape. The body must not be part of a world anymore.
+	void destroyBody(btRigidBody* body);
+
+	//Returns the motion states whose transforms changed since the last call to cleanStates()
+	std::span<ActorMotionState* const> getDirtyStates() const noexcept;
+
+	//Marks all dirty motion states as clean
+	void cleanStates() noexcept;
+
+	//Returns the actor owning the body object or ActorMotionState::NoActor if the object has not been created by createBody
+	static ActorID getActor(const btCollisionObject* object) noexcept;
+
+	SizeT getShapeCount() const noexcept;
+	SizeT getBodyCount() const noexcept;
+
+private:
+
+	struct ShapeKeyHash {
+		SizeT operator()(const Vec3x& halfExtents) const noexcept;
+	};
+
+	struct ShapeEntry {
+		btCollisionShape* shape;
+		u32 references;
+	};
+
+	using ShapeMap = std::unordered_map<Vec3x, ShapeEntry, ShapeKeyHash>;
+
+	ShapeMap boxShapes;
+	ChunkAllocator bodyPool;
+	ChunkAllocator motionStatePool;
+	std::vector<ActorMotionState*> dirtyStates;
+	SizeT bodyCount;
+
+	constexpr static AddressT bodyChunkBlocks = 256;
+
+};
\ No newline at end of file
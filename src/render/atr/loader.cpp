@@ -362,26 +362,36 @@ namespace Loader {
 
 
 
-	void loadNode(const aiNode* sceneNode, ModelNode& node, const Mat4f& transform) {
+	void loadNode(const aiNode* sceneNode, NodeGraph& graph, u32 parent) {
 
 		aiMatrix4x4 sceneTransform = sceneNode->mTransformation;
-		Mat4f thisTransform(sceneTransform[0][0], sceneTransform[0][1], sceneTransform[0][2], sceneTransform[0][3],
-							sceneTransform[1][0], sceneTransform[1][1], sceneTransform[1][2], sceneTransform[1][3],
-							sceneTransform[2][0], sceneTransform[2][1], sceneTransform[2][2], sceneTransform[2][3],
-							sceneTransform[3][0], sceneTransform[3][1], sceneTransform[3][2], sceneTransform[3][3]);
+		Mat4f localTransform(sceneTransform[0][0], sceneTransform[0][1], sceneTransform[0][2], sceneTransform[0][3],
+							 sceneTransform[1][0], sceneTransform[1][1], sceneTransform[1][2], sceneTransform[1][3],
+							 sceneTransform[2][0], sceneTransform[2][1], sceneTransform[2][2], sceneTransform[2][3],
+							 sceneTransform[3][0], sceneTransform[3][1], sceneTransform[3][2], sceneTransform[3][3]);
 
-		node.baseTransform = thisTransform * transform;
-		node.visible = true;
-		node.meshIndices.resize(sceneNode->mNumMeshes);
+		u32 node = graph.addNode(parent, localTransform, std::span<const u32>(sceneNode->mMeshes, sceneNode->mNumMeshes));
 
-		for (u32 i = 0; i < sceneNode->mNumMeshes; i++) {
-			node.meshIndices[i] = sceneNode->mMeshes[i];
+		for (u32 i = 0; i < sceneNode->mNumChildren; i++) {
+			loadNode(sceneNode->mChildren[i], graph, node);
 		}
 
-		node.children.resize(sceneNode->mNumChildren);
+	}
+
+
+
+	void computeBounds(Model& model) {
+
+		for (u32 i = 0; i < model.nodes.getNodeCount(); i++) {
+
+			AABBf bounds;
+
+			for (u32 meshIndex : model.nodes.getMeshIndices(i)) {
+				bounds.merge(model.meshes[meshIndex].bounds);
+			}
+
+			model.nodes.setMeshBounds(i, bounds);
 
-		for (u32 i = 0; i < sceneNode->mNumChildren; i++) {
-			loadNode(sceneNode->mChildren[i], node.children[i], node.baseTransform);
 		}
 
 	}
@@ -408,7 +418,8 @@ namespace Loader {
 			return false;
 		}
 
-		loadNode(scene->mRootNode, model.root, Mat4f());
+		model.nodes.clear();
+		loadNode(scene->mRootNode, model.nodes, NodeGraph::invalidNode);
 
 		for (u32 i = 0; i < scene->mNumMaterials; i++) {
 
@@ -588,9 +599,14 @@ namespace Loader {
 			mesh.vertexCount = faceCount * 3;
 			mesh.materialIndex = sceneMesh->mMaterialIndex;
 
+			const aiAABB& sceneBounds = sceneMesh->mAABB;
+			mesh.bounds = AABBf(Vec3f(sceneBounds.mMin.x, sceneBounds.mMin.y, sceneBounds.mMin.z), Vec3f(sceneBounds.mMax.x, sceneBounds.mMax.y, sceneBounds.mMax.z));
+
 			model.meshes.emplace_back(std::move(mesh));
 
 		}
+
+		computeBounds(model);
 		
 		return true;
 
@@ -2,6 +2,8 @@
 
 #include "render/gle/gle.h"
 #include "util/uri.h"
+#include "util/aabb.h"
+#include "nodegraph.h"
 #include <vector>
 #include <unordered_map>
 
@@ -24,28 +26,19 @@ struct Mesh {
 	GLE::VertexBuffer vbo;
 	GLE::IndexBuffer ibo;
 	u32 materialIndex;
+	AABBf bounds;
 
 	void destroy();
 
 };
 
 
-struct ModelNode {
-
-	std::vector<ModelNode> children;
-	std::vector<u32> meshIndices;
-	Mat4f baseTransform;
-	bool visible;
-
-};
-
-
 struct Model {
 
 	std::vector<Mesh> meshes;
 	std::vector<Material> materials;
-	ModelNode root;
-	Mat4f transform;
+	NodeGraph nodes;
+	Mat4f transform;	//Applied to the root nodes on the next NodeGraph::update()
 
 	void destroy();
 
@@ -0,0 +1,392 @@
+#include "nodegraph.h"
+#include "core/thread/taskexecutor.h"
+#include "util/assert.h"
+
+#include <algorithm>
+#include <functional>
+
+
+
+NodeGraph::NodeGraph() : levelsValid(true) {}
+
+
+
+u32 NodeGraph::addNode(u32 parent, const Mat4f& localTransform, std::span<const u32> meshes) {
+
+	u32 node = getNodeCount();
+
+	//Keeps every subtree contiguous: The parent's subtree must still end at the new node
+	arc_assert(parent == invalidNode || (parent < node && parent + subtreeSizes[parent] == node), "Node graph must be built in depth-first order");
+
+	parents.push_back(parent);
+	subtreeSizes.push_back(1);
+	depths.push_back(parent == invalidNode ? 0 : depths[parent] + 1);
+	localTransforms.push_back(localTransform);
+	worldTransforms.emplace_back();
+	meshStarts.push_back(meshIndices.size());
+	meshCounts.push_back(meshes.size());
+	meshBounds.emplace_back();
+	worldMeshBounds.emplace_back();
+	worldBounds.emplace_back();
+	dirtyFlags.push_back(1);
+	visibleFlags.push_back(1);
+
+	meshIndices.insert(meshIndices.end(), meshes.begin(), meshes.end());
+
+	for (u32 p = parent; p != invalidNode; p = parents[p]) {
+		subtreeSizes[p]++;
+	}
+
+	dirtyRoots.push_back(node);
+	levelsValid = false;
+
+	return node;
+
+}
+
+
+
+void NodeGraph::clear() {
+
+	parents.clear();
+	subtreeSizes.clear();
+	depths.clear();
+	localTransforms.clear();
+	worldTransforms.clear();
+	meshStarts.clear();
+	meshCounts.clear();
+	meshBounds.clear();
+	worldMeshBounds.clear();
+	worldBounds.clear();
+	dirtyFlags.clear();
+	visibleFlags.clear();
+	meshIndices.clear();
+	levelNodes.clear();
+	levelStarts.clear();
+	dirtyRoots.clear();
+	staleAncestors.clear();
+
+	levelsValid = true;
+
+}
+
+
+
+void NodeGraph::setLocalTransform(u32 node, const Mat4f& transform) {
+
+	localTransforms[node] = transform;
+	markDirty(node);
+
+}
+
+
+
+void NodeGraph::setRootTransform(const Mat4f& transform) {
+
+	if (rootTransform == transform) {
+		return;
+	}
+
+	rootTransform = transform;
+
+	//Every top-level node is the root of its own subtree
+	for (u32 i = 0; i < getNodeCount(); i += subtreeSizes[i]) {
+		markDirty(i);
+	}
+
+}
+
+
+
+void NodeGraph::setMeshBounds(u32 node, const AABBf& bounds) {
+
+	meshBounds[node] = bounds;
+	markDirty(node);
+
+}
+
+
+
+void NodeGraph::setVisible(u32 node, bool visible) {
+	visibleFlags[node] = visible;
+}
+
+
+
+void NodeGraph::update(TaskExecutor& executor) {
+
+	if (dirtyRoots.empty()) {
+		return;
+	}
+
+	if (!levelsValid) {
+		buildLevels();
+	}
+
+	//Sorted roots lying within the subtree of a preceding root are covered by it
+	std::sort(dirtyRoots.begin(), dirtyRoots.end());
+
+	SizeT rootCount = 0;
+	u32 coveredEnd = 0;
+
+	for (u32 root : dirtyRoots) {
+
+		if (root >= coveredEnd) {
+
+			dirtyRoots[rootCount++] = root;
+			coveredEnd = root + subtreeSizes[root];
+
+		}
+
+	}
+
+	dirtyRoots.resize(rootCount);
+
+	//Subtrees are disjoint ranges in which parents precede their children, so a small one is updated front to back by a single worker
+	executor.parallelFor(dirtyRoots.size(), rootGrainSize, [this](SizeT start, SizeT end) {
+
+		for (SizeT i = start; i < end; i++) {
+
+			u32 root = dirtyRoots[i];
+
+			if (subtreeSizes[root] > updateGrainSize) {
+				continue;
+			}
+
+			for (u32 node = root; node < root + subtreeSizes[root]; node++) {
+				updateNode(node);
+			}
+
+			updateSubtreeBounds(root);
+
+		}
+
+	});
+
+	for (u32 root : dirtyRoots) {
+
+		if (subtreeSizes[root] > updateGrainSize) {
+
+			updateLevels(executor, root);
+			updateSubtreeBounds(root);
+
+		}
+
+	}
+
+	//Ancestors merge the bounds of their children, so they are refreshed bottom-up, i.e. in descending order
+	staleAncestors.clear();
+
+	for (u32 root : dirtyRoots) {
+
+		for (u32 p = parents[root]; p != invalidNode; p = parents[p]) {
+			staleAncestors.push_back(p);
+		}
+
+	}
+
+	std::sort(staleAncestors.begin(), staleAncestors.end(), std::greater<u32>());
+	staleAncestors.erase(std::unique(staleAncestors.begin(), staleAncestors.end()), staleAncestors.end());
+
+	for (u32 node : staleAncestors) {
+		updateNodeBounds(node);
+	}
+
+	dirtyRoots.clear();
+
+}
+
+
+
+u32 NodeGraph::getNodeCount() const {
+	return parents.size();
+}
+
+
+
+u32 NodeGraph::getParent(u32 node) const {
+	return parents[node];
+}
+
+
+
+u32 NodeGraph::getChild(u32 node, u32 index) const {
+
+	u32 end = node + subtreeSizes[node];
+
+	//Siblings are separated by the subtrees of the preceding children
+	for (u32 child = node + 1; child < end; child += subtreeSizes[child]) {
+
+		if (!index--) {
+			return child;
+		}
+
+	}
+
+	arc_force_assert("Child index out of bounds");
+
+	return invalidNode;
+
+}
+
+
+
+u32 NodeGraph::getSubtreeSize(u32 node) const {
+	return subtreeSizes[node];
+}
+
+
+
+bool NodeGraph::isVisible(u32 node) const {
+	return visibleFlags[node];
+}
+
+
+
+std::span<const u32> NodeGraph::getMeshIndices(u32 node) const {
+	return std::span<const u32>(meshIndices.data() + meshStarts[node], meshCounts[node]);
+}
+
+
+
+const Mat4f& NodeGraph::getLocalTransform(u32 node) const {
+	return localTransforms[node];
+}
+
+
+
+const Mat4f& NodeGraph::getWorldTransform(u32 node) const {
+	return worldTransforms[node];
+}
+
+
+
+const AABBf& NodeGraph::getWorldMeshBounds(u32 node) const {
+	return worldMeshBounds[node];
+}
+
+
+
+const AABBf& NodeGraph::getWorldBounds(u32 node) const {
+	return worldBounds[node];
+}
+
+
+
+void NodeGraph::markDirty(u32 node) {
+
+	//A dirty node lies within a dirty subtree, which then contains its whole subtree as well
+	if (dirtyFlags[node]) {
+		return;
+	}
+
+	std::fill_n(dirtyFlags.begin() + node, subtreeSizes[node], 1);
+	dirtyRoots.push_back(node);
+
+}
+
+
+
+void NodeGraph::buildLevels() {
+
+	u32 levelCount = 0;
+
+	for (u32 depth : depths) {
+		levelCount = Math::max<u32, u32>(levelCount, depth + 1);
+	}
+
+	//Counting sort by depth, preserving the depth-first order within each level
+	levelStarts.assign(levelCount + 1, 0);
+
+	for (u32 depth : depths) {
+		levelStarts[depth + 1]++;
+	}
+
+	for (u32 d = 0; d < levelCount; d++) {
+		levelStarts[d + 1] += levelStarts[d];
+	}
+
+	levelNodes.resize(getNodeCount());
+	std::vector<u32> offsets(levelStarts.begin(), levelStarts.end() - 1);
+
+	for (u32 i = 0; i < getNodeCount(); i++) {
+		levelNodes[offsets[depths[i]]++] = i;
+	}
+
+	levelsValid = true;
+
+}
+
+
+
+void NodeGraph::updateNode(u32 node) {
+
+	u32 parent = parents[node];
+	const Mat4f& parentTransform = parent == invalidNode ? rootTransform : worldTransforms[parent];
+
+	worldTransforms[node] = parentTransform * localTransforms[node];
+	worldMeshBounds[node] = meshBounds[node].transformed(worldTransforms[node]);
+	dirtyFlags[node] = 0;
+
+}
+
+
+
+void NodeGraph::updateLevels(TaskExecutor& executor, u32 root) {
+
+	u32 subtreeEnd = root + subtreeSizes[root];
+
+	//Within a level, nodes keep their depth-first order, so the subtree's nodes form a contiguous run
+	for (u32 d = depths[root]; d + 1 < levelStarts.size(); d++) {
+
+		auto levelBegin = levelNodes.begin() + levelStarts[d];
+		auto levelEnd = levelNodes.begin() + levelStarts[d + 1];
+
+		auto first = std::lower_bound(levelBegin, levelEnd, root);
+		auto last = std::lower_bound(first, levelEnd, subtreeEnd);
+
+		//A level without nodes of the subtree has no deeper ones either
+		if (first == last) {
+			break;
+		}
+
+		executor.parallelFor(last - first, updateGrainSize, [this, first](SizeT start, SizeT end) {
+
+			for (SizeT i = start; i < end; i++) {
+				updateNode(first[i]);
+			}
+
+		});
+
+	}
+
+}
+
+
+
+void NodeGraph::updateSubtreeBounds(u32 root) {
+
+	u32 end = root + subtreeSizes[root];
+
+	std::copy(worldMeshBounds.begin() + root, worldMeshBounds.begin() + end, worldBounds.begin() + root);
+
+	//Children follow their parents, so a reverse sweep completes every subtree before merging it upwards
+	for (u32 i = end - 1; i > root; i--) {
+		worldBounds[parents[i]].merge(worldBounds[i]);
+	}
+
+}
+
+
+
+void NodeGraph::updateNodeBounds(u32 node) {
+
+	u32 end = node + subtreeSizes[node];
+
+	worldBounds[node] = worldMeshBounds[node];
+
+	for (u32 child = node + 1; child < end; child += subtreeSizes[child]) {
+		worldBounds[node].merge(worldBounds[child]);
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "util/matrix.h"
+#include "util/aabb.h"
+#include "types.h"
+
+#include <span>
+#include <vector>
+
+
+class TaskExecutor;
+
+/*
+	Model node hierarchy stored as flat arrays in depth-first order.
+	Since a parent always precedes its descendants, the subtree of node i occupies the range [i, i + getSubtreeSize(i)).
+	World transforms are computed as parent world * local, with the root's parent being the root transform.
+	Changing a local transform marks its subtree dirty; update() then recomputes only the dirty subtrees and merges their bounds up the ancestor chains.
+*/
+class NodeGraph {
+
+public:
+
+	constexpr static u32 invalidNode = -1;
+
+	NodeGraph();
+
+	//Appends a node below parent, which must be the last added node or one of its ancestors
+	u32 addNode(u32 parent, const Mat4f& localTransform, std::span<const u32> meshes);
+	void clear();
+
+	void setLocalTransform(u32 node, const Mat4f& transform);
+	void setRootTransform(const Mat4f& transform);
+	void setMeshBounds(u32 node, const AABBf& bounds);
+	void setVisible(u32 node, bool visible);
+
+	/*
+		Recomputes world transforms and bounds of all dirty subtrees. Small subtrees are distributed over the workers as a whole,
+		large ones are updated one depth level at a time with the nodes of a level in parallel.
+	*/
+	void update(TaskExecutor& executor);
+
+	u32 getNodeCount() const;
+	u32 getParent(u32 node) const;
+	u32 getChild(u32 node, u32 index) const;
+	u32 getSubtreeSize(u32 node) const;
+	bool isVisible(u32 node) const;
+
+	std::span<const u32> getMeshIndices(u32 node) const;
+	const Mat4f& getLocalTransform(u32 node) const;
+	const Mat4f& getWorldTransform(u32 node) const;
+
+	//World space bounds of the node's own meshes and of its whole subtree
+	const AABBf& getWorldMeshBounds(u32 node) const;
+	const AABBf& getWorldBounds(u32 node) const;
+
+private:
+
+	void markDirty(u32 node);
+	void buildLevels();
+	void updateNode(u32 node);
+	void updateLevels(TaskExecutor& executor, u32 root);
+	void updateSubtreeBounds(u32 root);
+	void updateNodeBounds(u32 node);
+
+	std::vector<u32> parents;
+	std::vector<u32> subtreeSizes;
+	std::vector<u32> depths;
+	std::vector<Mat4f> localTransforms;
+	std::vector<Mat4f> worldTransforms;
+	std::vector<u32> meshStarts;
+	std::vector<u32> meshCounts;
+	std::vector<AABBf> meshBounds;
+	std::vector<AABBf> worldMeshBounds;
+	std::vector<AABBf> worldBounds;
+	std::vector<u8> dirtyFlags;
+	std::vector<u8> visibleFlags;
+
+	std::vector<u32> meshIndices;
+
+	//Node indices grouped by depth, level d spans [levelStarts[d], levelStarts[d + 1])
+	std::vector<u32> levelNodes;
+	std::vector<u32> levelStarts;
+
+	//Roots of the dirty subtrees. Roots may lie within the subtree of another one until update() drops them.
+	std::vector<u32> dirtyRoots;
+	std::vector<u32> staleAncestors;
+
+	Mat4f rootTransform;
+	bool levelsValid;
+
+	constexpr inline static SizeT updateGrainSize = 256;
+	constexpr inline static SizeT rootGrainSize = 16;
+
+};
\ No newline at end of file
@@ -5,9 +5,10 @@
 #include "util/file.h"
 #include "screenshot.h"
 #include "util/profiler.h"
+#include "core/thread/taskexecutor.h"
 
 
-RenderTest::RenderTest() : frameCounter(0), fbWidth(0), fbHeight(0), exposure(1), showNormals(false) {}
+RenderTest::RenderTest(TaskExecutor& executor) : executor(executor), sceneBackend(*this), instanceData(nullptr), instanceOffsetUniform(nullptr), frameCounter(0), fbWidth(0), fbHeight(0), exposure(1), showNormals(false) {}
 
 
 
@@ -97,6 +98,13 @@ void RenderTest::create(u32 w, u32 h) {
 	skyboxVertexArray.setAttribute(0, 3, GLE::AttributeType::Float, 12, 0);
 	skyboxVertexArray.enableAttribute(0);
 
+	instanceBuffer.create();
+	instanceIndexBuffer.create();
+
+	if (!instanceBuffer.isPersistent()) {
+		Log::warn("Render Test", "Persistent buffer mapping not supported, instance data is uploaded by copy");
+	}
+
 	Lights::createLightBuffer();
 	Lights::addLight(DirectionalLight(Vec3f(1.0, -3.0, 2.5), Vec3f(1.0, 1.0, 0.5), 20.0));
 	Lights::addLight(PointLight(Vec3f(0, 0, 0), Vec3f(1.0, 0.0, 0.0), 20.0, 1.0));
@@ -149,13 +157,31 @@ void RenderTest::run() {
 
 	recalculateProjection();
 
+	const Vec3f& lightVector = Lights::getDirectionalLight(0).direction;
+	Vec3f lightPos = -lightVector * 1000;
+
+	Mat4f lightViewMatrix = Mat4f::lookAt(lightPos, Vec3f(0));
+	Mat4f lightOrthoMatrix = Mat4f::ortho(-shadowOrthoBounds, shadowOrthoBounds, -shadowOrthoBounds, shadowOrthoBounds, 0.5, 1500.0);
+	lightMatrix = lightOrthoMatrix * lightViewMatrix;
+
+	//Collect the draws of all passes and order them by state
+	submitModels();
+
+	//Batched draws look up the draw items of their instances in this table
+	std::span<const u32> instanceItems = renderQueue.getInstanceData();
+	std::copy(instanceItems.begin(), instanceItems.end(), static_cast<u32*>(instanceIndexBuffer.map(instanceItems.size_bytes())));
+
 	//OpenGL main
 
+	//Every pass reads the same instance data
+	instanceBuffer.bind(instanceBindingIndex);
+	instanceIndexBuffer.bind(instanceIndexBindingIndex);
+
 	//Render to shadow map
 	shadowFramebuffer.bind();
 	glViewport(0, 0, shadowMapSize, shadowMapSize);
 	glClear(GL_DEPTH_BUFFER_BIT);
-	renderModels(ShaderPass::Shadow);
+	renderQueue.execute(sceneBackend, static_cast<u32>(ShaderPass::Shadow));
 
 	//Render to render framebuffer
 	renderFramebuffer.bind();
@@ -179,12 +205,12 @@ void RenderTest::run() {
 	glDrawArrays(GL_TRIANGLES, 0, 36);
 	glDepthMask(true);
 
-	//Render models
-	renderModels(ShaderPass::Main);
+	//Render models, the debug pass is only submitted if normals are shown
+	renderQueue.execute(sceneBackend, static_cast<u32>(ShaderPass::Main));
+	renderQueue.execute(sceneBackend, static_cast<u32>(ShaderPass::Debug));
 
-	if (showNormals) {
-		renderModels(ShaderPass::Debug);
-	}
+	instanceBuffer.finish();
+	instanceIndexBuffer.finish();
 
 	//Postprocess
 	GLE::Framebuffer::bindDefault();
@@ -223,6 +249,9 @@ void RenderTest::destroy() {
 	renderDepthBuffer.destroy();
 	renderFramebuffer.destroy();
 
+	instanceBuffer.destroy();
+	instanceIndexBuffer.destroy();
+
 	Lights::destroyLightBuffer();
 
 }
@@ -242,11 +271,8 @@ void RenderTest::loadShaders() {
 	cubemapTextureUniform = cubemapShader.getUniform("cubemapTexture");
 
 	Loader::loadShader(modelShader, ":/shaders/model/diffuse.avs", ":/shaders/model/diffuse.afs");
-	modelNUniform = modelShader.getUniform("normalMatrix");
-	modelMVUniform = modelShader.getUniform("modelViewMatrix");
-	modelMVPUniform = modelShader.getUniform("mvpMatrix");
+	modelInstanceOffsetUniform = modelShader.getUniform("instanceOffset");
 	modelDiffuseUniform = modelShader.getUniform("diffuseTexture");
-	modelShadowMatrixUniform = modelShader.getUniform("shadowMatrix");
 	modelShadowMapUniform = modelShader.getUniform("shadowMap");
 	modelBaseColUniform = modelShader.getUniform("baseCol");
 	modelSrtUniform = modelShader.getUniform("srtMatrix");
@@ -257,15 +283,14 @@ void RenderTest::loadShaders() {
 	Loader::loadShader(debugShader, ":/shaders/model/diffuse.avs", ":/shaders/debug.ags", ":/shaders/debug.afs");
 	debugPUniform = debugShader.getUniform("projectionMatrix");
 	debugUPUniform = debugShader.getUniform("unprojectionMatrix");
-	debugNUniform = debugShader.getUniform("normalMatrix");
-	debugMVPUniform = debugShader.getUniform("mvpMatrix");
+	debugInstanceOffsetUniform = debugShader.getUniform("instanceOffset");
 
 	Loader::loadShader(pprocessShader, ":/shaders/quad.avs", ":/shaders/final.afs");
 	pprocessTextureUniform = pprocessShader.getUniform("screenTexture");
 	pprocessExposureUniform = pprocessShader.getUniform("exposure");
 
 	Loader::loadShader(shadowShader, ":/shaders/shadow.avs", ":/shaders/shadow.afs");
-	lightMatrixUniform = shadowShader.getUniform("lightMVPMatrix");
+	shadowInstanceOffsetUniform = shadowShader.getUniform("instanceOffset");
 
 }
 
@@ -284,133 +309,255 @@ void RenderTest::saveScreenshot() {
 
 
 
-void RenderTest::renderModels(ShaderPass pass) {
+void RenderTest::submitModels() {
 
-	switch (pass) {
+	renderQueue.clear();
+	nodeRecords.clear();
+	nodeBounds.clear();
 
-		case ShaderPass::Shadow:
-			shadowShader.start();
-			break;
+	cameraFrustum = Frustum(projectionMatrix * viewMatrix);
+	lightFrustum = Frustum(lightMatrix);
 
-		case ShaderPass::Main:
-			modelShader.start();
-			break;
+	u32 meshBase = 0;
+	u32 materialBase = 0;
+	u32 itemCount = 0;
 
-		case ShaderPass::Debug:
-			debugShader.start();
-			break;
+	for (Model& model : scene.getModels()) {
 
-		default:
-			arc_force_assert("Unknown shader pass %d", pass);
-			break;
+		model.nodes.setRootTransform(model.transform);
+		model.nodes.update(executor);
+
+		collectNodes(model, meshBase, materialBase, itemCount);
+
+		meshBase += model.meshes.size();
+		materialBase += model.materials.size();
 
 	}
 
-	for (Model& model : scene.getModels()) {
-		renderNode(model, model.root, pass);
+	//Every node owns a fixed range of draw items, so recording writes them without synchronization
+	drawItems.resize(itemCount);
+	instanceData = static_cast<InstanceData*>(instanceBuffer.map(itemCount * sizeof(InstanceData)));
+
+	SizeT nodeCount = nodeRecords.size();
+
+	//Camera passes and the shadow pass see different parts of the scene
+	cameraVisibility.resize(nodeCount);
+	lightVisibility.resize(nodeCount);
+	cameraFrustum.intersects(nodeBounds, cameraVisibility.data());
+	lightFrustum.intersects(nodeBounds, lightVisibility.data());
+	SizeT bucketCount = Math::min<SizeT, SizeT>(nodeCount, (executor.getThreadCount() + 1) * bucketsPerThread);
+
+	if (bucketCount == 0) {
+		return;
 	}
-	
+
+	SizeT grainSize = (nodeCount + bucketCount - 1) / bucketCount;
+
+	//Buckets map to node ranges, not threads, so the merged queue keeps the traversal order
+	renderBuckets.resize(bucketCount);
+
+	for (GLE::RenderBucket& bucket : renderBuckets) {
+		bucket.clear();
+	}
+
+	executor.parallelFor(nodeCount, grainSize, [this, grainSize](SizeT start, SizeT end) {
+		recordNodes(renderBuckets[start / grainSize], start, end);
+	});
+
+	renderQueue.merge(renderBuckets);
+	renderQueue.sort();
+
 }
 
 
 
+void RenderTest::collectNodes(Model& model, u32 meshBase, u32 materialBase, u32& itemCount) {
 
-void RenderTest::renderNode(Model& model, ModelNode& node, ShaderPass pass) {
+	const NodeGraph& nodes = model.nodes;
+	u32 nodeCount = nodes.getNodeCount();
+
+	for (u32 i = 0; i < nodeCount;) {
+
+		//Hidden subtrees and subtrees outside of both views are skipped as a whole
+		const AABBf& bounds = nodes.getWorldBounds(i);
+
+		if (!nodes.isVisible(i) || (!cameraFrustum.intersects(bounds) && !lightFrustum.intersects(bounds))) {
+
+			i += nodes.getSubtreeSize(i);
+			continue;
+
+		}
+
+		u32 meshCount = nodes.getMeshIndices(i).size();
+
+		if (meshCount) {
+
+			nodeRecords.push_back({ &model, i, meshBase, materialBase, itemCount });
+			nodeBounds.add(nodes.getWorldMeshBounds(i));
+			itemCount += meshCount;
+
+		}
+
+		i++;
 
-	if (!node.visible) {
-		return;
 	}
 
-	for (u32 i = 0; i < node.meshIndices.size(); i++) {
+}
+
+
 
-		Mesh& mesh = model.meshes[node.meshIndices[i]];
-		Material& material = model.materials[mesh.materialIndex];
-		GLE::Texture2D& texture = material.textures["diffuse0"];
-		Mat4f modelMatrix = model.transform * node.baseTransform;
+void RenderTest::recordNodes(GLE::RenderBucket& bucket, SizeT start, SizeT end) {
 
-		float orthoBounds = 50;
-		const Vec3f& lightVector = Lights::getDirectionalLight(0).direction;
-		Vec3f lightPos = -lightVector * 1000;
+	for (SizeT n = start; n < end; n++) {
 
-		Mat4f lightViewMatrix = Mat4f::lookAt(lightPos, Vec3f(0));
-		Mat4f lightOrthoMatrix = Mat4f::ortho(-orthoBounds, orthoBounds, -orthoBounds, orthoBounds, 0.5, 1500.0);
-		Mat4f lightMVPMatrix = lightOrthoMatrix * lightViewMatrix * modelMatrix;
+		const NodeRecord& record = nodeRecords[n];
+		Model& model = *record.model;
+		std::span<const u32> meshIndices = model.nodes.getMeshIndices(record.node);
 
-		switch (pass) {
+		const Mat4f& modelMatrix = model.nodes.getWorldTransform(record.node);
+		Mat4f modelViewMatrix = viewMatrix * modelMatrix;
+		Mat3f normalMatrix = modelViewMatrix.toMat3().inverse().transposed();
 
-			case ShaderPass::Shadow:
-				{
-					lightMatrixUniform.setMat4(lightMVPMatrix);
+		//std430 pads mat3 columns to vec4
+		InstanceData instance = { modelViewMatrix, projectionMatrix * modelViewMatrix, lightMatrix * modelMatrix, {
+			Vec4f(normalMatrix[0].x, normalMatrix[0].y, normalMatrix[0].z, 0),
+			Vec4f(normalMatrix[1].x, normalMatrix[1].y, normalMatrix[1].z, 0),
+			Vec4f(normalMatrix[2].x, normalMatrix[2].y, normalMatrix[2].z, 0)
+		} };
 
-					mesh.vao.bind();
-					glDrawElements(GL_TRIANGLES, mesh.vertexCount, GL_UNSIGNED_INT, 0);
-				}
-				break;
+		//Draws are ordered front to back by the view depth of their node's origin
+		float depth = -modelViewMatrix[3].z;
 
-			case ShaderPass::Main:
-				{
-					texture.activate(0);
-					modelDiffuseUniform.setInt(0);
+		bool cameraVisible = cameraVisibility[n];
+		bool lightVisible = lightVisibility[n];
 
-					Mat4f modelViewMatrix = viewMatrix * modelMatrix;
-					Mat3f normalMatrix = modelViewMatrix.toMat3().inverse().transposed();
-					Mat4f mvpMatrix = projectionMatrix * modelViewMatrix;
+		for (u32 i = 0; i < meshIndices.size(); i++) {
 
-					modelNUniform.setMat3(normalMatrix);
-					modelMVUniform.setMat4(modelViewMatrix);
-					modelMVPUniform.setMat4(mvpMatrix);
-					modelShadowMatrixUniform.setMat4(lightMVPMatrix);
+			u32 meshIndex = meshIndices[i];
+			Mesh& mesh = model.meshes[meshIndex];
 
-					if (mesh.materialIndex == 22) {
-						modelBaseColUniform.setVec4(Vec4f(1, 1, 1, 0.75));
-						modelSrtUniform.setMat3(waterSrtMatrix);
-					} else {
-						modelBaseColUniform.setVec4(Vec4f(1, 1, 1, 1));
-						modelSrtUniform.setMat3(Mat3f());
-					}
+			u32 item = record.itemBase + i;
+			drawItems[item] = { &mesh, &model.materials[mesh.materialIndex] };
+			instanceData[item] = instance;
 
-					shadowDepthTexture.activate(1);
-					modelShadowMapUniform.setInt(1);
+			//Shadow and debug draws do not depend on the material
+			GLE::DrawPacket packet { static_cast<u32>(ShaderPass::Shadow), static_cast<u32>(ShaderPass::Shadow), 0, record.meshBase + meshIndex, mesh.vertexCount, item };
 
-					mesh.vao.bind();
-					glDrawElements(GL_TRIANGLES, mesh.vertexCount, GL_UNSIGNED_INT, 0);
-				}
-				break;
+			if (lightVisible) {
+				bucket.submit(packet, depth);
+			}
 
-			case ShaderPass::Debug:
-				{
-					Mat4f modelViewMatrix = viewMatrix * modelMatrix;
-					Mat3f normalMatrix = Mat3f(modelViewMatrix.toMat3()).inverse().transposed();
-					Mat4f unprojectionMatrix = projectionMatrix.inverse();
-					Mat4f mvpMatrix = projectionMatrix * modelViewMatrix;
+			if (!cameraVisible) {
+				continue;
+			}
 
-					debugPUniform.setMat4(projectionMatrix);
-					debugUPUniform.setMat4(unprojectionMatrix);
-					debugNUniform.setMat3(normalMatrix);
-					debugMVPUniform.setMat4(mvpMatrix);
+			packet.pass = static_cast<u32>(ShaderPass::Main);
+			packet.program = static_cast<u32>(ShaderPass::Main);
+			packet.material = record.materialBase + mesh.materialIndex;
+			bucket.submit(packet, depth);
 
-					mesh.vao.bind();
-					glDrawElements(GL_TRIANGLES, mesh.vertexCount, GL_UNSIGNED_INT, 0);
+			if (showNormals) {
 
-				}
-				break;
+				packet.pass = static_cast<u32>(ShaderPass::Debug);
+				packet.program = static_cast<u32>(ShaderPass::Debug);
+				packet.material = 0;
+				bucket.submit(packet, depth);
 
-			default:
-				arc_force_assert("Unknown shader pass %d", pass);
-				break;
+			}
 
 		}
 
 	}
 
-	for (u32 i = 0; i < node.children.size(); i++) {
-		renderNode(model, node.children[i], pass);
+}
+
+
+
+RenderTest::SceneBackend::SceneBackend(RenderTest& renderTest) : renderTest(renderTest) {}
+
+
+
+void RenderTest::SceneBackend::beginPass(const GLE::DrawPacket& packet) {
+	//Framebuffers are set up by run() before each pass is executed
+}
+
+
+
+void RenderTest::SceneBackend::bindProgram(const GLE::DrawPacket& packet) {
+
+	RenderTest& rt = renderTest;
+
+	switch (static_cast<ShaderPass>(packet.program)) {
+
+		case ShaderPass::Shadow:
+			rt.shadowShader.start();
+			rt.instanceOffsetUniform = &rt.shadowInstanceOffsetUniform;
+			break;
+
+		case ShaderPass::Main:
+			rt.modelShader.start();
+			rt.instanceOffsetUniform = &rt.modelInstanceOffsetUniform;
+			rt.modelDiffuseUniform.setInt(0);
+			rt.shadowDepthTexture.activate(1);
+			rt.modelShadowMapUniform.setInt(1);
+			break;
+
+		case ShaderPass::Debug:
+			rt.debugShader.start();
+			rt.instanceOffsetUniform = &rt.debugInstanceOffsetUniform;
+			rt.debugPUniform.setMat4(rt.projectionMatrix);
+			rt.debugUPUniform.setMat4(rt.projectionMatrix.inverse());
+			break;
+
+		default:
+			arc_force_assert("Unknown shader pass %d", packet.program);
+			break;
+
+	}
+
+}
+
+
+
+void RenderTest::SceneBackend::bindMaterial(const GLE::DrawPacket& packet) {
+
+	RenderTest& rt = renderTest;
+
+	if (static_cast<ShaderPass>(packet.pass) != ShaderPass::Main) {
+		return;
+	}
+
+	const DrawItem& item = rt.drawItems[packet.data];
+	item.material->textures["diffuse0"].activate(0);
+
+	if (item.mesh->materialIndex == 22) {
+		rt.modelBaseColUniform.setVec4(Vec4f(1, 1, 1, 0.75));
+		rt.modelSrtUniform.setMat3(rt.waterSrtMatrix);
+	} else {
+		rt.modelBaseColUniform.setVec4(Vec4f(1, 1, 1, 1));
+		rt.modelSrtUniform.setMat3(Mat3f());
 	}
 
 }
 
 
 
+void RenderTest::SceneBackend::bindVertexArray(const GLE::DrawPacket& packet) {
+	renderTest.drawItems[packet.data].mesh->vao.bind();
+}
+
+
+
+void RenderTest::SceneBackend::draw(const GLE::DrawPacket& packet, u32 first, u32 count) {
+
+	//Instance i reads the draw item at instanceIndices[first + i]
+	renderTest.instanceOffsetUniform->setUnsigned(first);
+	GLE::renderInstancedIndexed(GLE::PrimType::Triangle, GLE::IndexType::Int, count, packet.elementCount);
+
+}
+
+
+
 void RenderTest::resizeWindowFB(u32 w, u32 h) {
 
 	fbWidth = w;
@@ -554,6 +701,9 @@ void RenderTest::setupFramebuffers() {
 	renderDepthBuffer.destroy();
 	renderFramebuffer.destroy();
 
+	instanceBuffer.destroy();
+	instanceIndexBuffer.destroy();
+
 	shadowDepthTexture.create();
 	shadowDepthTexture.bind();
 	shadowDepthTexture.setData(shadowMapSize, shadowMapSize, GLE::ImageFormat::Depth24, GLE::TextureSourceFormat::Depth, GLE::TextureSourceType::UByte, nullptr);
@@ -3,17 +3,22 @@
 #include "input/keydefs.h"
 #include "render/gle/gle.h"
 #include "util/matrix.h"
+#include "util/frustum.h"
 
 #include "camera.h"
 #include "light.h"
 #include "scene.h"
 
+#include <vector>
+
+
+class TaskExecutor;
 
 class RenderTest {
 
 public:
 
-	RenderTest();
+	explicit RenderTest(TaskExecutor& executor);
 
 	void create(u32 w, u32 h);
 	void run();
@@ -55,11 +60,54 @@ private:
 		Debug
 	};
 
+	//Mesh instance referenced by the draw packets of all passes
+	struct DrawItem {
+		Mesh* mesh;
+		Material* material;
+	};
+
+	//Per-instance shader data of a draw item, laid out like the std430 Instance struct of the model shaders
+	struct InstanceData {
+		Mat4f modelViewMatrix;
+		Mat4f mvpMatrix;
+		Mat4f shadowMatrix;
+		Vec4f normalMatrix[3];
+	};
+
+	//Node inside a view frustum with the offsets of its meshes, materials and draw items in the frame's flat arrays
+	struct NodeRecord {
+		Model* model;
+		u32 node;
+		u32 meshBase;
+		u32 materialBase;
+		u32 itemBase;
+	};
+
+	//Replays the sorted render queue with GL calls
+	class SceneBackend : public GLE::RenderBackend {
+
+	public:
+
+		explicit SceneBackend(RenderTest& renderTest);
+
+		void beginPass(const GLE::DrawPacket& packet) override;
+		void bindProgram(const GLE::DrawPacket& packet) override;
+		void bindMaterial(const GLE::DrawPacket& packet) override;
+		void bindVertexArray(const GLE::DrawPacket& packet) override;
+		void draw(const GLE::DrawPacket& packet, u32 first, u32 count) override;
+
+	private:
+
+		RenderTest& renderTest;
+
+	};
+
 	void loadShaders();
 	void saveScreenshot();
 
-	void renderModels(ShaderPass pass);
-	void renderNode(Model& model, ModelNode& node, ShaderPass pass);
+	void submitModels();
+	void collectNodes(Model& model, u32 meshBase, u32 materialBase, u32& itemCount);
+	void recordNodes(GLE::RenderBucket& bucket, SizeT start, SizeT end);
 
 	void updateLights();
 	void recalculateView();
@@ -76,11 +124,8 @@ private:
 	GLE::Uniform cubemapTextureUniform;
 
 	GLE::ShaderProgram modelShader;
-	GLE::Uniform modelNUniform;
-	GLE::Uniform modelMVUniform;
-	GLE::Uniform modelMVPUniform;
+	GLE::Uniform modelInstanceOffsetUniform;
 	GLE::Uniform modelDiffuseUniform;
-	GLE::Uniform modelShadowMatrixUniform;
 	GLE::Uniform modelShadowMapUniform;
 	GLE::Uniform modelSrtUniform;
 	GLE::Uniform modelBaseColUniform;
@@ -88,8 +133,7 @@ private:
 	GLE::ShaderProgram debugShader;
 	GLE::Uniform debugPUniform;
 	GLE::Uniform debugUPUniform;
-	GLE::Uniform debugNUniform;
-	GLE::Uniform debugMVPUniform;
+	GLE::Uniform debugInstanceOffsetUniform;
 
 	GLE::VertexArray screenVertexArray;
 	GLE::VertexBuffer screenVertexBuffer;
@@ -98,7 +142,7 @@ private:
 	GLE::Uniform pprocessExposureUniform;
 
 	GLE::ShaderProgram shadowShader;
-	GLE::Uniform lightMatrixUniform;
+	GLE::Uniform shadowInstanceOffsetUniform;
 
 	GLE::Framebuffer renderFramebuffer;
 	GLE::Texture2D renderColorTexture;
@@ -107,8 +151,29 @@ private:
 	GLE::Framebuffer shadowFramebuffer;
 	GLE::Texture2D shadowDepthTexture;
 
+	TaskExecutor& executor;
+
+	GLE::RenderQueue renderQueue;
+	SceneBackend sceneBackend;
+	std::vector<GLE::RenderBucket> renderBuckets;
+	std::vector<NodeRecord> nodeRecords;
+	std::vector<DrawItem> drawItems;
+
+	//Instance data indexed by draw item and the draw item of every queued instance in execution order
+	GLE::StreamBuffer instanceBuffer;
+	GLE::StreamBuffer instanceIndexBuffer;
+	InstanceData* instanceData;
+	GLE::Uniform* instanceOffsetUniform;
+
+	Frustum cameraFrustum;
+	Frustum lightFrustum;
+	CullingBounds nodeBounds;
+	std::vector<u8> cameraVisibility;
+	std::vector<u8> lightVisibility;
+
 	Mat4f viewMatrix;
 	Mat4f projectionMatrix;
+	Mat4f lightMatrix;
 
 	Mat3f waterSrtMatrix;
 	Vec2f waterBaseCol;
@@ -139,6 +204,10 @@ private:
 	constexpr inline static double fovNormal = 90;
 	constexpr inline static double fovZoom = 30;
 	constexpr inline static u32 shadowMapSize = 2048;
+	constexpr inline static double shadowOrthoBounds = 50;
+	constexpr inline static u32 bucketsPerThread = 4;
+	constexpr inline static u32 instanceBindingIndex = 0;
+	constexpr inline static u32 instanceIndexBindingIndex = 1;
 
 	static inline double fov = fovNormal;
 	static inline double camVelocity = camVelocityFast;
@@ -39,7 +39,8 @@ void Scene::loadScene(SceneID id) {
 				models[SceneModel::getModelID(SceneModel::MarioSDSID::Luigi)].transform = Mat4f::fromTranslation(+20, 20, 0);
 				models[SceneModel::getModelID(SceneModel::MarioSDSID::Melascula)].transform = Mat4f::fromScale(10, 10, 10).translate(0, 20, 0);
 				models[SceneModel::getModelID(SceneModel::MarioSDSID::Galand)].transform = Mat4f::fromScale(1, 1, 1).translate(0, -50, -50);
-				models[SceneModel::getModelID(SceneModel::MarioSDSID::Melascula)].root.children[4].visible = false;
+				NodeGraph& melasculaNodes = models[SceneModel::getModelID(SceneModel::MarioSDSID::Melascula)].nodes;
+				melasculaNodes.setVisible(melasculaNodes.getChild(0, 4), false);
 
 				setTextureFilters(SceneModel::getModelID(SceneModel::MarioSDSID::Mario), GLE::TextureFilter::None, GLE::TextureFilter::None);
 				setTextureFilters(SceneModel::getModelID(SceneModel::MarioSDSID::Luigi), GLE::TextureFilter::None, GLE::TextureFilter::None);
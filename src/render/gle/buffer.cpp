@@ -50,9 +50,11 @@ void Buffer::destroy() {
 			setBoundBufferID(type, invalidBoundID);
 		}
 
+		//Deleting a buffer also unmaps it
 		glDeleteBuffers(1, &id);
 		id = invalidID;
 		size = 0;
+		immutable = false;
 
 	}
 
@@ -70,6 +72,8 @@ void Buffer::allocate(u32 size, void* data, BufferAccess access) {
 
 	gle_assert(isBound(), "Buffer object %d has not been bound (attempted to set buffer storage)", id);
 
+	gle_assert(!immutable, "Buffer object %d has immutable storage (attempted to reallocate)", id);
+
 	//TODO: Check if buffer has been mapped non-persistently
 	this->size = size;
 	glBufferData(getBufferTypeEnum(type), size, data, getBufferAccessEnum(access));
@@ -78,6 +82,26 @@ void Buffer::allocate(u32 size, void* data, BufferAccess access) {
 
 
 
+void* Buffer::allocatePersistent(u32 size) {
+
+	gle_assert(isBound(), "Buffer object %d has not been bound (attempted to set persistent buffer storage)", id);
+	gle_assert(!immutable, "Buffer object %d already has immutable storage", id);
+	gle_assert(persistentMappingSupported(), "Persistent buffer mapping is not supported");
+
+	//Coherent mappings make CPU writes visible to subsequently issued commands without explicit flushes
+	constexpr u32 flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+	this->size = size;
+	immutable = true;
+
+	glBufferStorage(getBufferTypeEnum(type), size, nullptr, flags);
+
+	return glMapBufferRange(getBufferTypeEnum(type), 0, size, flags);
+
+}
+
+
+
 void Buffer::update(u32 offset, u32 size, void* data) {
 
 	gle_assert(isBound(), "Buffer object %d has not been bound (attempted to set buffer data)", id);
@@ -138,6 +162,12 @@ u32 Buffer::getSize() const {
 
 
 
+bool Buffer::persistentMappingSupported() {
+	return GLE_EXT_SUPPORTED(ARB_buffer_storage);
+}
+
+
+
 u32 Buffer::getBufferTypeEnum(BufferType type) {
 
 	switch (type) {
@@ -160,6 +190,9 @@ u32 Buffer::getBufferTypeEnum(BufferType type) {
 		case BufferType::CopyWriteBuffer:
 			return GL_COPY_WRITE_BUFFER;
 
+		case BufferType::ShaderStorageBuffer:
+			return GL_SHADER_STORAGE_BUFFER;
+
 		default:
 			gle_force_assert("Invalid buffer type 0x%X", type);
 			return -1;
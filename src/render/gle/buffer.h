@@ -12,7 +12,8 @@ enum class BufferType {
 	TransformFeedbackBuffer,
 	UniformBuffer,
 	CopyReadBuffer,
-	CopyWriteBuffer
+	CopyWriteBuffer,
+	ShaderStorageBuffer
 };
 
 
@@ -43,6 +44,9 @@ public:
 	void allocate(u32 size, BufferAccess access = BufferAccess::StaticDraw);
 	void allocate(u32 size, void* data, BufferAccess access = BufferAccess::StaticDraw);
 
+	//Allocates immutable storage that stays mapped for writing until the buffer is destroyed. Requires ARB_buffer_storage.
+	void* allocatePersistent(u32 size);
+
 	//Updates the buffer's data. Fails if no storage has been allocated first.
 	void update(u32 offset, u32 size, void* data);
 
@@ -56,10 +60,12 @@ public:
 
 	u32 getSize() const;
 
+	static bool persistentMappingSupported();
+
 protected:
 
 	//Yes, protected.
-	constexpr Buffer(BufferType type) : type(type), size(0) {}
+	constexpr Buffer(BufferType type) : type(type), size(0), immutable(false) {}
 
 	//Binds the buffer to the given target if not already. Fails if it hasn't been created yet.
 	void bind(BufferType type);
@@ -77,11 +83,12 @@ protected:
 
 	BufferType type;	//Currently bound type
 	u32 size;			//Buffer size or -1 if none has been allocated
+	bool immutable;		//Storage has been allocated by allocatePersistent()
 
 private:
 
 	//Active buffer handles per type
-	static inline u32 boundBufferIDs[6] = { invalidBoundID, invalidBoundID, invalidBoundID, invalidBoundID, invalidBoundID, invalidBoundID };
+	static inline u32 boundBufferIDs[7] = { invalidBoundID, invalidBoundID, invalidBoundID, invalidBoundID, invalidBoundID, invalidBoundID, invalidBoundID };
 
 };
 
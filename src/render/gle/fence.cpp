@@ -0,0 +1,63 @@
+#include "fence.h"
+
+#include GLE_HEADER
+
+
+GLE_BEGIN
+
+
+Fence::~Fence() {
+	destroy();
+}
+
+
+
+void Fence::place() {
+
+	destroy();
+	handle = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+}
+
+
+
+bool Fence::wait(u64 timeout) {
+
+	if (!isPlaced()) {
+		return true;
+	}
+
+	//Flushing on the first wait guarantees that the fence reaches the GPU and eventually signals
+	GLenum result = glClientWaitSync(static_cast<GLsync>(handle), GL_SYNC_FLUSH_COMMANDS_BIT, timeout);
+
+	if (result == GL_TIMEOUT_EXPIRED || result == GL_WAIT_FAILED) {
+		return false;
+	}
+
+	destroy();
+
+	return true;
+
+}
+
+
+
+void Fence::destroy() {
+
+	if (isPlaced()) {
+
+		glDeleteSync(static_cast<GLsync>(handle));
+		handle = nullptr;
+
+	}
+
+}
+
+
+
+bool Fence::isPlaced() const {
+	return handle;
+}
+
+
+GLE_END
\ No newline at end of file
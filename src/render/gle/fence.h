@@ -0,0 +1,41 @@
+#pragma once
+
+#include "gc.h"
+
+
+GLE_BEGIN
+
+
+/*
+	Sync object signaled once the GPU has completed all commands issued before place().
+	Used to keep the CPU from overwriting buffer regions the GPU still reads.
+*/
+class Fence {
+
+public:
+
+	constexpr Fence() : handle(nullptr) {}
+	~Fence();
+
+	Fence(const Fence& fence) = delete;
+	Fence& operator=(const Fence& fence) = delete;
+
+	//Inserts the fence into the command stream, replacing a previously placed one
+	void place();
+
+	//Blocks until the fence has been signaled or timeout nanoseconds have passed. Returns true if it has been signaled or was never placed.
+	bool wait(u64 timeout = -1);
+
+	//Deletes the fence if it was placed
+	void destroy();
+
+	bool isPlaced() const;
+
+private:
+
+	void* handle;
+
+};
+
+
+GLE_END
\ No newline at end of file
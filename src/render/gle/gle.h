@@ -4,6 +4,9 @@
 #include "vertexbuffer.h"
 #include "indexbuffer.h"
 #include "uniformbuffer.h"
+#include "shaderstoragebuffer.h"
+#include "streambuffer.h"
+#include "fence.h"
 #include "shaderprogram.h"
 #include "texture1d.h"
 #include "texture2d.h"
@@ -18,4 +21,5 @@
 #include "renderbuffer.h"
 
 #include "render.h"
+#include "renderqueue.h"
 #include "glecore.h"
\ No newline at end of file
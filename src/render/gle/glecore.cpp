@@ -25,6 +25,8 @@ namespace {
 	u32 maxDrawBuffers = 0;
 
 	u32 maxUniformBlockBindings = 0;
+	u32 maxShaderStorageBlockBindings = 0;
+	u32 shaderStorageOffsetAlignment = 1;
 
 }
 
@@ -93,6 +95,16 @@ namespace Core {
 		glGetIntegerv(GL_MAX_UNIFORM_BUFFER_BINDINGS, &tmp);
 		maxUniformBlockBindings = tmp;
 
+		//Shader storage buffers are core since OpenGL 4.3
+		if (GLE_EXT_SUPPORTED(ARB_shader_storage_buffer_object)) {
+
+			glGetIntegerv(GL_MAX_SHADER_STORAGE_BUFFER_BINDINGS, &tmp);
+			maxShaderStorageBlockBindings = tmp;
+			glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &tmp);
+			shaderStorageOffsetAlignment = tmp;
+
+		}
+
 		return true;
 
 	}
@@ -204,6 +216,14 @@ namespace Limits {
 		return maxUniformBlockBindings;
 	}
 
+	u32 getMaxShaderStorageBlockBindings() {
+		return maxShaderStorageBlockBindings;
+	}
+
+	u32 getShaderStorageOffsetAlignment() {
+		return shaderStorageOffsetAlignment;
+	}
+
 }
 
 
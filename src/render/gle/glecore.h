@@ -34,6 +34,8 @@ namespace Limits {
 	u32 getMaxDrawBuffers();
 
 	u32 getMaxUniformBlockBindings();
+	u32 getMaxShaderStorageBlockBindings();
+	u32 getShaderStorageOffsetAlignment();
 
 }
 
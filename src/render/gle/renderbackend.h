@@ -0,0 +1,107 @@
+#pragma once
+
+#include "gc.h"
+
+
+GLE_BEGIN
+
+
+/*
+	Draw command stored in a RenderQueue.
+	All handles are chosen by the submitter and only interpreted by the backend executing the queue.
+	pass, program, material and vertexArray are part of the sort key and limited to RenderQueue::maxPasses, maxPrograms, maxMaterials and maxVertexArrays.
+	data identifies the drawn instance, e.g. an index into per-instance storage.
+*/
+struct DrawPacket {
+
+	u32 pass;
+	u32 program;
+	u32 material;
+	u32 vertexArray;
+	u32 elementCount;
+	u32 data;
+
+};
+
+
+/*
+	Receives the commands of an executed RenderQueue.
+	The queue only calls the bind functions if the respective handle differs from the previous packet's.
+	Changing the pass rebinds all other state.
+	Consecutive packets that only differ in data are merged into a single draw of multiple instances.
+*/
+class RenderBackend {
+
+public:
+
+	virtual ~RenderBackend() = default;
+
+	virtual void beginPass(const DrawPacket& packet) = 0;
+	virtual void bindProgram(const DrawPacket& packet) = 0;
+	virtual void bindMaterial(const DrawPacket& packet) = 0;
+	virtual void bindVertexArray(const DrawPacket& packet) = 0;
+
+	//Draws count instances of packet. Their data values are RenderQueue::getInstanceData()[first, first + count).
+	virtual void draw(const DrawPacket& packet, u32 first, u32 count) = 0;
+
+};
+
+
+/*
+	Backend counting the commands it receives without issuing any GL calls.
+	Used to measure sorting and state elimination without a GPU.
+*/
+class NullRenderBackend : public RenderBackend {
+
+public:
+
+	constexpr NullRenderBackend() : passChanges(0), programChanges(0), materialChanges(0), vertexArrayChanges(0), drawCalls(0), drawnInstances(0), drawnElements(0) {}
+
+	void beginPass(const DrawPacket& packet) override {
+		passChanges++;
+	}
+
+	void bindProgram(const DrawPacket& packet) override {
+		programChanges++;
+	}
+
+	void bindMaterial(const DrawPacket& packet) override {
+		materialChanges++;
+	}
+
+	void bindVertexArray(const DrawPacket& packet) override {
+		vertexArrayChanges++;
+	}
+
+	void draw(const DrawPacket& packet, u32 first, u32 count) override {
+		drawCalls++;
+		drawnInstances += count;
+		drawnElements += u64(packet.elementCount) * count;
+	}
+
+	constexpr void reset() {
+		passChanges = 0;
+		programChanges = 0;
+		materialChanges = 0;
+		vertexArrayChanges = 0;
+		drawCalls = 0;
+		drawnInstances = 0;
+		drawnElements = 0;
+	}
+
+	constexpr u32 getStateChanges() const {
+		return passChanges + programChanges + materialChanges + vertexArrayChanges;
+	}
+
+	u32 passChanges;
+	u32 programChanges;
+	u32 materialChanges;
+	u32 vertexArrayChanges;
+	u32 drawCalls;
+	u32 drawnInstances;
+	u64 drawnElements;
+
+};
+
+
+GLE_END
\ No newline at end of file
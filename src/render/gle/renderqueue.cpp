@@ -0,0 +1,335 @@
+#include "renderqueue.h"
+
+#include <algorithm>
+#include <bit>
+
+
+GLE_BEGIN
+
+
+void RenderBucket::reserve(SizeT count) {
+
+	packets.reserve(count);
+	keys.reserve(count);
+
+}
+
+
+
+void RenderBucket::clear() {
+
+	packets.clear();
+	keys.clear();
+
+}
+
+
+
+void RenderBucket::submit(const DrawPacket& packet, float depth) {
+
+	keys.push_back(RenderQueue::createKey(packet, depth));
+	packets.push_back(packet);
+
+}
+
+
+
+SizeT RenderBucket::getPacketCount() const {
+	return packets.size();
+}
+
+
+
+RenderQueue::RenderQueue() : sorted(true) {}
+
+
+
+void RenderQueue::reserve(SizeT count) {
+
+	packets.reserve(count);
+	entries.reserve(count);
+	sortBuffer.reserve(count);
+
+}
+
+
+
+void RenderQueue::clear() {
+
+	packets.clear();
+	entries.clear();
+	instanceData.clear();
+	sorted = true;
+
+}
+
+
+
+void RenderQueue::submit(const DrawPacket& packet, float depth) {
+
+	entries.push_back({ createKey(packet, depth), static_cast<u32>(packets.size()) });
+	packets.push_back(packet);
+	sorted = false;
+
+}
+
+
+
+void RenderQueue::merge(std::span<const RenderBucket> buckets) {
+
+	SizeT previousCount = packets.size();
+	SizeT count = previousCount;
+
+	for (const RenderBucket& bucket : buckets) {
+		count += bucket.packets.size();
+	}
+
+	packets.reserve(count);
+	entries.reserve(count);
+
+	for (const RenderBucket& bucket : buckets) {
+
+		u32 base = static_cast<u32>(packets.size());
+
+		for (SizeT i = 0; i < bucket.keys.size(); i++) {
+			entries.push_back({ bucket.keys[i], static_cast<u32>(base + i) });
+		}
+
+		packets.insert(packets.end(), bucket.packets.begin(), bucket.packets.end());
+
+	}
+
+	if (count != previousCount) {
+		sorted = false;
+	}
+
+}
+
+
+
+void RenderQueue::sort() {
+
+	if (sorted) {
+		return;
+	}
+
+	SizeT count = entries.size();
+
+	if (count <= insertionSortThreshold) {
+
+		for (SizeT i = 1; i < count; i++) {
+
+			SortEntry entry = entries[i];
+			SizeT j = i;
+
+			for (; j > 0 && entries[j - 1].key > entry.key; j--) {
+				entries[j] = entries[j - 1];
+			}
+
+			entries[j] = entry;
+
+		}
+
+		gatherInstanceData();
+		return;
+
+	}
+
+	//Histograms of all eight key bytes are built in a single pass
+	u32 histograms[8][256] = {};
+
+	for (const SortEntry& entry : entries) {
+
+		for (u32 d = 0; d < 8; d++) {
+			histograms[d][(entry.key >> (d * 8)) & 0xFF]++;
+		}
+
+	}
+
+	sortBuffer.resize(count);
+
+	for (u32 d = 0; d < 8; d++) {
+
+		u32* histogram = histograms[d];
+
+		//All keys share this byte, the scatter would not change the order
+		if (histogram[(entries[0].key >> (d * 8)) & 0xFF] == count) {
+			continue;
+		}
+
+		u32 offset = 0;
+
+		for (u32 i = 0; i < 256; i++) {
+
+			u32 bucketSize = histogram[i];
+			histogram[i] = offset;
+			offset += bucketSize;
+
+		}
+
+		for (const SortEntry& entry : entries) {
+			sortBuffer[histogram[(entry.key >> (d * 8)) & 0xFF]++] = entry;
+		}
+
+		entries.swap(sortBuffer);
+
+	}
+
+	gatherInstanceData();
+
+}
+
+
+
+void RenderQueue::execute(RenderBackend& backend) const {
+
+	gle_assert(sorted, "Render queue must be sorted before execution");
+
+	executeRange(backend, 0, entries.size());
+
+}
+
+
+
+void RenderQueue::execute(RenderBackend& backend, u32 pass) const {
+
+	gle_assert(sorted, "Render queue must be sorted before execution");
+	gle_assert(pass < maxPasses, "Render pass %d exceeds the maximum pass count", pass);
+
+	//Passes occupy the most significant key bits, so each pass is a contiguous range
+	constexpr u32 passShift = 64 - passBits;
+
+	auto begin = std::lower_bound(entries.begin(), entries.end(), u64(pass) << passShift, [](const SortEntry& entry, u64 key) {
+		return entry.key < key;
+	});
+
+	auto end = std::find_if(begin, entries.end(), [pass](const SortEntry& entry) {
+		return (entry.key >> passShift) != pass;
+	});
+
+	executeRange(backend, begin - entries.begin(), end - entries.begin());
+
+}
+
+
+
+SizeT RenderQueue::getPacketCount() const {
+	return packets.size();
+}
+
+
+
+bool RenderQueue::isSorted() const {
+	return sorted;
+}
+
+
+
+std::span<const u32> RenderQueue::getInstanceData() const {
+
+	gle_assert(sorted, "Render queue must be sorted before accessing instance data");
+
+	return instanceData;
+
+}
+
+
+
+u64 RenderQueue::createKey(const DrawPacket& packet, float depth) {
+
+	gle_assert(packet.pass < maxPasses, "Render pass %d exceeds the maximum pass count", packet.pass);
+	gle_assert(packet.program < maxPrograms, "Program handle %d exceeds the maximum program count", packet.program);
+	gle_assert(packet.material < maxMaterials, "Material handle %d exceeds the maximum material count", packet.material);
+	gle_assert(packet.vertexArray < maxVertexArrays, "Vertex array handle %d exceeds the maximum vertex array count", packet.vertexArray);
+
+	//The bit patterns of non-negative floats are ordered like their values, the upper half keeps the exponent and 7 mantissa bits
+	u32 depthBits = std::bit_cast<u32>(depth > 0 ? depth : 0.0f) >> 16;
+
+	return (u64(packet.pass) << (64 - passBits)) | (u64(packet.program) << (32 + materialBits)) | (u64(packet.material) << 32) | (u64(packet.vertexArray) << 16) | depthBits;
+
+}
+
+
+
+void RenderQueue::gatherInstanceData() {
+
+	instanceData.resize(entries.size());
+
+	for (SizeT i = 0; i < entries.size(); i++) {
+		instanceData[i] = packets[entries[i].index].data;
+	}
+
+	sorted = true;
+
+}
+
+
+
+void RenderQueue::executeRange(RenderBackend& backend, SizeT start, SizeT end) const {
+
+	u32 pass = invalidID;
+	u32 program = invalidID;
+	u32 material = invalidID;
+	u32 vertexArray = invalidID;
+
+	for (SizeT i = start; i < end;) {
+
+		const DrawPacket& packet = packets[entries[i].index];
+
+		if (packet.pass != pass) {
+
+			pass = packet.pass;
+			program = invalidID;
+			material = invalidID;
+			vertexArray = invalidID;
+
+			backend.beginPass(packet);
+
+		}
+
+		//Material state lives in the program's uniforms and has to be reapplied after a program switch
+		if (packet.program != program) {
+
+			program = packet.program;
+			material = invalidID;
+
+			backend.bindProgram(packet);
+
+		}
+
+		if (packet.material != material) {
+
+			material = packet.material;
+			backend.bindMaterial(packet);
+
+		}
+
+		if (packet.vertexArray != vertexArray) {
+
+			vertexArray = packet.vertexArray;
+			backend.bindVertexArray(packet);
+
+		}
+
+		//Packets differing only in their data become instances of a single draw
+		SizeT runEnd = i + 1;
+
+		for (; runEnd < end; runEnd++) {
+
+			const DrawPacket& next = packets[entries[runEnd].index];
+
+			if (next.pass != pass || next.program != program || next.material != material || next.vertexArray != vertexArray || next.elementCount != packet.elementCount) {
+				break;
+			}
+
+		}
+
+		backend.draw(packet, i, runEnd - i);
+		i = runEnd;
+
+	}
+
+}
+
+
+GLE_END
\ No newline at end of file
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "renderbackend.h"
+
+#include <span>
+#include <vector>
+
+
+GLE_BEGIN
+
+
+/*
+	Linear packet buffer recorded by a single thread at a time.
+	Worker threads each fill their own bucket without synchronization, the render thread then merges all buckets into a RenderQueue.
+	Sort keys are computed while recording, so merging only copies.
+*/
+class RenderBucket {
+
+public:
+
+	void reserve(SizeT count);
+	void clear();
+
+	void submit(const DrawPacket& packet, float depth);
+
+	SizeT getPacketCount() const;
+
+private:
+
+	friend class RenderQueue;
+
+	std::vector<DrawPacket> packets;
+	std::vector<u64> keys;
+
+};
+
+
+
+/*
+	Collects draw packets and executes them ordered by a 64 bit sort key.
+	The key holds, from the most significant bit down, the pass (4 bits), program (12 bits), material (16 bits), vertex array (16 bits)
+	and depth (16 bits). Grouping by vertex array before depth makes packets of the same mesh and material adjacent.
+	Sorting is a stable LSD radix sort over the key bytes, packets with equal keys keep their submission order.
+	During execution, binds that would not change the current state are dropped before they reach the backend,
+	and runs of packets sharing all state are issued as one instanced draw.
+*/
+class RenderQueue {
+
+public:
+
+	constexpr static u32 passBits = 4;
+	constexpr static u32 programBits = 12;
+	constexpr static u32 materialBits = 16;
+	constexpr static u32 vertexArrayBits = 16;
+
+	constexpr static u32 maxPasses = 1 << passBits;
+	constexpr static u32 maxPrograms = 1 << programBits;
+	constexpr static u32 maxMaterials = 1 << materialBits;
+	constexpr static u32 maxVertexArrays = 1 << vertexArrayBits;
+
+	RenderQueue();
+
+	void reserve(SizeT count);
+	void clear();
+
+	//Adds a packet. Non-negative depths sort front to back within equal vertex arrays, submit farthest - depth to reverse the order.
+	void submit(const DrawPacket& packet, float depth);
+
+	//Appends the packets of all buckets in bucket order
+	void merge(std::span<const RenderBucket> buckets);
+
+	void sort();
+
+	//Executes all packets. The queue must be sorted.
+	void execute(RenderBackend& backend) const;
+
+	//Executes the packets of a single pass. The queue must be sorted.
+	void execute(RenderBackend& backend, u32 pass) const;
+
+	SizeT getPacketCount() const;
+	bool isSorted() const;
+
+	//Data values of all packets in execution order. Valid once the queue has been sorted.
+	std::span<const u32> getInstanceData() const;
+
+	static u64 createKey(const DrawPacket& packet, float depth);
+
+private:
+
+	struct SortEntry {
+		u64 key;
+		u32 index;
+	};
+
+	void gatherInstanceData();
+	void executeRange(RenderBackend& backend, SizeT start, SizeT end) const;
+
+	std::vector<DrawPacket> packets;
+	std::vector<SortEntry> entries;
+	std::vector<SortEntry> sortBuffer;
+	std::vector<u32> instanceData;
+	bool sorted;
+
+	constexpr static SizeT insertionSortThreshold = 64;
+
+};
+
+
+GLE_END
\ No newline at end of file
@@ -0,0 +1,37 @@
+#include "shaderstoragebuffer.h"
+
+#include "glecore.h"
+#include GLE_HEADER
+
+
+GLE_BEGIN
+
+
+bool ShaderStorageBuffer::bindRange(u32 index, u32 offset, u32 size) {
+
+	gle_assert(isBound(), "Shader storage buffer object %d has not been bound (attempted to set storage range binding)", id);
+
+	if (index >= Limits::getMaxShaderStorageBlockBindings()) {
+		GLE::warn("Given shader storage block binding index %d exceeds the maximum of %d (shader storage buffer ID=%d)", index, Limits::getMaxShaderStorageBlockBindings(), id);
+		return false;
+	}
+
+	if ((offset + size) > this->size) {
+		GLE::warn("Storage range to bind (offset = %d, %d bytes) exceeds the buffer size of %d (shader storage buffer ID=%d)", offset, size, this->size, id);
+		return false;
+	}
+
+	if (offset % Limits::getShaderStorageOffsetAlignment()) {
+		GLE::warn("Storage range offset %d is not aligned to %d bytes (shader storage buffer ID=%d)", offset, Limits::getShaderStorageOffsetAlignment(), id);
+		return false;
+	}
+
+	glBindBufferRange(getBufferTypeEnum(type), index, id, offset, size);
+	setBoundBufferID(type, id);
+
+	return true;
+
+}
+
+
+GLE_END
\ No newline at end of file
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "buffer.h"
+
+
+GLE_BEGIN
+
+
+class ShaderStorageBuffer : public Buffer {
+
+public:
+
+	constexpr ShaderStorageBuffer() : Buffer(BufferType::ShaderStorageBuffer) {}
+
+	//Binds to the default target
+	inline void bind() {
+		Buffer::bind(BufferType::ShaderStorageBuffer);
+	}
+
+	bool bindRange(u32 index, u32 offset, u32 size);
+
+};
+
+
+GLE_END
\ No newline at end of file
@@ -0,0 +1,128 @@
+#include "streambuffer.h"
+
+#include "glecore.h"
+
+#include <algorithm>
+
+
+GLE_BEGIN
+
+
+StreamBuffer::StreamBuffer() : mappedData(nullptr), regionSize(0), usedSize(0), frame(0), persistent(false) {}
+
+
+
+void StreamBuffer::create() {
+
+	buffer.create();
+	persistent = Buffer::persistentMappingSupported();
+
+}
+
+
+
+void StreamBuffer::destroy() {
+
+	for (Fence& fence : fences) {
+		fence.destroy();
+	}
+
+	buffer.destroy();
+	clientData.clear();
+
+	mappedData = nullptr;
+	regionSize = 0;
+	usedSize = 0;
+	frame = 0;
+
+}
+
+
+
+void* StreamBuffer::map(u32 size) {
+
+	usedSize = size;
+
+	if (!persistent) {
+
+		clientData.resize(size);
+		return clientData.data();
+
+	}
+
+	if (size > regionSize) {
+		reallocate(size);
+	}
+
+	//The region was last used frameCount frames ago
+	fences[frame].wait();
+
+	return mappedData + frame * regionSize;
+
+}
+
+
+
+void StreamBuffer::bind(u32 index) {
+
+	if (!usedSize) {
+		return;
+	}
+
+	buffer.bind();
+
+	if (persistent) {
+
+		buffer.bindRange(index, frame * regionSize, usedSize);
+
+	} else {
+
+		buffer.allocate(usedSize, clientData.data(), BufferAccess::StreamDraw);
+		buffer.bindRange(index, 0, usedSize);
+
+	}
+
+}
+
+
+
+void StreamBuffer::finish() {
+
+	if (!persistent) {
+		return;
+	}
+
+	fences[frame].place();
+	frame = (frame + 1) % frameCount;
+
+}
+
+
+
+bool StreamBuffer::isPersistent() const {
+	return persistent;
+}
+
+
+
+void StreamBuffer::reallocate(u32 size) {
+
+	for (Fence& fence : fences) {
+		fence.wait();
+	}
+
+	//Immutable storage cannot be resized, the buffer is recreated with room to grow
+	u32 alignment = Limits::getShaderStorageOffsetAlignment();
+	u32 newSize = std::max(size, regionSize * 2);
+	regionSize = (newSize + alignment - 1) / alignment * alignment;
+
+	buffer.destroy();
+	buffer.create();
+	buffer.bind();
+
+	mappedData = static_cast<u8*>(buffer.allocatePersistent(regionSize * frameCount));
+
+}
+
+
+GLE_END
\ No newline at end of file
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "shaderstoragebuffer.h"
+#include "fence.h"
+
+#include <vector>
+
+
+GLE_BEGIN
+
+
+/*
+	Shader storage buffer for data rewritten every frame.
+	The storage is split into frameCount regions used in turn, so the CPU fills one region while the GPU still reads the previous ones.
+	With ARB_buffer_storage, the regions are persistently mapped and written in place, fences guard regions still in use.
+	Otherwise map() returns client memory that bind() uploads into orphaned storage.
+*/
+class StreamBuffer {
+
+public:
+
+	constexpr static u32 frameCount = 3;
+
+	StreamBuffer();
+
+	void create();
+	void destroy();
+
+	//Returns the current frame's region resized to at least size bytes. Growing the storage waits for the GPU to finish all regions.
+	void* map(u32 size);
+
+	//Binds the bytes written since map() to the given shader storage binding
+	void bind(u32 index);
+
+	//Ends the frame after all commands reading the region have been issued
+	void finish();
+
+	bool isPersistent() const;
+
+private:
+
+	void reallocate(u32 size);
+
+	ShaderStorageBuffer buffer;
+	Fence fences[frameCount];
+	std::vector<u8> clientData;
+
+	u8* mappedData;
+	u32 regionSize;
+	u32 usedSize;
+	u32 frame;
+	bool persistent;
+
+};
+
+
+GLE_END
\ No newline at end of file
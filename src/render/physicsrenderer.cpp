@@ -1,11 +1,17 @@
 #include "physicsrenderer.h"
 #include "utility/shaderloader.h"
 #include "utility/vertexhelper.h"
-#include "core/acs/actormanager.h"
+#include "core/statebuffer.h"
+#include "core/thread/taskexecutor.h"
+#include "util/time.h"
+#include "util/transformkernel.h"
 #include "debug.h"
 
+#include <algorithm>
+#include <numeric>
 
-PhysicsRenderer::PhysicsRenderer(ActorManager& actorManager) : actorManager(actorManager), prevObjects(0) {}
+
+PhysicsRenderer::PhysicsRenderer(StateBuffer& stateBuffer, TaskExecutor& executor) : stateBuffer(stateBuffer), executor(executor), prevObjects(0), objects(0), dirtyStart(-1), dirtyEnd(0) {}
 
 
 bool PhysicsRenderer::init() {
@@ -50,6 +56,8 @@ bool PhysicsRenderer::init() {
 
 	mvpMatrixUniform = objectShader.getUniform("mvpMatrix");
 
+	frameArena.create(frameArenaSize);
+
 	camera.setPosition(Vec3f(20, 5, 40));
 	camera.setRotation(Math::toRadians(270), 0);
 	setCameraMatrix(camera.getPosition(), camera.getPosition() + camera.getDirection());
@@ -60,7 +68,7 @@ bool PhysicsRenderer::init() {
 
 
 
-void PhysicsRenderer::render() {
+void PhysicsRenderer::prepare() {
 
 	profiler.start();
 
@@ -76,47 +84,168 @@ void PhysicsRenderer::render() {
 
 	}
 
-	u32 objects = 0;
-	modelMatrixBuffer.clear();
-
-	for(auto[transform, collider] : actorManager.view<Transform, BoxCollider>()) {
-
-		Mat4f modelMatrix = Mat4f::fromTranslation(transform.position) * Mat4f::fromRotationXYZ(transform.rotation.x, transform.rotation.y, transform.rotation.z);
-		
-		modelMatrixBuffer.push_back(modelMatrix[0][0]);
-		modelMatrixBuffer.push_back(modelMatrix[0][1]);
-		modelMatrixBuffer.push_back(modelMatrix[0][2]);
-		modelMatrixBuffer.push_back(modelMatrix[0][3]);
-		modelMatrixBuffer.push_back(modelMatrix[1][0]);
-		modelMatrixBuffer.push_back(modelMatrix[1][1]);
-		modelMatrixBuffer.push_back(modelMatrix[1][2]);
-		modelMatrixBuffer.push_back(modelMatrix[1][3]);
-		modelMatrixBuffer.push_back(modelMatrix[2][0]);
-		modelMatrixBuffer.push_back(modelMatrix[2][1]);
-		modelMatrixBuffer.push_back(modelMatrix[2][2]);
-		modelMatrixBuffer.push_back(modelMatrix[2][3]);
-		modelMatrixBuffer.push_back(modelMatrix[3][0]);
-		modelMatrixBuffer.push_back(modelMatrix[3][1]);
-		modelMatrixBuffer.push_back(modelMatrix[3][2]);
-		modelMatrixBuffer.push_back(modelMatrix[3][3]);
-		
-		objects++;
+	frameArena.nextFrame();
+
+	StateBuffer::View view = stateBuffer.read();
+	double alpha = view.getInterpolation(Time::getTimeSinceEpoch(Time::Unit::Nanoseconds));
+
+	FrameVector<u32> updates(frameArena);
+
+	//Queues an instance for recomputation, the last flag given wins
+	auto queue = [this, &updates](u32 instance, u8 flag) {
+
+		if (!updateFlags[instance]) {
+			updates.push_back(instance);
+		}
+
+		updateFlags[instance] = flag;
+
+	};
+
+	bool rebuild = false;
+
+	if (view.getSize()) {
+
+		//A new tick completes the previous one
+		for (u32 instance : interpolatedInstances) {
+
+			fromTransforms[instance] = toTransforms[instance];
+			queue(instance, instanceSettled);
+
+		}
+
+		interpolatedInstances.clear();
+
+		for (SizeT i = 0; i < view.getSize(); i++) {
+
+			const SimulationState& state = view[i];
+
+			if (state.snapshot) {
+
+				loadSnapshot(state);
+				updates.clear();
+				rebuild = true;
+
+				continue;
+
+			}
+
+			//Only the latest tick is interpolated, the ones before have already passed
+			bool latest = i + 1 == view.getSize();
+
+			for (SizeT j = 0; j < state.actors.size(); j++) {
+
+				u32 instance = findInstance(state.actors[j], state.transforms[j]);
+
+				fromTransforms[instance] = latest ? toTransforms[instance] : state.transforms[j];
+				toTransforms[instance] = state.transforms[j];
+
+				if (latest) {
+					interpolatedInstances.push_back(instance);
+				} else if (!rebuild) {
+					queue(instance, instanceSettled);
+				}
+
+			}
+
+		}
+
+	}
+
+	objects = fromTransforms.size();
+
+	if (rebuild) {
+
+		updates.resize(objects);
+		std::iota(updates.begin(), updates.end(), 0);
+		std::fill(updateFlags.begin(), updateFlags.end(), instanceSettled);
+
+	}
+
+	//Once the latest tick has passed, its actors rest at their final transform
+	for (u32 instance : interpolatedInstances) {
+
+		if (alpha >= 1.0) {
+			fromTransforms[instance] = toTransforms[instance];
+		}
+
+		queue(instance, alpha >= 1.0 ? instanceSettled : instanceInterpolated);
+
+	}
+
+	if (alpha >= 1.0) {
+		interpolatedInstances.clear();
+	}
+
+	//Every instance owns a fixed 16-float slot and appears only once in updates, so workers can write without synchronization
+	executor.parallelFor(updates.size(), matrixGrainSize, [&](SizeT start, SizeT end) {
+
+		//Transforms are gathered into small arrays and converted to matrices in one batch
+		Vec3f positions[matrixBatchSize];
+		Quatf rotations[matrixBatchSize];
+		Vec3f scales[matrixBatchSize];
+		float matrices[matrixBatchSize * 16];
+
+		for (SizeT batch = start; batch < end; batch += matrixBatchSize) {
+
+			SizeT count = Math::min<SizeT, SizeT>(end - batch, matrixBatchSize);
+
+			for (SizeT i = 0; i < count; i++) {
+
+				u32 instance = updates[batch + i];
+				Transform transform = updateFlags[instance] == instanceInterpolated ? StateBuffer::interpolate(fromTransforms[instance], toTransforms[instance], alpha) : toTransforms[instance];
+
+				positions[i] = transform.position;
+				rotations[i] = transform.rotation;
+				scales[i] = transform.scale;
+
+			}
+
+			TransformKernel::compose(positions, rotations, scales, matrices, count);
+
+			for (SizeT i = 0; i < count; i++) {
+				std::copy_n(&matrices[i * 16], 16, &modelMatrices[updates[batch + i] * 16]);
+			}
+
+		}
+
+	});
+
+	for (u32 instance : updates) {
+
+		updateFlags[instance] = 0;
+		dirtyStart = Math::min<u32, u32>(dirtyStart, instance);
+		dirtyEnd = Math::max<u32, u32>(dirtyEnd, instance + 1);
 
 	}
 
+	profiler.stop("RenderPrep");
+
+}
+
+
+
+void PhysicsRenderer::render() {
+
+	profiler.start();
+
 	offsetVB.bind();
 
+	//Only the range of changed instances is uploaded unless the instance count changed
 	if(prevObjects != objects) {
 
 		prevObjects = objects;
-		offsetVB.allocate(modelMatrixBuffer.size() * sizeof(float), modelMatrixBuffer.data(), GLE::BufferAccess::StreamDraw);
+		offsetVB.allocate(objects * 16 * sizeof(float), modelMatrices.data(), GLE::BufferAccess::DynamicDraw);
 
-	} else {
+	} else if(dirtyStart < dirtyEnd) {
 
-		offsetVB.update(0, modelMatrixBuffer.size() * sizeof(float), modelMatrixBuffer.data());
+		offsetVB.update(dirtyStart * 16 * sizeof(float), (dirtyEnd - dirtyStart) * 16 * sizeof(float), &modelMatrices[dirtyStart * 16]);
 
 	}
 
+	dirtyStart = -1;
+	dirtyEnd = 0;
+
 	profiler.stop("RenderA");
 	profiler.start();
 
@@ -141,6 +270,47 @@ void PhysicsRenderer::destroy() {
 	objectVB.destroy();
 	offsetVB.destroy();
 	objectShader.destroy();
+	frameArena.clear();
+
+}
+
+
+
+void PhysicsRenderer::loadSnapshot(const SimulationState& state) {
+
+	instances.clear();
+
+	for (SizeT i = 0; i < state.actors.size(); i++) {
+		instances.add(state.actors[i] & 0xFFFFFFFF, i);
+	}
+
+	fromTransforms = state.transforms;
+	toTransforms = state.transforms;
+	modelMatrices.resize(state.actors.size() * 16);
+	updateFlags.assign(state.actors.size(), 0);
+	interpolatedInstances.clear();
+
+}
+
+
+
+u32 PhysicsRenderer::findInstance(ActorID actor, const Transform& transform) {
+
+	u32 index = actor & 0xFFFFFFFF;
+
+	if (instances.contains(index)) {
+		return instances.get(index);
+	}
+
+	u32 instance = fromTransforms.size();
+
+	instances.add(index, instance);
+	fromTransforms.push_back(transform);
+	toTransforms.push_back(transform);
+	modelMatrices.resize(modelMatrices.size() + 16);
+	updateFlags.push_back(0);
+
+	return instance;
 
 }
 
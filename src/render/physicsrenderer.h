@@ -5,10 +5,18 @@
 #include "renderer.h"
 #include "util/matrix.h"
 #include "util/profiler.h"
+#include "core/memory/framearena.h"
+#include "core/acs/actor.h"
+#include "core/acs/component/transform.h"
+#include "util/sparsearray.h"
 #include "input/keydefs.h"
 
+#include <vector>
 
-class ActorManager;
+
+struct SimulationState;
+class StateBuffer;
+class TaskExecutor;
 
 class PhysicsRenderer : public Renderer {
 
@@ -27,9 +35,16 @@ public:
 		CameraMoveUp
 	};
 
-	PhysicsRenderer(ActorManager& actorManager);
+	PhysicsRenderer(StateBuffer& stateBuffer, TaskExecutor& executor);
 
 	virtual bool init() override;
+
+	/*
+		Updates the camera and applies the simulation states published since the last frame.
+		Only the instance matrices of actors changed by these states or still interpolating are recomputed. Does not touch the GL context, so it may run on a worker thread.
+	*/
+	void prepare();
+
 	virtual void render() override;
 	virtual void destroy() override;
 
@@ -40,7 +55,14 @@ public:
 
 private:
 
-	ActorManager& actorManager;
+	//Rebuilds all instances from a snapshot
+	void loadSnapshot(const SimulationState& state);
+
+	//Returns the instance of actor, creating it at transform if the actor is unknown
+	u32 findInstance(ActorID actor, const Transform& transform);
+
+	StateBuffer& stateBuffer;
+	TaskExecutor& executor;
 
 	GLE::ShaderProgram objectShader;
 	GLE::VertexArray objectVA;
@@ -59,9 +81,31 @@ private:
 	Profiler profiler;
 
 	u32 prevObjects;
-	std::vector<float> modelMatrixBuffer;
+	u32 objects;
+
+	//Instances persist across frames and are indexed through the actor's index
+	SparseArray<u32> instances;
+	std::vector<Transform> fromTransforms;
+	std::vector<Transform> toTransforms;
+	std::vector<float> modelMatrices;
+	std::vector<u8> updateFlags;
+
+	//Instances moved by the latest tick, blended between their last two transforms until the tick has passed
+	std::vector<u32> interpolatedInstances;
+
+	//Range of instances whose matrices changed since the last upload
+	u32 dirtyStart;
+	u32 dirtyEnd;
+
+	//Holds the per-frame list of instances to recompute
+	FrameArena frameArena;
 
 	constexpr static double camRotationScale = 0.0006;
 	constexpr static double camVelocity = 0.01;
+	constexpr static SizeT matrixGrainSize = 256;
+	constexpr static SizeT matrixBatchSize = 64;
+	constexpr static u8 instanceSettled = 1;
+	constexpr static u8 instanceInterpolated = 2;
+	constexpr static AddressT frameArenaSize = 256 * 1024;
 
 };
\ No newline at end of file
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "util/vector.h"
+#include "util/matrix.h"
+
+#include <limits>
+
+
+/*
+	Axis-aligned bounding box spanning [min, max].
+	The default box is empty, i.e. min > max, and merging any box into it yields that box.
+*/
+template<Float T>
+class AABB {
+
+public:
+
+	constexpr AABB() : min(std::numeric_limits<T>::max()), max(std::numeric_limits<T>::lowest()) {}
+
+	template<Arithmetic A, Arithmetic B>
+	constexpr AABB(const Vec3<A>& min, const Vec3<B>& max) : min(min), max(max) {}
+
+
+	constexpr bool isEmpty() const {
+		return min.x > max.x || min.y > max.y || min.z > max.z;
+	}
+
+	template<Float A>
+	constexpr void merge(const AABB<A>& box) {
+
+		min = Vec3<T>(Math::min<T, T>(min.x, box.min.x), Math::min<T, T>(min.y, box.min.y), Math::min<T, T>(min.z, box.min.z));
+		max = Vec3<T>(Math::max<T, T>(max.x, box.max.x), Math::max<T, T>(max.y, box.max.y), Math::max<T, T>(max.z, box.max.z));
+
+	}
+
+	constexpr Vec3<T> getCenter() const {
+		return (min + max) * T(0.5);
+	}
+
+	constexpr Vec3<T> getExtents() const {
+		return (max - min) * T(0.5);
+	}
+
+	//Returns the smallest box enclosing this box transformed by m. Empty boxes stay empty.
+	template<Float A>
+	constexpr AABB transformed(const Mat4<A>& m) const {
+
+		if (isEmpty()) {
+			return AABB();
+		}
+
+		Vec3<T> c = getCenter();
+		Vec3<T> e = getExtents();
+
+		//Each world axis extent sums the absolute contributions of all local extents
+		Vec3<T> center(m[0][0] * c.x + m[1][0] * c.y + m[2][0] * c.z + m[3][0],
+					   m[0][1] * c.x + m[1][1] * c.y + m[2][1] * c.z + m[3][1],
+					   m[0][2] * c.x + m[1][2] * c.y + m[2][2] * c.z + m[3][2]);
+
+		Vec3<T> extents(Math::abs(m[0][0]) * e.x + Math::abs(m[1][0]) * e.y + Math::abs(m[2][0]) * e.z,
+						Math::abs(m[0][1]) * e.x + Math::abs(m[1][1]) * e.y + Math::abs(m[2][1]) * e.z,
+						Math::abs(m[0][2]) * e.x + Math::abs(m[1][2]) * e.y + Math::abs(m[2][2]) * e.z);
+
+		return AABB(center - extents, center + extents);
+
+	}
+
+
+	Vec3<T> min;
+	Vec3<T> max;
+
+};
+
+
+
+#define AABB_DEFINE_TS(name, type, suffix) typedef AABB<type> name##suffix;
+
+#define AABB_DEFINE_N(name) \
+	AABB_DEFINE_TS(name, float, f) \
+	AABB_DEFINE_TS(name, double, d) \
+	AABB_DEFINE_TS(name, long double, ld) \
+	AABB_DEFINE_TS(name, ARC_STD_FLOAT_TYPE, x)
+
+AABB_DEFINE_N(AABB)
\ No newline at end of file
@@ -0,0 +1,215 @@
+#include "frustum.h"
+#include "arcintrinsic.h"
+
+
+
+void CullingBounds::reserve(SizeT count) {
+
+	centerX.reserve(count);
+	centerY.reserve(count);
+	centerZ.reserve(count);
+	extentX.reserve(count);
+	extentY.reserve(count);
+	extentZ.reserve(count);
+
+}
+
+
+
+void CullingBounds::clear() {
+
+	centerX.clear();
+	centerY.clear();
+	centerZ.clear();
+	extentX.clear();
+	extentY.clear();
+	extentZ.clear();
+
+}
+
+
+
+void CullingBounds::add(const AABBf& box) {
+
+	//The extents of an empty box are infinite and would turn into NaN for zero plane components, so a fixed negative sentinel is stored instead
+	Vec3f center = box.isEmpty() ? Vec3f(0) : box.getCenter();
+	Vec3f extents = box.isEmpty() ? Vec3f(-1) : box.getExtents();
+
+	centerX.push_back(center.x);
+	centerY.push_back(center.y);
+	centerZ.push_back(center.z);
+	extentX.push_back(extents.x);
+	extentY.push_back(extents.y);
+	extentZ.push_back(extents.z);
+
+}
+
+
+
+SizeT CullingBounds::size() const {
+	return centerX.size();
+}
+
+
+
+Frustum::Frustum() {}
+
+
+
+Frustum::Frustum(const Mat4f& viewProjection) {
+
+	const Mat4f& m = viewProjection;
+
+	//Row i of the matrix in column-major storage
+	auto row = [&m](u32 i) {
+		return Vec4f(m[0][i], m[1][i], m[2][i], m[3][i]);
+	};
+
+	planes[0] = row(3) + row(0);
+	planes[1] = row(3) - row(0);
+	planes[2] = row(3) + row(1);
+	planes[3] = row(3) - row(1);
+	planes[4] = row(3) + row(2);
+	planes[5] = row(3) - row(2);
+
+}
+
+
+
+bool Frustum::intersects(const AABBf& box) const {
+
+	if (box.isEmpty()) {
+		return false;
+	}
+
+	Vec3f c = box.getCenter();
+	Vec3f e = box.getExtents();
+
+	for (const Vec4f& p : planes) {
+
+		//Signed distance of the box vertex farthest along the plane normal
+		float distance = p.x * c.x + p.y * c.y + p.z * c.z + p.w + (Math::abs(p.x) * e.x + Math::abs(p.y) * e.y + Math::abs(p.z) * e.z);
+
+		if (distance < 0) {
+			return false;
+		}
+
+	}
+
+	return true;
+
+}
+
+
+
+void Frustum::intersects(const CullingBounds& bounds, u8* visible) const {
+
+	SizeT count = bounds.size();
+	SizeT i = 0;
+
+	const float* cx = bounds.centerX.data();
+	const float* cy = bounds.centerY.data();
+	const float* cz = bounds.centerZ.data();
+	const float* ex = bounds.extentX.data();
+	const float* ey = bounds.extentY.data();
+	const float* ez = bounds.extentZ.data();
+
+#ifdef ARC_INTRINSIC_AVX
+
+	const __m256 signMask = _mm256_set1_ps(-0.0f);
+
+	for (; i + 8 <= count; i += 8) {
+
+		__m256 x = _mm256_loadu_ps(cx + i);
+		__m256 y = _mm256_loadu_ps(cy + i);
+		__m256 z = _mm256_loadu_ps(cz + i);
+		__m256 u = _mm256_loadu_ps(ex + i);
+		__m256 v = _mm256_loadu_ps(ey + i);
+		__m256 w = _mm256_loadu_ps(ez + i);
+
+		//Empty boxes are outside of every frustum
+		__m256 outside = _mm256_cmp_ps(u, _mm256_setzero_ps(), _CMP_LT_OQ);
+
+		for (const Vec4f& p : planes) {
+
+			__m256 a = _mm256_set1_ps(p.x);
+			__m256 b = _mm256_set1_ps(p.y);
+			__m256 c = _mm256_set1_ps(p.z);
+
+			__m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(a, x), _mm256_mul_ps(b, y)), _mm256_mul_ps(c, z)), _mm256_set1_ps(p.w));
+			__m256 radius = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_andnot_ps(signMask, a), u), _mm256_mul_ps(_mm256_andnot_ps(signMask, b), v)), _mm256_mul_ps(_mm256_andnot_ps(signMask, c), w));
+
+			outside = _mm256_or_ps(outside, _mm256_cmp_ps(_mm256_add_ps(distance, radius), _mm256_setzero_ps(), _CMP_LT_OQ));
+
+		}
+
+		u32 mask = _mm256_movemask_ps(outside);
+
+		for (u32 j = 0; j < 8; j++) {
+			visible[i + j] = !((mask >> j) & 1);
+		}
+
+	}
+
+#endif
+
+#ifdef ARC_INTRINSIC_SSE2
+
+	const __m128 signMask4 = _mm_set1_ps(-0.0f);
+
+	for (; i + 4 <= count; i += 4) {
+
+		__m128 x = _mm_loadu_ps(cx + i);
+		__m128 y = _mm_loadu_ps(cy + i);
+		__m128 z = _mm_loadu_ps(cz + i);
+		__m128 u = _mm_loadu_ps(ex + i);
+		__m128 v = _mm_loadu_ps(ey + i);
+		__m128 w = _mm_loadu_ps(ez + i);
+
+		__m128 outside = _mm_cmplt_ps(u, _mm_setzero_ps());
+
+		for (const Vec4f& p : planes) {
+
+			__m128 a = _mm_set1_ps(p.x);
+			__m128 b = _mm_set1_ps(p.y);
+			__m128 c = _mm_set1_ps(p.z);
+
+			__m128 distance = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(a, x), _mm_mul_ps(b, y)), _mm_mul_ps(c, z)), _mm_set1_ps(p.w));
+			__m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_andnot_ps(signMask4, a), u), _mm_mul_ps(_mm_andnot_ps(signMask4, b), v)), _mm_mul_ps(_mm_andnot_ps(signMask4, c), w));
+
+			outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(distance, radius), _mm_setzero_ps()));
+
+		}
+
+		u32 mask = _mm_movemask_ps(outside);
+
+		for (u32 j = 0; j < 4; j++) {
+			visible[i + j] = !((mask >> j) & 1);
+		}
+
+	}
+
+#endif
+
+	for (; i < count; i++) {
+
+		visible[i] = ex[i] >= 0;
+
+		if (!visible[i]) {
+			continue;
+		}
+
+		for (const Vec4f& p : planes) {
+
+			float distance = p.x * cx[i] + p.y * cy[i] + p.z * cz[i] + p.w + (Math::abs(p.x) * ex[i] + Math::abs(p.y) * ey[i] + Math::abs(p.z) * ez[i]);
+
+			if (distance < 0) {
+				visible[i] = 0;
+				break;
+			}
+
+		}
+
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "util/aabb.h"
+#include "types.h"
+
+#include <vector>
+
+
+/*
+	Bounding boxes stored as separate center and extent arrays, the layout consumed by the SIMD culling kernels.
+	Empty boxes are stored with negative extents and never intersect a frustum.
+*/
+struct CullingBounds {
+
+	void reserve(SizeT count);
+	void clear();
+
+	void add(const AABBf& box);
+
+	SizeT size() const;
+
+	std::vector<float> centerX;
+	std::vector<float> centerY;
+	std::vector<float> centerZ;
+	std::vector<float> extentX;
+	std::vector<float> extentY;
+	std::vector<float> extentZ;
+
+};
+
+
+/*
+	View frustum bounded by six planes (a, b, c, d) with ax + by + cz + d >= 0 on the inner side.
+	The planes are extracted from a view-projection matrix following OpenGL clip space conventions.
+	Box tests are conservative: Boxes crossing the extended plane of a frustum corner may be reported as visible.
+*/
+class Frustum {
+
+public:
+
+	Frustum();
+	explicit Frustum(const Mat4f& viewProjection);
+
+	bool intersects(const AABBf& box) const;
+
+	//Sets visible[i] to 1 if box i intersects the frustum and to 0 otherwise. Batches of 8 (AVX) or 4 (SSE) boxes are tested at once.
+	void intersects(const CullingBounds& bounds, u8* visible) const;
+
+	Vec4f planes[6];
+
+};
\ No newline at end of file
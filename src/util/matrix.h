@@ -408,6 +408,16 @@ public:
 
 	template<Float A>
 	constexpr Mat4& multiply(const Mat4<A>& t) {
+
+#ifdef ARC_SIMD_SSE
+		if constexpr (SIMD::Accelerated<T, A>) {
+			if (!std::is_constant_evaluated()) {
+				SIMD::mat4Multiply(&v[0].x, &t[0].x);
+				return *this;
+			}
+		}
+#endif
+
 		T a = v[0][0] * t[0][0] + v[1][0] * t[0][1] + v[2][0] * t[0][2] + v[3][0] * t[0][3];
 		T b = v[0][1] * t[0][0] + v[1][1] * t[0][1] + v[2][1] * t[0][2] + v[3][1] * t[0][3];
 		T c = v[0][2] * t[0][0] + v[1][2] * t[0][1] + v[2][2] * t[0][2] + v[3][2] * t[0][3];
@@ -426,6 +436,7 @@ public:
 		T p = v[0][3] * t[3][0] + v[1][3] * t[3][1] + v[2][3] * t[3][2] + v[3][3] * t[3][3];
 		*this = Mat4(a, e, i, m, b, f, j, n, c, g, k, o, d, h, l, p);
 		return *this;
+
 	}
 
 	template<Arithmetic A>
@@ -448,6 +459,15 @@ public:
 
 	constexpr void transpose() {
 
+#ifdef ARC_SIMD_SSE
+		if constexpr (SIMD::Accelerated<T>) {
+			if (!std::is_constant_evaluated()) {
+				SIMD::mat4Transpose(&v[0].x);
+				return;
+			}
+		}
+#endif
+
 		T t = v[0][1];
 		v[0][1] = v[1][0];
 		v[1][0] = t;
@@ -475,8 +495,20 @@ public:
 	}
 
 	constexpr Mat4 transposed() const {
+
+#ifdef ARC_SIMD_SSE
+		if constexpr (SIMD::Accelerated<T>) {
+			if (!std::is_constant_evaluated()) {
+				Mat4 m = *this;
+				m.transpose();
+				return m;
+			}
+		}
+#endif
+
 		return Mat4(v[0][0], v[0][1], v[0][2], v[0][3], v[1][0], v[1][1], v[1][2], v[1][3],
 			v[2][0], v[2][1], v[2][2], v[2][3], v[3][0], v[3][1], v[3][2], v[3][3]);
+
 	}
 
 	constexpr T determinant() {
@@ -501,6 +533,15 @@ public:
 
 		T s = 1.0 / det;
 
+#ifdef ARC_SIMD_SSE
+		if constexpr (SIMD::Accelerated<T>) {
+			if (!std::is_constant_evaluated()) {
+				SIMD::mat4Invert(&v[0].x, s);
+				return;
+			}
+		}
+#endif
+
 		T a = v[0][0];
 		T b = v[1][0];
 		T c = v[2][0];
@@ -1,14 +1,363 @@
 #pragma once
 
 #include "util/vector.h"
+#include "util/matrix.h"
+#include "util/simd.h"
 
 
 
+/*
+	Rotation quaternion q = w + xi + yj + zk.
+	Rotations compose from right to left like matrices, i.e. (a * b).rotate(v) applies b first.
+	The default quaternion is the identity rotation.
+*/
 template<Float T>
 class Quaternion {
 
-	
+public:
 
+	using Type = T;
+
+
+	constexpr Quaternion() : x(T(0)), y(T(0)), z(T(0)), w(T(1)) {}
+
+	template<Arithmetic A, Arithmetic B, Arithmetic C, Arithmetic D>
+	constexpr Quaternion(A x, B y, C z, D w) : x(T(x)), y(T(y)), z(T(z)), w(T(w)) {}
+
+	template<Float A>
+	constexpr Quaternion(const Quaternion<A>& q) : x(T(q.x)), y(T(q.y)), z(T(q.z)), w(T(q.w)) {}
+
+
+	template<Float A>
+	constexpr void add(const Quaternion<A>& q) {
+
+#ifdef ARC_SIMD_SSE
+		if constexpr (SIMD::Accelerated<T, A>) {
+			if (!std::is_constant_evaluated()) {
+				SIMD::add4(&x, &q.x);
+				return;
+			}
+		}
+#endif
+
+		x += q.x;
+		y += q.y;
+		z += q.z;
+		w += q.w;
+
+	}
+
+	template<Float A>
+	constexpr void subtract(const Quaternion<A>& q) {
+
+#ifdef ARC_SIMD_SSE
+		if constexpr (SIMD::Accelerated<T, A>) {
+			if (!std::is_constant_evaluated()) {
+				SIMD::subtract4(&x, &q.x);
+				return;
+			}
+		}
+#endif
+
+		x -= q.x;
+		y -= q.y;
+		z -= q.z;
+		w -= q.w;
+
+	}
+
+	template<Arithmetic A>
+	constexpr void multiply(A s) {
+
+#ifdef ARC_SIMD_SSE
+		if constexpr (SIMD::Accelerated<T, A>) {
+			if (!std::is_constant_evaluated()) {
+				SIMD::scale4(&x, s);
+				return;
+			}
+		}
+#endif
+
+		x *= s;
+		y *= s;
+		z *= s;
+		w *= s;
+
+	}
+
+	template<Float A>
+	constexpr void multiply(const Quaternion<A>& q) {
+
+#ifdef ARC_SIMD_SSE
+		if constexpr (SIMD::Accelerated<T, A>) {
+			if (!std::is_constant_evaluated()) {
+				SIMD::quatMultiply(&x, &q.x);
+				return;
+			}
+		}
+#endif
+
+		T nx = w * q.x + x * q.w + y * q.z - z * q.y;
+		T ny = w * q.y - x * q.z + y * q.w + z * q.x;
+		T nz = w * q.z + x * q.y - y * q.x + z * q.w;
+		T nw = w * q.w - x * q.x - y * q.y - z * q.z;
+
+		x = nx;
+		y = ny;
+		z = nz;
+		w = nw;
+
+	}
+
+	template<Arithmetic A>
+	constexpr void divide(A s) {
+		arc_assert(!Math::isZero(s), "Quaternion divided by 0");
+
+#ifdef ARC_SIMD_SSE
+		if constexpr (SIMD::Accelerated<T, A>) {
+			if (!std::is_constant_evaluated()) {
+				SIMD::divide4(&x, s);
+				return;
+			}
+		}
+#endif
+
+		x /= s;
+		y /= s;
+		z /= s;
+		w /= s;
+
+	}
+
+	template<Float A>
+	constexpr Quaternion& operator+=(const Quaternion<A>& q) {
+		add(q);
+		return *this;
+	}
+
+	template<Float A>
+	constexpr Quaternion& operator-=(const Quaternion<A>& q) {
+		subtract(q);
+		return *this;
+	}
+
+	template<Float A>
+	constexpr Quaternion& operator*=(const Quaternion<A>& q) {
+		multiply(q);
+		return *this;
+	}
+
+	template<Arithmetic A>
+	constexpr Quaternion& operator*=(A s) {
+		multiply(s);
+		return *this;
+	}
+
+	template<Arithmetic A>
+	constexpr Quaternion& operator/=(A s) {
+		divide(s);
+		return *this;
+	}
+
+	template<Float A>
+	constexpr bool operator==(const Quaternion<A>& q) const {
+		return Math::isEqual(x, q.x) && Math::isEqual(y, q.y) && Math::isEqual(z, q.z) && Math::isEqual(w, q.w);
+	}
+
+	template<Float A>
+	constexpr bool operator!=(const Quaternion<A>& q) const {
+		return !(*this == q);
+	}
+
+	constexpr Quaternion operator-() const {
+		return Quaternion(-x, -y, -z, -w);
+	}
+
+
+	constexpr auto magSquared() const {
+		return x * x + y * y + z * z + w * w;
+	}
+
+	constexpr auto length() const {
+		return Math::sqrt(magSquared());
+	}
+
+	constexpr void normalize() {
+		divide(length());
+	}
+
+	constexpr Quaternion normalized() const {
+		Quaternion q = *this;
+		q.normalize();
+		return q;
+	}
+
+	constexpr Quaternion conjugate() const {
+		return Quaternion(-x, -y, -z, w);
+	}
+
+	constexpr Quaternion inverse() const {
+		Quaternion q = conjugate();
+		q.divide(magSquared());
+		return q;
+	}
+
+	template<Float A>
+	constexpr auto dot(const Quaternion<A>& q) const {
+		return x * q.x + y * q.y + z * q.z + w * q.w;
+	}
+
+	//Rotates v by this quaternion, which must be normalized
+	template<Arithmetic A>
+	constexpr Vec3<T> rotate(const Vec3<A>& v) const {
+
+		//v' = v + 2w(u x v) + 2u x (u x v) with u = (x, y, z)
+		Vec3<T> u(x, y, z);
+		Vec3<T> t = u.cross(v) * T(2);
+
+		return Vec3<T>(v) + t * w + u.cross(t);
+
+	}
+
+	//Returns the rotation matrix of this quaternion, which must be normalized
+	constexpr Mat3<T> toMat3() const {
+
+		T xx = x * x, yy = y * y, zz = z * z;
+		T xy = x * y, xz = x * z, yz = y * z;
+		T wx = w * x, wy = w * y, wz = w * z;
+
+		return Mat3<T>(1 - 2 * (yy + zz), 2 * (xy - wz), 2 * (xz + wy),
+					   2 * (xy + wz), 1 - 2 * (xx + zz), 2 * (yz - wx),
+					   2 * (xz - wy), 2 * (yz + wx), 1 - 2 * (xx + yy));
+
+	}
+
+	constexpr Mat4<T> toMat4() const {
+
+		Mat3<T> m = toMat3();
+
+		return Mat4<T>(m[0][0], m[1][0], m[2][0], 0,
+					   m[0][1], m[1][1], m[2][1], 0,
+					   m[0][2], m[1][2], m[2][2], 0,
+					   0, 0, 0, 1);
+
+	}
+
+
+	template<Float A, Arithmetic B>
+	constexpr static Quaternion fromAxisAngle(const Vec3<A>& axis, B angle) {
+
+		Vec3<T> u = Vec3<T>::normalize(Vec3<T>(axis));
+		T s = Math::sin(angle / 2.0);
+
+		return Quaternion(u.x * s, u.y * s, u.z * s, Math::cos(angle / 2.0));
+
+	}
+
+	//Creates the rotation about the x, then y, then z axis
+	template<Arithmetic A, Arithmetic B, Arithmetic C>
+	constexpr static Quaternion fromEulerXYZ(A rx, B ry, C rz) {
+
+		T sx = Math::sin(rx / 2.0), cx = Math::cos(rx / 2.0);
+		T sy = Math::sin(ry / 2.0), cy = Math::cos(ry / 2.0);
+		T sz = Math::sin(rz / 2.0), cz = Math::cos(rz / 2.0);
+
+		return Quaternion(sx * cy * cz - cx * sy * sz,
+						  cx * sy * cz + sx * cy * sz,
+						  cx * cy * sz - sx * sy * cz,
+						  cx * cy * cz + sx * sy * sz);
+
+	}
+
+	//Normalized linear interpolation. Takes the shorter arc.
+	template<Float A, Arithmetic B>
+	constexpr static Quaternion nlerp(const Quaternion& from, const Quaternion<A>& to, B factor) {
+
+		T sign = from.dot(to) < 0 ? T(-1) : T(1);
+
+		Quaternion q(Math::lerp(from.x, sign * to.x, factor), Math::lerp(from.y, sign * to.y, factor),
+					 Math::lerp(from.z, sign * to.z, factor), Math::lerp(from.w, sign * to.w, factor));
+		q.normalize();
+
+		return q;
+
+	}
+
+	//Spherical linear interpolation at constant angular velocity. Takes the shorter arc.
+	template<Float A, Arithmetic B>
+	constexpr static Quaternion slerp(const Quaternion& from, const Quaternion<A>& to, B factor) {
+
+		T cosTheta = from.dot(to);
+		T sign = T(1);
+
+		if (cosTheta < 0) {
+			cosTheta = -cosTheta;
+			sign = T(-1);
+		}
+
+		//Nearly parallel rotations would divide by sin(theta) ~ 0
+		if (cosTheta > T(0.9995)) {
+			return nlerp(from, to, factor);
+		}
+
+		T theta = Math::acos(cosTheta);
+		T sinTheta = Math::sin(theta);
+		T a = Math::sin((1 - factor) * theta) / sinTheta;
+		T b = sign * Math::sin(factor * theta) / sinTheta;
+
+		return Quaternion(from.x * a + to.x * b, from.y * a + to.y * b, from.z * a + to.z * b, from.w * a + to.w * b);
+
+	}
+
+
+	T x, y, z, w;
 
 };
 
+
+
+template<Float A, Float B>
+constexpr auto operator+(Quaternion<A> a, const Quaternion<B>& b) {
+	a += b;
+	return a;
+}
+
+template<Float A, Float B>
+constexpr auto operator-(Quaternion<A> a, const Quaternion<B>& b) {
+	a -= b;
+	return a;
+}
+
+template<Float A, Float B>
+constexpr auto operator*(Quaternion<A> a, const Quaternion<B>& b) {
+	a *= b;
+	return a;
+}
+
+template<Float A, Arithmetic B>
+constexpr auto operator*(Quaternion<A> a, B b) {
+	a *= b;
+	return a;
+}
+
+template<Float A, Arithmetic B>
+constexpr auto operator/(Quaternion<A> a, B b) {
+	a /= b;
+	return a;
+}
+
+
+
+#define QUATERNION_DEFINE_TS(name, type, suffix) typedef Quaternion<type> name##suffix;
+
+#define QUATERNION_DEFINE_N(name) \
+	QUATERNION_DEFINE_TS(name, float, f) \
+	QUATERNION_DEFINE_TS(name, double, d) \
+	QUATERNION_DEFINE_TS(name, long double, ld) \
+	QUATERNION_DEFINE_TS(name, ARC_STD_FLOAT_TYPE, x)
+
+#define QUATERNION_DEFINE \
+	QUATERNION_DEFINE_N(Quat) \
+	QUATERNION_DEFINE_N(Quaternion)
+
+QUATERNION_DEFINE
\ No newline at end of file
@@ -0,0 +1,221 @@
+#pragma once
+
+#include "arcintrinsic.h"
+#include "arcconfig.h"
+#include "types.h"
+
+#include <type_traits>
+
+
+/*
+	SIMD backend for the float math types
+	ARC_SIMD_SSE: Vec4f, Mat4f and Quatf operations run on SSE registers
+	ARC_SIMD_AVX: Mat4f multiplication computes two columns per AVX register
+
+	Every routine evaluates the same products and sums in the same order as the scalar code of the respective class.
+	FMA is never used since fused rounding would break bit-identical results between both paths.
+	For the same reason, the compiler must not contract multiplies and adds on its own, which is why GCC and Clang build with -ffp-contract=off.
+	test/simdtest.cpp compares both paths bitwise.
+*/
+#if defined(ARC_INTRINSIC_SSE2) && !defined(ARC_SIMD_FORCE_SCALAR)
+
+	#define ARC_SIMD_SSE
+
+	#ifdef ARC_INTRINSIC_AVX
+		#define ARC_SIMD_AVX
+	#endif
+
+#endif
+
+
+#ifdef ARC_SIMD_SSE
+
+namespace SIMD {
+
+	//True if operations between T and A have a SIMD implementation
+	template<class T, class A = T>
+	constexpr bool Accelerated = std::is_same_v<T, float> && std::is_same_v<A, float>;
+
+
+	//Flips the sign of the lanes set to -0.0 in mask
+	ARC_FORCE_INLINE __m128 flipSign(__m128 v, __m128 mask) {
+		return _mm_xor_ps(v, mask);
+	}
+
+
+
+	ARC_FORCE_INLINE void add4(float* a, const float* b) {
+		_mm_storeu_ps(a, _mm_add_ps(_mm_loadu_ps(a), _mm_loadu_ps(b)));
+	}
+
+	ARC_FORCE_INLINE void subtract4(float* a, const float* b) {
+		_mm_storeu_ps(a, _mm_sub_ps(_mm_loadu_ps(a), _mm_loadu_ps(b)));
+	}
+
+	ARC_FORCE_INLINE void multiply4(float* a, const float* b) {
+		_mm_storeu_ps(a, _mm_mul_ps(_mm_loadu_ps(a), _mm_loadu_ps(b)));
+	}
+
+	ARC_FORCE_INLINE void scale4(float* a, float s) {
+		_mm_storeu_ps(a, _mm_mul_ps(_mm_loadu_ps(a), _mm_set1_ps(s)));
+	}
+
+	ARC_FORCE_INLINE void divide4(float* a, float s) {
+		_mm_storeu_ps(a, _mm_div_ps(_mm_loadu_ps(a), _mm_set1_ps(s)));
+	}
+
+
+	/*
+		Hamilton product a = a * b of two quaternions stored as x, y, z, w.
+		Each step adds one component of a times a permutation of b, matching the term order of Quaternion::multiply.
+	*/
+	ARC_FORCE_INLINE void quatMultiply(float* a, const float* b) {
+
+		__m128 p = _mm_loadu_ps(a);
+		__m128 q = _mm_loadu_ps(b);
+
+		__m128 px = _mm_shuffle_ps(p, p, _MM_SHUFFLE(0, 0, 0, 0));
+		__m128 py = _mm_shuffle_ps(p, p, _MM_SHUFFLE(1, 1, 1, 1));
+		__m128 pz = _mm_shuffle_ps(p, p, _MM_SHUFFLE(2, 2, 2, 2));
+		__m128 pw = _mm_shuffle_ps(p, p, _MM_SHUFFLE(3, 3, 3, 3));
+
+		__m128 r = _mm_mul_ps(pw, q);
+		r = _mm_add_ps(r, flipSign(_mm_mul_ps(px, _mm_shuffle_ps(q, q, _MM_SHUFFLE(0, 1, 2, 3))), _mm_setr_ps(0.0f, -0.0f, 0.0f, -0.0f)));
+		r = _mm_add_ps(r, flipSign(_mm_mul_ps(py, _mm_shuffle_ps(q, q, _MM_SHUFFLE(1, 0, 3, 2))), _mm_setr_ps(0.0f, 0.0f, -0.0f, -0.0f)));
+		r = _mm_add_ps(r, flipSign(_mm_mul_ps(pz, _mm_shuffle_ps(q, q, _MM_SHUFFLE(2, 3, 0, 1))), _mm_setr_ps(-0.0f, 0.0f, 0.0f, -0.0f)));
+
+		_mm_storeu_ps(a, r);
+
+	}
+
+
+	/*
+		Column-major 4x4 matrix product a = a * b.
+		Column j of the result is the sum of the columns of a weighted by the elements of column j of b.
+	*/
+	ARC_FORCE_INLINE void mat4Multiply(float* a, const float* b) {
+
+		__m128 c0 = _mm_loadu_ps(a);
+		__m128 c1 = _mm_loadu_ps(a + 4);
+		__m128 c2 = _mm_loadu_ps(a + 8);
+		__m128 c3 = _mm_loadu_ps(a + 12);
+
+#ifdef ARC_SIMD_AVX
+
+		__m256 d0 = _mm256_set_m128(c0, c0);
+		__m256 d1 = _mm256_set_m128(c1, c1);
+		__m256 d2 = _mm256_set_m128(c2, c2);
+		__m256 d3 = _mm256_set_m128(c3, c3);
+
+		__m256 r[2];
+
+		for (u32 i = 0; i < 2; i++) {
+
+			__m256 t = _mm256_loadu_ps(b + i * 8);
+
+			__m256 s = _mm256_mul_ps(d0, _mm256_shuffle_ps(t, t, _MM_SHUFFLE(0, 0, 0, 0)));
+			s = _mm256_add_ps(s, _mm256_mul_ps(d1, _mm256_shuffle_ps(t, t, _MM_SHUFFLE(1, 1, 1, 1))));
+			s = _mm256_add_ps(s, _mm256_mul_ps(d2, _mm256_shuffle_ps(t, t, _MM_SHUFFLE(2, 2, 2, 2))));
+			s = _mm256_add_ps(s, _mm256_mul_ps(d3, _mm256_shuffle_ps(t, t, _MM_SHUFFLE(3, 3, 3, 3))));
+
+			r[i] = s;
+
+		}
+
+		_mm256_storeu_ps(a, r[0]);
+		_mm256_storeu_ps(a + 8, r[1]);
+
+#else
+
+		__m128 r[4];
+
+		for (u32 i = 0; i < 4; i++) {
+
+			__m128 t = _mm_loadu_ps(b + i * 4);
+
+			__m128 s = _mm_mul_ps(c0, _mm_shuffle_ps(t, t, _MM_SHUFFLE(0, 0, 0, 0)));
+			s = _mm_add_ps(s, _mm_mul_ps(c1, _mm_shuffle_ps(t, t, _MM_SHUFFLE(1, 1, 1, 1))));
+			s = _mm_add_ps(s, _mm_mul_ps(c2, _mm_shuffle_ps(t, t, _MM_SHUFFLE(2, 2, 2, 2))));
+			s = _mm_add_ps(s, _mm_mul_ps(c3, _mm_shuffle_ps(t, t, _MM_SHUFFLE(3, 3, 3, 3))));
+
+			r[i] = s;
+
+		}
+
+		_mm_storeu_ps(a, r[0]);
+		_mm_storeu_ps(a + 4, r[1]);
+		_mm_storeu_ps(a + 8, r[2]);
+		_mm_storeu_ps(a + 12, r[3]);
+
+#endif
+
+	}
+
+
+	ARC_FORCE_INLINE void mat4Transpose(float* m) {
+
+		__m128 c0 = _mm_loadu_ps(m);
+		__m128 c1 = _mm_loadu_ps(m + 4);
+		__m128 c2 = _mm_loadu_ps(m + 8);
+		__m128 c3 = _mm_loadu_ps(m + 12);
+
+		_MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+
+		_mm_storeu_ps(m, c0);
+		_mm_storeu_ps(m + 4, c1);
+		_mm_storeu_ps(m + 8, c2);
+		_mm_storeu_ps(m + 12, c3);
+
+	}
+
+
+	/*
+		Replaces the column-major matrix m by its adjugate scaled by s = 1 / det(m).
+		Lane i of column j holds the 3x3 cofactor of the rows other than j and the columns other than i.
+		Its six triple products are formed from the remaining rows x < y < z and columns u < v < w as
+		xu*yv*zw - xu*yw*zv - yu*xv*zw + yu*xw*zv + zu*xv*yw - zu*xw*yv,
+		with every sign flipped for odd i + j. This is the term order of Mat4::invert.
+	*/
+	ARC_FORCE_INLINE void mat4Invert(float* m, float s) {
+
+		__m128 rows[4] = { _mm_loadu_ps(m), _mm_loadu_ps(m + 4), _mm_loadu_ps(m + 8), _mm_loadu_ps(m + 12) };
+		_MM_TRANSPOSE4_PS(rows[0], rows[1], rows[2], rows[3]);
+
+		//Columns u, v and w per lane: (1, 0, 0, 0), (2, 2, 1, 1), (3, 3, 3, 2)
+		__m128 u[4], v[4], w[4];
+
+		for (u32 i = 0; i < 4; i++) {
+			u[i] = _mm_shuffle_ps(rows[i], rows[i], _MM_SHUFFLE(0, 0, 0, 1));
+			v[i] = _mm_shuffle_ps(rows[i], rows[i], _MM_SHUFFLE(1, 1, 2, 2));
+			w[i] = _mm_shuffle_ps(rows[i], rows[i], _MM_SHUFFLE(2, 3, 3, 3));
+		}
+
+		const __m128 even = _mm_setr_ps(0.0f, -0.0f, 0.0f, -0.0f);
+		const __m128 odd = _mm_setr_ps(-0.0f, 0.0f, -0.0f, 0.0f);
+		const __m128 scale = _mm_set1_ps(s);
+
+		for (u32 j = 0; j < 4; j++) {
+
+			u32 x = j == 0 ? 1 : 0;
+			u32 y = j <= 1 ? 2 : 1;
+			u32 z = j <= 2 ? 3 : 2;
+
+			__m128 pos = j & 1 ? odd : even;
+			__m128 neg = j & 1 ? even : odd;
+
+			__m128 c = flipSign(_mm_mul_ps(_mm_mul_ps(u[x], v[y]), w[z]), pos);
+			c = _mm_add_ps(c, flipSign(_mm_mul_ps(_mm_mul_ps(u[x], w[y]), v[z]), neg));
+			c = _mm_add_ps(c, flipSign(_mm_mul_ps(_mm_mul_ps(u[y], v[x]), w[z]), neg));
+			c = _mm_add_ps(c, flipSign(_mm_mul_ps(_mm_mul_ps(u[y], w[x]), v[z]), pos));
+			c = _mm_add_ps(c, flipSign(_mm_mul_ps(_mm_mul_ps(u[z], v[x]), w[y]), pos));
+			c = _mm_add_ps(c, flipSign(_mm_mul_ps(_mm_mul_ps(u[z], w[x]), v[y]), neg));
+
+			_mm_storeu_ps(m + j * 4, _mm_mul_ps(c, scale));
+
+		}
+
+	}
+
+}
+
+#endif
\ No newline at end of file
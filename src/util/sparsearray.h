@@ -1,7 +1,10 @@
 #pragma once
 
 #include <vector>
+#include <memory>
 #include <iterator>
+#include <algorithm>
+#include <bit>
 #include "types.h"
 #include "util/assert.h"
 #include "util/optionalref.h"
@@ -13,13 +16,37 @@
     Sparse Array implementation with reverse lookup
 
     Complexity for lookup, insertion, deletion is O(1). Traversal is O(n).
-    Memory overhead is proportional to the number of sparse entries.
+    The sparse index is split into pages of ARC_SPARSE_PAGE_SIZE indices. Pages are allocated on first use and released once their last element is removed,
+    so index memory is proportional to the number of occupied pages and growing the index never reallocates existing pages.
+    All memory is obtained from Allocator, rebound to the respective storage type.
 */
-template<class T, class IndexType = u32>
+template<class T, class IndexType = u32, class Allocator = std::allocator<T>>
 class SparseArray {
 
     static_assert(!std::is_reference_v<T>, "T cannot be a reference type");
 
+    constexpr static SizeT PageSize = ARC_SPARSE_PAGE_SIZE;
+
+    static_assert(std::has_single_bit(PageSize), "Sparse page size must be a power of two");
+
+    template<class U>
+    using Rebind = typename std::allocator_traits<Allocator>::template rebind_alloc<U>;
+
+    struct Page {
+
+        constexpr Page() : count(0) {
+            std::fill_n(indices, PageSize, static_cast<IndexType>(-1));
+        }
+
+        IndexType indices[PageSize];
+        SizeT count;
+
+    };
+
+    using PageAllocator = Rebind<Page>;
+    using PageTraits = std::allocator_traits<PageAllocator>;
+    using PageTableTraits = std::allocator_traits<Rebind<Page*>>;
+
 #ifdef ARC_SPARSE_PACK
     struct Storage {
         IndexType index;
@@ -32,13 +59,16 @@ class SparseArray {
 
     public:
     
+        using iterator_category = std::random_access_iterator_tag;
         using difference_type   = std::ptrdiff_t;
         using value_type        = std::conditional_t<Const, const T, T>;
         using pointer           = value_type*;
         using reference         = value_type&;
 
 #ifdef ARC_SPARSE_PACK
-        constexpr IteratorBase(Storage* it) noexcept : ptr(it) {}
+        using StoragePointer    = std::conditional_t<Const, const Storage*, Storage*>;
+
+        constexpr IteratorBase(StoragePointer it) noexcept : ptr(it) {}
 #else
         constexpr IteratorBase(pointer it) noexcept : ptr(it) {}
 #endif
@@ -80,7 +110,7 @@ class SparseArray {
 
 #ifdef ARC_SPARSE_PACK
         constexpr pointer getPtr() const noexcept {return &ptr->element;}
-        Storage* ptr;
+        StoragePointer ptr;
 #else
         constexpr pointer getPtr() const noexcept {return ptr;}
         pointer ptr;
@@ -96,26 +126,105 @@ public:
     using ReverseIterator = std::reverse_iterator<Iterator>;
     using ConstReverseIterator = std::reverse_iterator<ConstIterator>;
 
+    using AllocatorType = Allocator;
+
     constexpr static IndexType invalidIndex = -1;
 
 
     constexpr SparseArray() noexcept = default;
 
-    constexpr SparseArray(IndexType indexArrayCapacity, IndexType denseArrayCapacity) {
+    constexpr explicit SparseArray(const Allocator& allocator) : denseArray(allocator), pageTable(allocator)
+#ifndef ARC_SPARSE_PACK
+        , elementArray(allocator)
+#endif
+    {}
+
+    constexpr SparseArray(IndexType indexArrayCapacity, IndexType denseArrayCapacity, const Allocator& allocator = Allocator()) : SparseArray(allocator) {
         reserve(indexArrayCapacity, denseArrayCapacity);
     }
 
+    constexpr SparseArray(const SparseArray& other) : denseArray(other.denseArray), pageTable(other.pageTable)
+#ifndef ARC_SPARSE_PACK
+        , elementArray(other.elementArray)
+#endif
+    {
+        clonePages(other);
+    }
+
+    constexpr SparseArray(SparseArray&& other) noexcept : denseArray(std::move(other.denseArray)), pageTable(std::move(other.pageTable))
+#ifndef ARC_SPARSE_PACK
+        , elementArray(std::move(other.elementArray))
+#endif
+    {
+        other.pageTable.clear();
+    }
+
+    constexpr SparseArray& operator=(const SparseArray& other) {
+
+        if(this != &other) {
+
+            releasePages();
+
+            denseArray = other.denseArray;
+            pageTable = other.pageTable;
+#ifndef ARC_SPARSE_PACK
+            elementArray = other.elementArray;
+#endif
+
+            clonePages(other);
+
+        }
+
+        return *this;
+
+    }
+
+    constexpr SparseArray& operator=(SparseArray&& other) {
+
+        if(this != &other) {
+
+            releasePages();
+
+            denseArray = std::move(other.denseArray);
+#ifndef ARC_SPARSE_PACK
+            elementArray = std::move(other.elementArray);
+#endif
+
+            if(PageTableTraits::propagate_on_container_move_assignment::value || pageTable.get_allocator() == other.pageTable.get_allocator()) {
+
+                pageTable = std::move(other.pageTable);
+                other.pageTable.clear();
+
+            } else {
+
+                //Pages cannot change ownership between unequal allocators
+                pageTable = other.pageTable;
+                clonePages(other);
+
+            }
+
+            other.clear();
+
+        }
+
+        return *this;
+
+    }
+
+    constexpr ~SparseArray() {
+        releasePages();
+    }
+
 
     /*
         Adds value to the array at position.
         If an element already exists at position, no operation is performed.
-        The container is resized if position exceeds the current size.
+        The page holding position is allocated if it does not exist yet.
         Returns true if the element has been added, false otherwise.
     */
     constexpr bool add(IndexType position, const T& value) {
 
-        checkResize(position);
-        const IndexType& index = indexArray[position];
+        const IndexType& index = acquireIndex(position);
 
         if(!containsValidElement(position, index)) {
 
@@ -130,8 +239,7 @@ public:
 
     constexpr bool add(IndexType position, T&& value) {
 
-        checkResize(position);
-        const IndexType& index = indexArray[position];
+        const IndexType& index = acquireIndex(position);
 
         if(!containsValidElement(position, index)) {
 
@@ -148,12 +256,11 @@ public:
     /*
         Sets the element at position to value.
         If an element already exists at position, the element is overwritten.
-        The container is resized if position exceeds the current size.
+        The page holding position is allocated if it does not exist yet.
     */
     constexpr void set(IndexType position, const T& value) {
 
-        checkResize(position);
-        const IndexType& index = indexArray[position];
+        const IndexType& index = acquireIndex(position);
 
         if(!containsValidElement(position, index)) {
 
@@ -169,8 +276,7 @@ public:
 
     constexpr void set(IndexType position, T&& value) {
 
-        checkResize(position);
-        const IndexType& index = indexArray[position];
+        const IndexType& index = acquireIndex(position);
 
         if(!containsValidElement(position, index)) {
 
@@ -188,16 +294,12 @@ public:
     /*
         Sets the element at position to value.
         If an element does not already exist, no operation is performed.
-        The container is resized if position exceeds the current size.
     */
     constexpr bool trySet(IndexType position, const T& value) {
 
-        checkResize(position);
-        IndexType& index = indexArray[position];
-
-        if(containsValidElement(position, index)) {
+        if(contains(position)) {
 
-            internalSet(position, index, value);
+            internalSet(position, getIndex(position), value);
             return true;
 
         }
@@ -208,12 +310,9 @@ public:
 
     constexpr bool trySet(IndexType position, T&& value) {
 
-        checkResize(position);
-        IndexType& index = indexArray[position];
-
-        if(containsValidElement(position, index)) {
+        if(contains(position)) {
 
-            internalSet(position, index, std::move(value));
+            internalSet(position, getIndex(position), std::move(value));
             return true;
 
         }
@@ -227,7 +326,10 @@ public:
         Returns whether an element at a given position exists.
     */
     constexpr bool contains(IndexType position) const {
-        return !sparseIndexOutOfBounds(position) && containsValidElement(position, indexArray[position]);
+
+        const Page* page = findPage(position);
+        return page && containsValidElement(position, page->indices[position % PageSize]);
+
     }
 
 
@@ -263,7 +365,7 @@ public:
         return internalGet(position);
     }
 
-        
+
     constexpr const T& get(IndexType position) const {
         return internalGet(position);
     }
@@ -325,11 +427,11 @@ public:
 
 
     /*
-        Clears the container. All elements will be removed.
+        Clears the container. All elements will be removed and all pages released.
     */
     constexpr void clear() noexcept {
 
-        indexArray.clear();
+        releasePages();
         denseArray.clear();
 
 #ifndef ARC_SPARSE_PACK
@@ -346,7 +448,7 @@ public:
 
         clear();
 
-        indexArray.shrink_to_fit();
+        pageTable.shrink_to_fit();
         denseArray.shrink_to_fit();
 
 #ifndef ARC_SPARSE_PACK
@@ -357,10 +459,18 @@ public:
 
 
     /*
-        Returns the number of sparse indices in the array.
+        Returns the number of sparse indices covered by the page table.
     */
     constexpr SizeT getSparseSize() const noexcept {
-        return indexArray.size();
+        return pageTable.size() * PageSize;
+    }
+
+
+    /*
+        Returns the number of allocated index pages.
+    */
+    constexpr SizeT getPageCount() const noexcept {
+        return static_cast<SizeT>(std::count_if(pageTable.begin(), pageTable.end(), [](const Page* page) { return page != nullptr; }));
     }
 
 
@@ -372,6 +482,14 @@ public:
     }
 
 
+    /*
+        Returns a copy of the allocator.
+    */
+    constexpr Allocator getAllocator() const noexcept {
+        return Allocator(denseArray.get_allocator());
+    }
+
+
     /*
         Returns an iterator to the start of the dense array.
     */
@@ -489,9 +607,9 @@ public:
     constexpr IndexType find(const T& compare) const {
 
         for(SizeT i = 0; i < denseArray.size(); i++){
-            
+
 #ifdef ARC_SPARSE_PACK
-            if(denseArray[i].storage == compare) {
+            if(denseArray[i].element == compare) {
                 return denseArray[i].index;
             }
 #else
@@ -509,11 +627,12 @@ public:
 
 
     /*
-        Reserves the given minimum amount of memory for both arrays.
+        Reserves the given minimum amount of memory for the dense arrays and the page table.
+        Pages themselves are only allocated once an element is inserted into them.
     */
     constexpr void reserve(IndexType indexArrayCapacity, IndexType denseArrayCapacity) {
 
-        indexArray.reserve(indexArrayCapacity);
+        pageTable.reserve((indexArrayCapacity + PageSize - 1) / PageSize);
         denseArray.reserve(denseArrayCapacity);
 #ifndef ARC_SPARSE_PACK
         elementArray.reserve(denseArrayCapacity);
@@ -527,12 +646,15 @@ public:
     */
     constexpr void swap(IndexType posA, IndexType posB) {
 
+        IndexType& indexA = getIndex(posA);
+        IndexType& indexB = getIndex(posB);
+
 #ifdef ARC_SPARSE_PACK
-        std::swap(denseArray[indexArray[posA]].index, denseArray[indexArray[posB]].index);
+        std::swap(denseArray[indexA].index, denseArray[indexB].index);
 #else
-        std::swap(denseArray[indexArray[posA]], denseArray[indexArray[posB]]);
+        std::swap(denseArray[indexA], denseArray[indexB]);
 #endif
-        std::swap(indexArray[posA], indexArray[posB]);
+        std::swap(indexA, indexB);
 
     }
 
@@ -553,18 +675,18 @@ private:
 
     constexpr T& internalGet(IndexType sparseIdx) {
 #ifdef ARC_SPARSE_PACK
-        return denseArray[indexArray[sparseIdx]].element;
+        return denseArray[getIndex(sparseIdx)].element;
 #else
-        return elementArray[indexArray[sparseIdx]];
+        return elementArray[getIndex(sparseIdx)];
 #endif
     }
 
 
     constexpr const T& internalGet(IndexType sparseIdx) const {
 #ifdef ARC_SPARSE_PACK
-        return denseArray[indexArray[sparseIdx]].element;
+        return denseArray[getIndex(sparseIdx)].element;
 #else
-        return elementArray[indexArray[sparseIdx]];
+        return elementArray[getIndex(sparseIdx)];
 #endif
     }
 
@@ -572,42 +694,49 @@ private:
     template<class U>
     constexpr void internalAdd(IndexType sparseIdx, U&& value) {
 
-        indexArray[sparseIdx] = denseArray.size();
+        IndexType denseIdx = denseArray.size();
 
 #ifdef ARC_SPARSE_PACK
         denseArray.emplace_back(Storage{sparseIdx, std::forward<U>(value)});
 #else
-        denseArray.emplace_back(sparseIdx);
         elementArray.emplace_back(std::forward<U>(value));
+        denseArray.emplace_back(sparseIdx);
 #endif
 
+        Page* page = pageTable[sparseIdx / PageSize];
+        page->indices[sparseIdx % PageSize] = denseIdx;
+        page->count++;
+
     }
 
 
     constexpr void internalRemove(IndexType sparseIdx) {
 
+        IndexType& index = getIndex(sparseIdx);
+        IndexType denseIdx = index;
+
 #ifdef ARC_SPARSE_PACK
-        const IndexType& lastSparseIdx = denseArray.back().index;
-        const IndexType& denseIdx = indexArray[sparseIdx];
-        denseArray[denseIdx] = std::move(denseArray[indexArray[lastSparseIdx]]);
+        IndexType lastSparseIdx = denseArray.back().index;
+        denseArray[denseIdx] = std::move(denseArray.back());
 
-        indexArray[lastSparseIdx] = denseIdx;
-        indexArray[sparseIdx] = invalidIndex;
+        getIndex(lastSparseIdx) = denseIdx;
+        index = invalidIndex;
 
         denseArray.pop_back();
 #else
-        const IndexType& lastSparseIdx = denseArray.back();
-        const IndexType& denseIdx = indexArray[sparseIdx];
-        denseArray[denseIdx] = std::move(denseArray[indexArray[lastSparseIdx]]);
-        elementArray[denseIdx] = std::move(elementArray[indexArray[lastSparseIdx]]);
+        IndexType lastSparseIdx = denseArray.back();
+        denseArray[denseIdx] = lastSparseIdx;
+        elementArray[denseIdx] = std::move(elementArray.back());
 
-        indexArray[lastSparseIdx] = denseIdx;
-        indexArray[sparseIdx] = invalidIndex;
+        getIndex(lastSparseIdx) = denseIdx;
+        index = invalidIndex;
 
         denseArray.pop_back();
         elementArray.pop_back();
 #endif
 
+        releaseIndex(sparseIdx);
+
     }
 
 
@@ -623,36 +752,151 @@ private:
 
 
     /*
-        Checks if the requested position is greater-equal than the current size.
-        If yes, the index array is resized and filled with invalid indices.
+        Returns the dense index stored at the given position. The position's page must exist.
     */
-    constexpr void checkResize(IndexType reqPos) {
+    constexpr IndexType& getIndex(IndexType position) {
+        return pageTable[position / PageSize]->indices[position % PageSize];
+    }
+
+
+    constexpr const IndexType& getIndex(IndexType position) const {
+        return pageTable[position / PageSize]->indices[position % PageSize];
+    }
+
+
+    /*
+        Returns the page holding the given position or nullptr if it has not been allocated.
+    */
+    constexpr const Page* findPage(IndexType position) const noexcept {
+
+        SizeT pageIdx = position / PageSize;
+        return pageIdx < pageTable.size() ? pageTable[pageIdx] : nullptr;
+
+    }
 
-        arc_assert(reqPos <= 0xFFFFFF, "Index %d exceeds the usual array range, is your index correct?", reqPos);
 
-        if(reqPos >= indexArray.size()) {
-             indexArray.resize(reqPos + 1, invalidIndex);
+    /*
+        Returns the dense index stored at the requested position.
+        If the position is not covered by an allocated page yet, the page table is grown and the page is allocated.
+    */
+    constexpr IndexType& acquireIndex(IndexType position) {
+
+        arc_assert(position <= 0xFFFFFF, "Index %d exceeds the usual array range, is your index correct?", position);
+
+        SizeT pageIdx = position / PageSize;
+
+        if(pageIdx >= pageTable.size()) {
+            pageTable.resize(pageIdx + 1, nullptr);
         }
 
+        Page*& page = pageTable[pageIdx];
+
+        if(!page) {
+            page = createPage();
+        }
+
+        return page->indices[position % PageSize];
+
     }
 
 
     /*
-        Returns true if a valid element exists at the given indices
+        Drops the element count of the page holding the given position and releases the page once it is empty.
     */
-    constexpr bool containsValidElement(IndexType sparseIdx, IndexType denseIdx) const noexcept {
-        return !denseIndexInvalid(denseIdx) && !denseElementInvalid(sparseIdx);
+    constexpr void releaseIndex(IndexType position) {
+
+        Page*& page = pageTable[position / PageSize];
+
+        if(--page->count == 0) {
+
+            destroyPage(page);
+            page = nullptr;
+
+        }
+
+    }
+
+
+    template<class... Args>
+    constexpr Page* createPage(Args&&... args) {
+
+        PageAllocator allocator(pageTable.get_allocator());
+        Page* page = PageTraits::allocate(allocator, 1);
+
+        try {
+            PageTraits::construct(allocator, page, std::forward<Args>(args)...);
+        } catch (...) {
+            PageTraits::deallocate(allocator, page, 1);
+            throw;
+        }
+
+        return page;
+
+    }
+
+
+    constexpr void destroyPage(Page* page) noexcept {
+
+        PageAllocator allocator(pageTable.get_allocator());
+        PageTraits::destroy(allocator, page);
+        PageTraits::deallocate(allocator, page, 1);
+
     }
 
 
     /*
-        Returns true if the sparse index is out of bounds
+        Replaces the page pointers copied from other by private copies of its pages.
     */
-    constexpr bool sparseIndexOutOfBounds(IndexType sparseIdx) const noexcept {
-        return sparseIdx >= indexArray.size();
+    constexpr void clonePages(const SparseArray& other) {
+
+        std::fill(pageTable.begin(), pageTable.end(), nullptr);
+
+        try {
+
+            for(SizeT i = 0; i < pageTable.size(); i++) {
+
+                if(other.pageTable[i]) {
+                    pageTable[i] = createPage(*other.pageTable[i]);
+                }
+
+            }
+
+        } catch (...) {
+
+            clear();
+            throw;
+
+        }
+
     }
 
-   
+
+    /*
+        Destroys all pages and empties the page table.
+    */
+    constexpr void releasePages() noexcept {
+
+        for(Page* page : pageTable) {
+
+            if(page) {
+                destroyPage(page);
+            }
+
+        }
+
+        pageTable.clear();
+
+    }
+
+
+    /*
+        Returns true if a valid element exists at the given indices
+    */
+    constexpr bool containsValidElement(IndexType sparseIdx, IndexType denseIdx) const noexcept {
+        return !denseIndexInvalid(denseIdx) && !denseElementInvalid(sparseIdx, denseIdx);
+    }
+
+
     /*
         Returns true if the dense index is out of bounds
     */
@@ -670,24 +914,16 @@ private:
 
 
     /*
-        Returns true if the dense element is invalid
+        Returns true if the dense element does not point back to the sparse index
     */
-    constexpr bool denseElementInvalid(IndexType sparseIdx) const {
+    constexpr bool denseElementInvalid(IndexType sparseIdx, IndexType denseIdx) const noexcept {
 #ifdef ARC_SPARSE_PACK
-        return denseArray[indexArray[sparseIdx]].index != sparseIdx;
+        return denseArray[denseIdx].index != sparseIdx;
 #else
-        return denseArray[indexArray[sparseIdx]] != sparseIdx;
+        return denseArray[denseIdx] != sparseIdx;
 #endif
     }
 
-    
-    /*
-        Asserts if the given sparse index is out of bounds.
-    */
-    constexpr void checkSparseIndexOutOfBounds(IndexType pos) const noexcept {
-        arc_assert(!sparseIndexOutOfBounds(pos), "Sparse index out of bounds (idx=%d, size=%d)", pos, indexArray.size());
-    }
-
 
     /*
         Asserts if the given dense index is out of bounds.
@@ -696,13 +932,16 @@ private:
         arc_assert(!denseIndexOutOfBounds(pos), "Dense index out of bounds (idx=%d, size=%d)", pos, denseArray.size());
     }
 
-#ifndef ARC_SPARSE_PACK
-    std::vector<T> elementArray;
-    std::vector<IndexType> denseArray;
+#ifdef ARC_SPARSE_PACK
+    std::vector<Storage, Rebind<Storage>> denseArray;
 #else
-    std::vector<Storage> denseArray;
+    std::vector<IndexType, Rebind<IndexType>> denseArray;
 #endif
 
-    std::vector<IndexType> indexArray;
+    std::vector<Page*, Rebind<Page*>> pageTable;
+
+#ifndef ARC_SPARSE_PACK
+    std::vector<T, Rebind<T>> elementArray;
+#endif
 
 };
\ No newline at end of file
@@ -1,14 +1,19 @@
 #include "ticker.h"
+#include "time.h"
+#include "assert.h"
 
 
-Ticker::Ticker() : nsPerTick(1), accumulator(0) {}
+Ticker::Ticker() : lastTime(0), nsPerTick(1), accumulator(0), maxTicks(Unlimited) {}
 
 
-void Ticker::start(u32 tps) {
+void Ticker::start(u32 tps, u32 maxTicks) {
 
-    timer.start();
+	arc_assert(tps, "Tick rate must be non-zero");
+
+	this->maxTicks = maxTicks;
+	lastTime = Time::getTimeSinceEpoch(Time::Unit::Nanoseconds);
 	accumulator = 0;
-    nsPerTick = 1000000ULL / tps;
+	nsPerTick = 1000000000ULL / tps;
 
 }
 
@@ -16,19 +21,39 @@ void Ticker::start(u32 tps) {
 
 u32 Ticker::getTicks() {
 
-	u64 delta = static_cast<u64>(timer.getElapsedTime(Time::Unit::Microseconds));
-    timer.start();
+	//Timestamps are taken back to back so that no time is lost between calls
+	u64 time = Time::getTimeSinceEpoch(Time::Unit::Nanoseconds);
+	accumulator += time - lastTime;
+	lastTime = time;
 
-	accumulator += delta;
-	u32 ticks = 0;
+	u64 ticks = accumulator / nsPerTick;
+	accumulator %= nsPerTick;
 
-	if (accumulator > nsPerTick) {
+	if (ticks > maxTicks) {
+		ticks = maxTicks;
+	}
 
-		ticks = accumulator / nsPerTick;
-		accumulator %= nsPerTick;
+	return static_cast<u32>(ticks);
 
-	}
+}
+
+
+
+double Ticker::getInterpolation() const {
+	return static_cast<double>(accumulator) / nsPerTick;
+}
+
+
+
+u64 Ticker::getTickDuration() const {
+	return nsPerTick;
+}
+
+
+
+u64 Ticker::getTimeUntilTick() const {
 
-    return ticks;
+	u64 elapsed = accumulator + Time::getTimeSinceEpoch(Time::Unit::Nanoseconds) - lastTime;
+	return elapsed < nsPerTick ? nsPerTick - elapsed : 0;
 
 }
\ No newline at end of file
@@ -1,21 +1,41 @@
 #pragma once
 
-#include "timer.h"
+#include "types.h"
 
 
+/*
+	Fixed-step accumulator.
+	Elapsed wall-clock time is accumulated and consumed in ticks of constant duration. If more than maxTicks ticks are due at once,
+	the excess time is dropped so that a slow consumer does not spiral into ever larger catch-up batches.
+*/
 class Ticker {
 
 public:
 
-    Ticker();
+	constexpr static u32 Unlimited = -1;
 
-    void start(u32 tps);
-    u32 getTicks();
+	Ticker();
+
+	//Starts ticking at tps ticks per second, returning at most maxTicks ticks per call to getTicks()
+	void start(u32 tps, u32 maxTicks = Unlimited);
+
+	//Returns the number of ticks elapsed since the last call
+	u32 getTicks();
+
+	//Returns the elapsed fraction of the current tick in [0, 1) as of the last call to getTicks()
+	double getInterpolation() const;
+
+	//Returns the duration of a tick in nanoseconds
+	u64 getTickDuration() const;
+
+	//Returns the time left until the next tick is due in nanoseconds
+	u64 getTimeUntilTick() const;
 
 private:
 
-    Timer timer;
-    u32 nsPerTick;
+	u64 lastTime;
+	u64 nsPerTick;
 	u64 accumulator;
+	u32 maxTicks;
 
 };
\ No newline at end of file
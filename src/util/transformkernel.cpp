@@ -0,0 +1,229 @@
+#include "transformkernel.h"
+#include "arcintrinsic.h"
+
+
+static_assert(sizeof(Vec3f) == 3 * sizeof(float), "Vec3f must be tightly packed");
+static_assert(sizeof(Quatf) == 4 * sizeof(float), "Quatf must be tightly packed");
+
+
+namespace TransformKernel {
+
+	void composeScalar(const Vec3f& p, const Quatf& q, const Vec3f& s, float* m) {
+
+		float x2 = q.x + q.x, y2 = q.y + q.y, z2 = q.z + q.z;
+		float xx = q.x * x2, yy = q.y * y2, zz = q.z * z2;
+		float xy = q.x * y2, xz = q.x * z2, yz = q.y * z2;
+		float wx = q.w * x2, wy = q.w * y2, wz = q.w * z2;
+
+		m[0] = (1 - (yy + zz)) * s.x;
+		m[1] = (xy + wz) * s.x;
+		m[2] = (xz - wy) * s.x;
+		m[3] = 0;
+
+		m[4] = (xy - wz) * s.y;
+		m[5] = (1 - (xx + zz)) * s.y;
+		m[6] = (yz + wx) * s.y;
+		m[7] = 0;
+
+		m[8] = (xz + wy) * s.z;
+		m[9] = (yz - wx) * s.z;
+		m[10] = (1 - (xx + yy)) * s.z;
+		m[11] = 0;
+
+		m[12] = p.x;
+		m[13] = p.y;
+		m[14] = p.z;
+		m[15] = 1;
+
+	}
+
+
+#ifdef ARC_INTRINSIC_SSE2
+
+	/*
+		Loads four consecutive Vec3f and splits them into their components.
+		a = x0 y0 z0 x1, b = y1 z1 x2 y2, c = z2 x3 y3 z3
+	*/
+	ARC_FORCE_INLINE void loadVec3x4(const Vec3f* v, __m128& x, __m128& y, __m128& z) {
+
+		const float* f = &v->x;
+
+		__m128 a = _mm_loadu_ps(f);
+		__m128 b = _mm_loadu_ps(f + 4);
+		__m128 c = _mm_loadu_ps(f + 8);
+
+		x = _mm_shuffle_ps(a, _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2)), _MM_SHUFFLE(2, 0, 3, 0));
+		y = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1)), _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+		z = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2)), c, _MM_SHUFFLE(3, 0, 2, 0));
+
+	}
+
+#endif
+
+
+#ifdef ARC_INTRINSIC_AVX
+
+	//Transposes the 4x4 blocks in both 128 bit lanes
+	ARC_FORCE_INLINE void transpose4x4x2(__m256& r0, __m256& r1, __m256& r2, __m256& r3) {
+
+		__m256 t0 = _mm256_unpacklo_ps(r0, r1);
+		__m256 t1 = _mm256_unpacklo_ps(r2, r3);
+		__m256 t2 = _mm256_unpackhi_ps(r0, r1);
+		__m256 t3 = _mm256_unpackhi_ps(r2, r3);
+
+		r0 = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(1, 0, 1, 0));
+		r1 = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 2, 3, 2));
+		r2 = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(1, 0, 1, 0));
+		r3 = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(3, 2, 3, 2));
+
+	}
+
+	ARC_FORCE_INLINE __m256 combine(__m128 low, __m128 high) {
+		return _mm256_insertf128_ps(_mm256_castps128_ps256(low), high, 1);
+	}
+
+	//Writes column c of matrices 0-3 from the lower and 4-7 from the upper lane
+	ARC_FORCE_INLINE void storeColumn(float* m, u32 c, __m256 r0, __m256 r1, __m256 r2, __m256 r3) {
+
+		transpose4x4x2(r0, r1, r2, r3);
+
+		__m256 columns[4] = { r0, r1, r2, r3 };
+
+		for (u32 k = 0; k < 4; k++) {
+
+			_mm_storeu_ps(m + k * 16 + c * 4, _mm256_castps256_ps128(columns[k]));
+			_mm_storeu_ps(m + (k + 4) * 16 + c * 4, _mm256_extractf128_ps(columns[k], 1));
+
+		}
+
+	}
+
+	//Processes 8 transforms
+	void composeAVX(const Vec3f* positions, const Quatf* rotations, const Vec3f* scales, float* m) {
+
+		const float* q = &rotations->x;
+
+		__m256 x = combine(_mm_loadu_ps(q), _mm_loadu_ps(q + 16));
+		__m256 y = combine(_mm_loadu_ps(q + 4), _mm_loadu_ps(q + 20));
+		__m256 z = combine(_mm_loadu_ps(q + 8), _mm_loadu_ps(q + 24));
+		__m256 w = combine(_mm_loadu_ps(q + 12), _mm_loadu_ps(q + 28));
+		transpose4x4x2(x, y, z, w);
+
+		__m128 pxl, pyl, pzl, pxh, pyh, pzh;
+		loadVec3x4(positions, pxl, pyl, pzl);
+		loadVec3x4(positions + 4, pxh, pyh, pzh);
+
+		__m128 sxl, syl, szl, sxh, syh, szh;
+		loadVec3x4(scales, sxl, syl, szl);
+		loadVec3x4(scales + 4, sxh, syh, szh);
+
+		__m256 sx = combine(sxl, sxh);
+		__m256 sy = combine(syl, syh);
+		__m256 sz = combine(szl, szh);
+
+		__m256 x2 = _mm256_add_ps(x, x);
+		__m256 y2 = _mm256_add_ps(y, y);
+		__m256 z2 = _mm256_add_ps(z, z);
+
+		__m256 xx = _mm256_mul_ps(x, x2);
+		__m256 yy = _mm256_mul_ps(y, y2);
+		__m256 zz = _mm256_mul_ps(z, z2);
+		__m256 xy = _mm256_mul_ps(x, y2);
+		__m256 xz = _mm256_mul_ps(x, z2);
+		__m256 yz = _mm256_mul_ps(y, z2);
+		__m256 wx = _mm256_mul_ps(w, x2);
+		__m256 wy = _mm256_mul_ps(w, y2);
+		__m256 wz = _mm256_mul_ps(w, z2);
+
+		__m256 one = _mm256_set1_ps(1);
+		__m256 zero = _mm256_setzero_ps();
+
+		storeColumn(m, 0, _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(yy, zz)), sx), _mm256_mul_ps(_mm256_add_ps(xy, wz), sx), _mm256_mul_ps(_mm256_sub_ps(xz, wy), sx), zero);
+		storeColumn(m, 1, _mm256_mul_ps(_mm256_sub_ps(xy, wz), sy), _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(xx, zz)), sy), _mm256_mul_ps(_mm256_add_ps(yz, wx), sy), zero);
+		storeColumn(m, 2, _mm256_mul_ps(_mm256_add_ps(xz, wy), sz), _mm256_mul_ps(_mm256_sub_ps(yz, wx), sz), _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(xx, yy)), sz), zero);
+		storeColumn(m, 3, combine(pxl, pxh), combine(pyl, pyh), combine(pzl, pzh), one);
+
+	}
+
+#endif
+
+
+#ifdef ARC_INTRINSIC_SSE2
+
+	//Writes column c of matrices 0-3
+	ARC_FORCE_INLINE void storeColumn(float* m, u32 c, __m128 r0, __m128 r1, __m128 r2, __m128 r3) {
+
+		_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+		_mm_storeu_ps(m + c * 4, r0);
+		_mm_storeu_ps(m + 16 + c * 4, r1);
+		_mm_storeu_ps(m + 32 + c * 4, r2);
+		_mm_storeu_ps(m + 48 + c * 4, r3);
+
+	}
+
+	//Processes 4 transforms
+	void composeSSE(const Vec3f* positions, const Quatf* rotations, const Vec3f* scales, float* m) {
+
+		const float* q = &rotations->x;
+
+		__m128 x = _mm_loadu_ps(q);
+		__m128 y = _mm_loadu_ps(q + 4);
+		__m128 z = _mm_loadu_ps(q + 8);
+		__m128 w = _mm_loadu_ps(q + 12);
+		_MM_TRANSPOSE4_PS(x, y, z, w);
+
+		__m128 px, py, pz, sx, sy, sz;
+		loadVec3x4(positions, px, py, pz);
+		loadVec3x4(scales, sx, sy, sz);
+
+		__m128 x2 = _mm_add_ps(x, x);
+		__m128 y2 = _mm_add_ps(y, y);
+		__m128 z2 = _mm_add_ps(z, z);
+
+		__m128 xx = _mm_mul_ps(x, x2);
+		__m128 yy = _mm_mul_ps(y, y2);
+		__m128 zz = _mm_mul_ps(z, z2);
+		__m128 xy = _mm_mul_ps(x, y2);
+		__m128 xz = _mm_mul_ps(x, z2);
+		__m128 yz = _mm_mul_ps(y, z2);
+		__m128 wx = _mm_mul_ps(w, x2);
+		__m128 wy = _mm_mul_ps(w, y2);
+		__m128 wz = _mm_mul_ps(w, z2);
+
+		__m128 one = _mm_set1_ps(1);
+		__m128 zero = _mm_setzero_ps();
+
+		storeColumn(m, 0, _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(yy, zz)), sx), _mm_mul_ps(_mm_add_ps(xy, wz), sx), _mm_mul_ps(_mm_sub_ps(xz, wy), sx), zero);
+		storeColumn(m, 1, _mm_mul_ps(_mm_sub_ps(xy, wz), sy), _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, zz)), sy), _mm_mul_ps(_mm_add_ps(yz, wx), sy), zero);
+		storeColumn(m, 2, _mm_mul_ps(_mm_add_ps(xz, wy), sz), _mm_mul_ps(_mm_sub_ps(yz, wx), sz), _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, yy)), sz), zero);
+		storeColumn(m, 3, px, py, pz, one);
+
+	}
+
+#endif
+
+
+	void compose(const Vec3f* positions, const Quatf* rotations, const Vec3f* scales, float* matrices, SizeT count) {
+
+		SizeT i = 0;
+
+#ifdef ARC_INTRINSIC_AVX
+		for (; i + 8 <= count; i += 8) {
+			composeAVX(positions + i, rotations + i, scales + i, matrices + i * 16);
+		}
+#endif
+
+#ifdef ARC_INTRINSIC_SSE2
+		for (; i + 4 <= count; i += 4) {
+			composeSSE(positions + i, rotations + i, scales + i, matrices + i * 16);
+		}
+#endif
+
+		for (; i < count; i++) {
+			composeScalar(positions[i], rotations[i], scales[i], matrices + i * 16);
+		}
+
+	}
+
+}
\ No newline at end of file
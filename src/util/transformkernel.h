@@ -0,0 +1,17 @@
+#pragma once
+
+#include "util/vector.h"
+#include "util/quaternion.h"
+#include "types.h"
+
+
+namespace TransformKernel {
+
+	/*
+		Builds count column-major 4x4 matrices M = T * R * S from arrays of positions, rotations and scales.
+		Each matrix occupies 16 consecutive floats in matrices, so the result can be uploaded as instance data directly.
+		Rotations must be normalized. Batches of 8 (AVX) or 4 (SSE) transforms are processed at once, the rest is computed in scalar code.
+	*/
+	void compose(const Vec3f* positions, const Quatf* rotations, const Vec3f* scales, float* matrices, SizeT count);
+
+}
\ No newline at end of file
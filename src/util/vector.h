@@ -3,6 +3,7 @@
 #include "util/math.h"
 #include "util/assert.h"
 #include "util/random.h"
+#include "util/simd.h"
 #include "typetraits.h"
 
 
@@ -448,43 +449,98 @@ public:
 
 	template<Arithmetic A>
 	constexpr void add(const Vec4<A>& v) {
+
+#ifdef ARC_SIMD_SSE
+		if constexpr (SIMD::Accelerated<T, A>) {
+			if (!std::is_constant_evaluated()) {
+				SIMD::add4(&x, &v.x);
+				return;
+			}
+		}
+#endif
+
 		x += v.x;
 		y += v.y;
 		z += v.z;
 		w += v.w;
+
 	}
 
 	template<Arithmetic A>
 	constexpr void subtract(const Vec4<A>& v) {
+
+#ifdef ARC_SIMD_SSE
+		if constexpr (SIMD::Accelerated<T, A>) {
+			if (!std::is_constant_evaluated()) {
+				SIMD::subtract4(&x, &v.x);
+				return;
+			}
+		}
+#endif
+
 		x -= v.x;
 		y -= v.y;
 		z -= v.z;
 		w -= v.w;
+
 	}
 
 	template<Arithmetic A>
 	constexpr void multiply(A s) {
+
+#ifdef ARC_SIMD_SSE
+		if constexpr (SIMD::Accelerated<T, A>) {
+			if (!std::is_constant_evaluated()) {
+				SIMD::scale4(&x, s);
+				return;
+			}
+		}
+#endif
+
 		x *= s;
 		y *= s;
 		z *= s;
 		w *= s;
+
 	}
 
 	template<Arithmetic A>
 	constexpr void divide(A s) {
 		arc_assert(!Math::isZero(s), "Vec4 divided by 0");
+
+#ifdef ARC_SIMD_SSE
+		if constexpr (SIMD::Accelerated<T, A>) {
+			if (!std::is_constant_evaluated()) {
+				SIMD::divide4(&x, s);
+				return;
+			}
+		}
+#endif
+
 		x /= s;
 		y /= s;
 		z /= s;
 		w /= s;
+
 	}
 
 	template<Arithmetic A>
 	constexpr void compMultiply(const Vec4<A>& v) {
+
+#ifdef ARC_SIMD_SSE
+		if constexpr (SIMD::Accelerated<T, A>) {
+			if (!std::is_constant_evaluated()) {
+				SIMD::multiply4(&x, &v.x);
+				return;
+			}
+		}
+#endif
+
 		x *= v.x;
 		y *= v.y;
 		z *= v.z;
 		w *= v.w;
+
 	}
 
 	template<Arithmetic A>
@@ -0,0 +1,219 @@
+#include "util/vector.h"
+#include "util/matrix.h"
+#include "util/quaternion.h"
+#include "util/simd.h"
+#include "types.h"
+
+#include <array>
+#include <bit>
+#include <cstdio>
+
+
+/*
+	Verifies that the SIMD paths of Vec4f, Mat4f and Quatf are bit-identical to the scalar code.
+	Constant evaluation never takes a SIMD path, so the scalar results are computed at compile time and compared against the same operations at runtime.
+*/
+
+//Operations remain usable in constant expressions
+static_assert(Vec4f(1, 2, 3, 4) + Vec4f(4, 3, 2, 1) == Vec4f(5, 5, 5, 5));
+static_assert(Mat4f::fromScale(2.0f) * Mat4f::fromScale(0.5f) == Mat4f());
+static_assert(Mat4f::fromTranslation(1, 2, 3).inverse() == Mat4f::fromTranslation(-1, -2, -3));
+static_assert(Mat4f::fromTranslation(1, 2, 3).transposed().transposed() == Mat4f::fromTranslation(1, 2, 3));
+static_assert(Quatf(0, 0, 1, 0) * Quatf(0, 0, 1, 0) == Quatf(0, 0, 0, -1));
+
+
+constexpr u32 caseCount = 64;
+
+
+//xorshift32, yields the same sequence at compile time and at runtime
+class InputGenerator {
+
+public:
+
+	constexpr explicit InputGenerator(u32 seed) : state(seed) {}
+
+	//Returns a float in [-1, 1). The 24 bit mantissa makes the conversion exact.
+	constexpr float next() {
+
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+
+		return static_cast<float>(state >> 8) / 8388608.0f - 1.0f;
+
+	}
+
+	//Arguments are evaluated in unspecified order, so every element is drawn in a statement of its own
+	constexpr Vec4f nextVec4() {
+
+		Vec4f v;
+		v.x = next();
+		v.y = next();
+		v.z = next();
+		v.w = next();
+
+		return v;
+
+	}
+
+	//Diagonally dominant, hence always invertible
+	constexpr Mat4f nextMat4() {
+
+		Mat4f m;
+
+		for (u32 i = 0; i < 4; i++) {
+
+			m[i] = nextVec4();
+			m[i][i] += 4;
+
+		}
+
+		return m;
+
+	}
+
+	constexpr Quatf nextQuat() {
+
+		Quatf q;
+		q.x = next();
+		q.y = next();
+		q.z = next();
+		q.w = next();
+
+		return q;
+
+	}
+
+private:
+
+	u32 state;
+
+};
+
+
+struct Results {
+
+	std::array<Vec4f, caseCount> vecSums;
+	std::array<Vec4f, caseCount> vecDifferences;
+	std::array<Vec4f, caseCount> vecScaled;
+	std::array<Vec4f, caseCount> vecDivided;
+	std::array<Vec4f, caseCount> vecProducts;
+
+	std::array<Mat4f, caseCount> matProducts;
+	std::array<Mat4f, caseCount> matTransposed;
+	std::array<Mat4f, caseCount> matInverses;
+
+	std::array<Quatf, caseCount> quatSums;
+	std::array<Quatf, caseCount> quatDifferences;
+	std::array<Quatf, caseCount> quatScaled;
+	std::array<Quatf, caseCount> quatDivided;
+	std::array<Quatf, caseCount> quatProducts;
+
+};
+
+
+constexpr Results compute() {
+
+	InputGenerator random(0x2545F491);
+	Results results;
+
+	for (u32 i = 0; i < caseCount; i++) {
+
+		Vec4f a = random.nextVec4();
+		Vec4f b = random.nextVec4();
+		float s = random.next() + 2.0f;
+
+		results.vecSums[i] = a;
+		results.vecSums[i] += b;
+		results.vecDifferences[i] = a;
+		results.vecDifferences[i] -= b;
+		results.vecScaled[i] = a;
+		results.vecScaled[i] *= s;
+		results.vecDivided[i] = a;
+		results.vecDivided[i] /= s;
+		results.vecProducts[i] = a;
+		results.vecProducts[i].compMultiply(b);
+
+		Mat4f m = random.nextMat4();
+		Mat4f n = random.nextMat4();
+
+		results.matProducts[i] = m;
+		results.matProducts[i] *= n;
+		results.matTransposed[i] = m.transposed();
+		results.matInverses[i] = m.inverse();
+
+		Quatf p = random.nextQuat();
+		Quatf q = random.nextQuat();
+
+		results.quatSums[i] = p;
+		results.quatSums[i] += q;
+		results.quatDifferences[i] = p;
+		results.quatDifferences[i] -= q;
+		results.quatScaled[i] = p;
+		results.quatScaled[i] *= s;
+		results.quatDivided[i] = p;
+		results.quatDivided[i] /= s;
+		results.quatProducts[i] = p;
+		results.quatProducts[i] *= q;
+
+	}
+
+	return results;
+
+}
+
+
+template<class T>
+u32 compare(const char* name, const std::array<T, caseCount>& expected, const std::array<T, caseCount>& actual) {
+
+	using Bits = std::array<u32, sizeof(T) / sizeof(u32)>;
+
+	u32 mismatches = 0;
+
+	for (u32 i = 0; i < caseCount; i++) {
+
+		if (std::bit_cast<Bits>(expected[i]) != std::bit_cast<Bits>(actual[i])) {
+			mismatches++;
+		}
+
+	}
+
+	if (mismatches) {
+		std::printf("%s: %u of %u results differ from the scalar path\n", name, mismatches, caseCount);
+	}
+
+	return mismatches;
+
+}
+
+
+int main() {
+
+	constexpr Results expected = compute();
+	Results actual = compute();
+
+	u32 mismatches = 0;
+
+	mismatches += compare("Vec4f add", expected.vecSums, actual.vecSums);
+	mismatches += compare("Vec4f subtract", expected.vecDifferences, actual.vecDifferences);
+	mismatches += compare("Vec4f multiply", expected.vecScaled, actual.vecScaled);
+	mismatches += compare("Vec4f divide", expected.vecDivided, actual.vecDivided);
+	mismatches += compare("Vec4f compMultiply", expected.vecProducts, actual.vecProducts);
+	mismatches += compare("Mat4f multiply", expected.matProducts, actual.matProducts);
+	mismatches += compare("Mat4f transpose", expected.matTransposed, actual.matTransposed);
+	mismatches += compare("Mat4f invert", expected.matInverses, actual.matInverses);
+	mismatches += compare("Quatf add", expected.quatSums, actual.quatSums);
+	mismatches += compare("Quatf subtract", expected.quatDifferences, actual.quatDifferences);
+	mismatches += compare("Quatf multiply", expected.quatScaled, actual.quatScaled);
+	mismatches += compare("Quatf divide", expected.quatDivided, actual.quatDivided);
+	mismatches += compare("Quatf product", expected.quatProducts, actual.quatProducts);
+
+#ifdef ARC_SIMD_SSE
+	std::printf("SIMD path: %s\n", mismatches ? "FAILED" : "bit-identical to scalar");
+#else
+	std::printf("SIMD path disabled, only the scalar path has been exercised\n");
+#endif
+
+	return mismatches ? 1 : 0;
+
+}
\ No newline at end of file